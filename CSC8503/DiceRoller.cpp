@@ -10,7 +10,10 @@
 #include "D4Volume.h"
 #include "D6Volume.h"
 #include "D8Volume.h"
+#include "D10Volume.h"
+#include "D12Volume.h"
 #include "D20Volume.h"
+#include "DiceSimulator.h"
 
 
 
@@ -20,6 +23,7 @@ using namespace CSC8503;
 
 DiceRoller::DiceRoller() : controller(*Window::GetWindow()->GetKeyboard(), *Window::GetWindow()->GetMouse()) {
 	world = new GameWorld();
+	world->Seed(std::random_device()());	//a different set of rolls every run - seed it with a constant to replay them
 #ifdef USEVULKAN
 	renderer = new GameTechVulkanRenderer(*world);
 	renderer->Init();
@@ -33,6 +37,7 @@ DiceRoller::DiceRoller() : controller(*Window::GetWindow()->GetKeyboard(), *Wind
 	forceMagnitude = 10.0f;
 	diceActive = false;
 	physics->UseGravity(true);
+	DiceSimulator::InitRestThresholds(*physics);
 
 	world->GetMainCamera().SetController(controller);
 
@@ -124,6 +129,14 @@ void DiceRoller::UpdateKeys() {
 	if (Window::GetKeyboard()->KeyPressed(KeyCodes::F1)) {
 		InitWorld(); //We can reset the simulation at any time with F1
 	}
+	if (Window::GetKeyboard()->KeyPressed(KeyCodes::I)) {
+		physics->SetConstraintIterationCount(physics->GetConstraintIterationCount() - 1);
+		std::cout << "Setting constraint iterations to " << physics->GetConstraintIterationCount() << std::endl;
+	}
+	if (Window::GetKeyboard()->KeyPressed(KeyCodes::O)) {
+		physics->SetConstraintIterationCount(physics->GetConstraintIterationCount() + 1);
+		std::cout << "Setting constraint iterations to " << physics->GetConstraintIterationCount() << std::endl;
+	}
 	if (Window::GetKeyboard()->KeyPressed(KeyCodes::SPACE))
 	{
 		//exit early and do nothing if no dice are selected
@@ -180,132 +193,91 @@ void DiceRoller::InitWorld() {
 	dice->GetRenderObject()->SetColour({ 1,1,1,0.5 });
 	dice->SetCollisionLayer(staticObj);
 	dice->SetName("selD20");
+	dice = AddD10({ -14,0,-10 }, 1, 0);
+	dice->GetPhysicsObject()->useGravity = false;
+	dice->GetRenderObject()->SetColour({ 1,1,1,0.5 });
+	dice->SetCollisionLayer(staticObj);
+	dice->SetName("selD10");
+	dice = AddD12({ -14,0,-12 }, 0.7f, 0);
+	dice->GetPhysicsObject()->useGravity = false;
+	dice->GetRenderObject()->SetColour({ 1,1,1,0.5 });
+	dice->SetCollisionLayer(staticObj);
+	dice->SetName("selD12");
 
 	//rolling dice
 	rollingDice[d4] = AddD4({ 0,5,0 }, 1, 10);
 	rollingDice[d4]->GetPhysicsObject()->useGravity = false;
 	rollingDice[d4]->SetActive(false);
-	rollingDice[d4]->GetPhysicsObject()->SetFrameLinearDampingCoeff(1.0f);
-	rollingDice[d4]->GetPhysicsObject()->SetFrameAngularDampingCoeff(1.0f);
+	DiceSimulator::InitRollingDice(rollingDice[d4]);
 	rollingDice[d6] = AddD6({ 0,5,2 }, { 0.5,0.5,0.5 }, 10);
 	rollingDice[d6]->GetPhysicsObject()->useGravity = false;
 	rollingDice[d6]->SetActive(false);
-	rollingDice[d6]->GetPhysicsObject()->SetFrameLinearDampingCoeff(1.0f);
-	rollingDice[d6]->GetPhysicsObject()->SetFrameAngularDampingCoeff(1.0f);
+	DiceSimulator::InitRollingDice(rollingDice[d6]);
 	rollingDice[d8] = AddD8({ 0,5,4 }, 1, 10);
 	rollingDice[d8]->GetPhysicsObject()->useGravity = false;
 	rollingDice[d8]->SetActive(false);
-	rollingDice[d8]->GetPhysicsObject()->SetFrameLinearDampingCoeff(1.0f);
-	rollingDice[d8]->GetPhysicsObject()->SetFrameAngularDampingCoeff(1.0f);
+	DiceSimulator::InitRollingDice(rollingDice[d8]);
 	rollingDice[d20] = AddD20({ 0,5,6 }, 1, 10);
 	rollingDice[d20]->GetPhysicsObject()->useGravity = false;
 	rollingDice[d20]->SetActive(false);
-	rollingDice[d20]->GetPhysicsObject()->SetFrameLinearDampingCoeff(1.0f);
-	rollingDice[d20]->GetPhysicsObject()->SetFrameAngularDampingCoeff(1.0f);
+	DiceSimulator::InitRollingDice(rollingDice[d20]);
+	rollingDice[d10] = AddD10({ 0,5,-2 }, 1, 10);
+	rollingDice[d10]->GetPhysicsObject()->useGravity = false;
+	rollingDice[d10]->SetActive(false);
+	DiceSimulator::InitRollingDice(rollingDice[d10]);
+	rollingDice[d12] = AddD12({ 0,5,-4 }, 0.7f, 10);
+	rollingDice[d12]->GetPhysicsObject()->useGravity = false;
+	rollingDice[d12]->SetActive(false);
+	DiceSimulator::InitRollingDice(rollingDice[d12]);
 }
 
 GameObject* DiceRoller::AddD4(const Vector3& position, float height, float inverseMass)
 {
-	GameObject* d4 = new GameObject();
-	D4Volume* volume = new D4Volume(height);
-
-	Vector3 d4Size = Vector3(height, height, height);
-	d4->SetBoundingVolume((CollisionVolume*)volume);
-
-	d4->GetTransform()
-		.SetScale(d4Size)
-		.SetPosition(position);
-
+	GameObject* d4 = DiceSimulator::AddD4(*world, position, height, inverseMass);
 	d4->SetRenderObject(new RenderObject(&d4->GetTransform(), d4Mesh, d4Tex, basicShader));
-	d4->SetPhysicsObject(new PhysicsObject(&d4->GetTransform(), d4->GetBoundingVolume()));
-	d4->GetPhysicsObject()->SetInverseMass(inverseMass);
-	d4->GetPhysicsObject()->InitSphereInertia();
-	world->AddGameObject(d4);
 	return d4;
 }
 
 GameObject* DiceRoller::AddD6(const Vector3& position, Vector3 dimensions, float inverseMass)
 {
-	GameObject* d6 = new GameObject();
-	D6Volume* volume = new D6Volume(dimensions);
-	d6->SetBoundingVolume((CollisionVolume*)volume);
-
-	d6->GetTransform()
-		.SetPosition(position)
-		//this adjustment here is due to the size of the d6 mesh: its base has side length sqrt(2), so multiplying it by sqrt(2)/2 gets us back to 1
-		.SetScale(dimensions * (sqrt(2) / 2) * 2);
-
-
+	GameObject* d6 = DiceSimulator::AddD6(*world, position, dimensions, inverseMass);
 	d6->SetRenderObject(new RenderObject(&d6->GetTransform(), d6Mesh, d6Tex, basicShader));
-	d6->SetPhysicsObject(new PhysicsObject(&d6->GetTransform(), d6->GetBoundingVolume()));
-
-	d6->GetPhysicsObject()->SetInverseMass(inverseMass);
-	d6->GetPhysicsObject()->InitCubeInertia();
-
-	world->AddGameObject(d6);
-
 	return d6;
 }
 
 GameObject* DiceRoller::AddD8(const Vector3& position, float height, float inverseMass)
 {
-	GameObject* d8 = new GameObject();
-	D8Volume* volume = new D8Volume(height);
-
-	Vector3 d8Size = Vector3(height, height, height);
-	d8->SetBoundingVolume((CollisionVolume*)volume);
-
-	d8->GetTransform()
-		.SetScale(d8Size)
-		.SetPosition(position);
-
+	GameObject* d8 = DiceSimulator::AddD8(*world, position, height, inverseMass);
 	d8->SetRenderObject(new RenderObject(&d8->GetTransform(), d8Mesh, d8Tex, basicShader));
-	d8->SetPhysicsObject(new PhysicsObject(&d8->GetTransform(), d8->GetBoundingVolume()));
-	d8->GetPhysicsObject()->SetInverseMass(inverseMass);
-	d8->GetPhysicsObject()->InitSphereInertia();
-	world->AddGameObject(d8);
 	return d8;
 }
 
-
-GameObject* DiceRoller::AddD20(const Vector3& position, float height, float inverseMass)
+GameObject* DiceRoller::AddD10(const Vector3& position, float height, float inverseMass)
 {
-	GameObject* d20 = new GameObject();
-	D20Volume* volume = new D20Volume(height);
-
-	Vector3 d20Size = Vector3(height, height, height);
-	d20->SetBoundingVolume((CollisionVolume*)volume);
+	GameObject* d10 = DiceSimulator::AddD10(*world, position, height, inverseMass);
+	d10->SetRenderObject(new RenderObject(&d10->GetTransform(), d10Mesh, d10Tex, basicShader));
+	return d10;
+}
 
-	d20->GetTransform()
-		.SetScale(d20Size)
-		.SetPosition(position);
+GameObject* DiceRoller::AddD12(const Vector3& position, float edgeLength, float inverseMass)
+{
+	GameObject* d12 = DiceSimulator::AddD12(*world, position, edgeLength, inverseMass);
+	d12->SetRenderObject(new RenderObject(&d12->GetTransform(), d12Mesh, d12Tex, basicShader));
+	return d12;
+}
 
+GameObject* DiceRoller::AddD20(const Vector3& position, float height, float inverseMass)
+{
+	GameObject* d20 = DiceSimulator::AddD20(*world, position, height, inverseMass);
 	d20->SetRenderObject(new RenderObject(&d20->GetTransform(), d20Mesh, d20Tex, basicShader));
-	d20->SetPhysicsObject(new PhysicsObject(&d20->GetTransform(), d20->GetBoundingVolume()));
-	d20->GetPhysicsObject()->SetInverseMass(inverseMass);
-	d20->GetPhysicsObject()->InitSphereInertia();
-	world->AddGameObject(d20);
 	return d20;
 }
 
 GameObject* DiceRoller::AddCubeToWorld(const Vector3& position, Vector3 dimensions, Texture* tex, float inverseMass) {
-	GameObject* cube = new GameObject();
-
-	AABBVolume* volume = new AABBVolume(dimensions);
-	cube->SetBoundingVolume((CollisionVolume*)volume);
-
-	cube->GetTransform()
-		.SetPosition(position)
-		.SetScale(dimensions * 2);
+	GameObject* cube = DiceSimulator::AddCube(*world, position, dimensions, inverseMass);
 
 	if (tex == nullptr) tex = basicTex;
 	cube->SetRenderObject(new RenderObject(&cube->GetTransform(), cubeMesh, tex, basicShader));
-	cube->SetPhysicsObject(new PhysicsObject(&cube->GetTransform(), cube->GetBoundingVolume()));
-
-	cube->GetPhysicsObject()->SetInverseMass(inverseMass);
-	cube->GetPhysicsObject()->InitCubeInertia();
-
-	world->AddGameObject(cube);
 
 	return cube;
 }
@@ -316,23 +288,8 @@ A single function to add a large immoveable cube to the bottom of our world
 
 */
 GameObject* DiceRoller::AddFloorToWorld(const Vector3& position, const Vector3& dimensions) {
-	GameObject* floor = new GameObject();
-
-	AABBVolume* volume = new AABBVolume(dimensions);
-	floor->SetBoundingVolume((CollisionVolume*)volume);
-	floor->GetTransform()
-		.SetScale(dimensions * 2)
-		.SetPosition(position);
-
+	GameObject* floor = DiceSimulator::AddFloor(*world, position, dimensions);
 	floor->SetRenderObject(new RenderObject(&floor->GetTransform(), cubeMesh, woodTex, basicShader));
-	floor->SetPhysicsObject(new PhysicsObject(&floor->GetTransform(), floor->GetBoundingVolume()));
-	floor->SetCollisionLayer(staticObj);
-
-	floor->GetPhysicsObject()->SetInverseMass(0);
-	floor->GetPhysicsObject()->InitCubeInertia();
-
-	world->AddGameObject(floor);
-
 	return floor;
 }
 
@@ -340,12 +297,11 @@ GameObject* DiceRoller::AddFloorToWorld(const Vector3& position, const Vector3&
 
 void DiceRoller::InitDiceTray()
 {
-	Vector3 dimensions = { 10,2,10 };
-	GameObject* floor = AddFloorToWorld({ 0,0,0 }, dimensions);
-	AddCubeToWorld({ 0,dimensions.y,dimensions.z - 1.0f }, { dimensions.x,4,1 }, woodTex, 0);
-	AddCubeToWorld({ 0,dimensions.y,-dimensions.z + 1.0f }, { dimensions.x,4,1 }, woodTex, 0);
-	AddCubeToWorld({ dimensions.x - 1.0f,dimensions.y,0 }, { 1,4,dimensions.z }, woodTex, 0);
-	AddCubeToWorld({ -dimensions.x + 1.0f,dimensions.y,0 }, { 1,4,dimensions.z }, woodTex, 0);
+	//the tray itself is built by the simulator, so that headless rolls use exactly the same geometry
+	for (GameObject* o : DiceSimulator::InitDiceTray(*world))
+	{
+		o->SetRenderObject(new RenderObject(&o->GetTransform(), cubeMesh, woodTex, basicShader));
+	}
 }
 
 void DiceRoller::UpdateActiveDice()
@@ -379,9 +335,21 @@ void DiceRoller::UpdateActiveDice()
 }
 
 
+bool DiceRoller::DiceSettled() const
+{
+	for (int i = d4; i < MAX; i++)
+	{
+		if (selectedDice[i] != nullptr && !rollingDice[i]->GetPhysicsObject()->IsSettled())
+			return false;
+	}
+	return true;
+}
+
 void DiceRoller::DisplayDiceResults()
 {
-	if (sceneTime < 5.0f) return;
+	if (!diceActive) return;
+	//show the results as soon as everything has stopped moving, or give up waiting after 5 seconds
+	if (sceneTime < 5.0f && !DiceSettled()) return;
 
 	if (selectedDice[d4] != nullptr)
 	{
@@ -407,6 +375,18 @@ void DiceRoller::DisplayDiceResults()
 		std::string d20Res = std::to_string(d20v->GetFaceResult(rollingDice[d20]->GetTransform()));
 		Debug::Print(d20Res, { 5,16 });
 	}
+	if (selectedDice[d10] != nullptr)
+	{
+		D10Volume* d10v = (D10Volume*)rollingDice[d10]->GetBoundingVolume();
+		std::string d10Res = std::to_string(d10v->GetFaceResult(rollingDice[d10]->GetTransform()));
+		Debug::Print(d10Res, { 5,20 });
+	}
+	if (selectedDice[d12] != nullptr)
+	{
+		D12Volume* d12v = (D12Volume*)rollingDice[d12]->GetBoundingVolume();
+		std::string d12Res = std::to_string(d12v->GetFaceResult(rollingDice[d12]->GetTransform()));
+		Debug::Print(d12Res, { 5,24 });
+	}
 
 	
 }
@@ -421,6 +401,10 @@ void DiceRoller::ResetDicePositions()
 	rollingDice[d8]->GetPhysicsObject()->SetLinearVelocity({ 0,0,0 });
 	rollingDice[d20]->GetTransform().SetPosition(d20Start);
 	rollingDice[d20]->GetPhysicsObject()->SetLinearVelocity({ 0,0,0 });
+	rollingDice[d10]->GetTransform().SetPosition(d10Start);
+	rollingDice[d10]->GetPhysicsObject()->SetLinearVelocity({ 0,0,0 });
+	rollingDice[d12]->GetTransform().SetPosition(d12Start);
+	rollingDice[d12]->GetPhysicsObject()->SetLinearVelocity({ 0,0,0 });
 }
 
 void DiceRoller::RollDice()
@@ -430,8 +414,8 @@ void DiceRoller::RollDice()
 		if (rollingDice[i]->IsActive())
 		{
 			//random torque, and +/- 15 degrees from positive x direction
-			rollingDice[i]->GetPhysicsObject()->AddTorque({ RandomValue(0,50), RandomValue(0,50),RandomValue(0,50) });
-			Vector3 roll = Matrix4::Rotation(RandomValue(-40, 40), { 0,1,0 }) * Vector3(1, 0, 0) * 200;
+			rollingDice[i]->GetPhysicsObject()->AddTorque({ world->RandomValue(0,50), world->RandomValue(0,50),world->RandomValue(0,50) });
+			Vector3 roll = Matrix4::Rotation(world->RandomValue(-40, 40), { 0,1,0 }) * Vector3(1, 0, 0) * 200;
 			rollingDice[i]->GetPhysicsObject()->AddForce({ roll });
 		}
 	}
@@ -453,6 +437,10 @@ void DiceRoller::SelectObject()
 				dice = d6;
 			else if (closest->GetName() == "selD8")
 				dice = d8;
+			else if (closest->GetName() == "selD10")
+				dice = d10;
+			else if (closest->GetName() == "selD12")
+				dice = d12;
 			else if (closest->GetName() == "selD20")
 				dice = d20;
 			else
@@ -19,6 +19,8 @@ namespace NCL {
 				d4,
 				d6,
 				d8,
+				d10,
+				d12,
 				d20,
 				MAX
 			};
@@ -42,6 +44,7 @@ namespace NCL {
 			void ResetDicePositions();
 			void RollDice();
 			void DisplayDiceResults();
+			bool DiceSettled() const;
 
 
 			GameObject* AddFloorToWorld(const Vector3& position, const Vector3& dimensions);
@@ -49,6 +52,8 @@ namespace NCL {
 			GameObject* AddD4(const Vector3& position, float radius, float inverseMass = 10.0f);
 			GameObject* AddD6(const Vector3& position, Vector3 dimensions, float inverseMass = 10.0f);
 			GameObject* AddD8(const Vector3& position, float height, float inverseMass = 10.0f);
+			GameObject* AddD10(const Vector3& position, float height, float inverseMass = 10.0f);
+			GameObject* AddD12(const Vector3& position, float edgeLength, float inverseMass = 10.0f);
 			GameObject* AddD20(const Vector3& position, float height, float inverseMass = 10.0f);
 
 #ifdef USEVULKAN
@@ -89,6 +94,8 @@ namespace NCL {
 			Vector3 d6Start = { -5,5,-2 };
 			Vector3 d8Start = { -5,5,0 };
 			Vector3 d20Start = { -5,5,2 };
+			Vector3 d10Start = { -5,5,4 };
+			Vector3 d12Start = { -5,5,6 };
 
 			bool diceActive;
 			float sceneTime;
@@ -132,6 +132,7 @@ void GameTechRenderer::RenderFrame() {
 
 void GameTechRenderer::BuildObjectList() {
 	activeObjects.clear();
+	gameWorld.UpdateTransforms();
 
 	gameWorld.OperateOnContents(
 		[&](GameObject* o) {
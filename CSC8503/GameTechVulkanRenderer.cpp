@@ -344,6 +344,7 @@ void GameTechVulkanRenderer::RenderFrame() {
 
 void GameTechVulkanRenderer::UpdateObjectList() {
 	activeObjects.clear();
+	gameWorld.UpdateTransforms();
 
 	int objectCount = 0;
 
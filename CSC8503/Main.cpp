@@ -13,6 +13,7 @@
 #include "NavigationMesh.h"
 
 #include "DiceRoller.h"
+#include "DiceRollFarm.h"
 
 #include "PushdownMachine.h"
 
@@ -31,7 +32,29 @@ using namespace CSC8503;
 #include <sstream>
 
 
-int main() {
+/*
+Running with -farm <rolls> [seed] skips the window entirely, and just rolls
+the dice headlessly across every core, printing out how fair they were.
+*/
+int RunRollFarm(int rolls, unsigned int seed) {
+	DiceRollFarm farm;
+	std::cout << "Rolling " << rolls << " times across " << farm.GetWorkerCount() << " threads..." << std::endl;
+	GameTimer t;
+	farm.Run(rolls, seed);
+	t.Tick();
+	std::cout << "Finished in " << t.GetTimeDeltaSeconds() << "s" << std::endl;
+	farm.PrintResults(std::cout);
+	return 0;
+}
+
+int main(int argc, char** argv) {
+	for (int i = 1; i < argc; ++i) {
+		if (std::string(argv[i]) == "-farm" && i + 1 < argc) {
+			unsigned int seed = (i + 2 < argc) ? (unsigned int)std::stoul(argv[i + 2]) : 0;
+			return RunRollFarm(std::stoi(argv[i + 1]), seed);
+		}
+	}
+
 	Window*w = Window::CreateGameWindow("CSC8503 Game technology!", 1280, 720);
 	//TestPushdownAutomata(w);
 	if (!w->HasInitialised()) {
@@ -0,0 +1,145 @@
+#include "Benchmark.h"
+#include <cstdlib>
+#include <new>
+#include <iomanip>
+
+using namespace NCL;
+using namespace CSC8503;
+
+volatile int BenchmarkRunner::sink = 0;
+
+namespace {
+	std::atomic<uint64_t> allocationCount(0);
+}
+
+/*
+Replacing the global allocation functions is the only way to see every
+allocation, including those made inside the standard library. The count
+is all that's added - the memory still comes from malloc.
+*/
+void* operator new(std::size_t size) {
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = std::malloc(size ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+	return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+uint64_t BenchmarkRunner::GetAllocationCount() {
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+BenchmarkRunner::BenchmarkRunner() {
+	minTime		= 0.5;
+	progress	= nullptr;
+}
+
+void BenchmarkRunner::Add(const std::string& name, int operationsPerBatch, BenchmarkFunc batch, BenchmarkFunc setup) {
+	benchmarks.push_back({ name, operationsPerBatch, batch, setup });
+}
+
+void BenchmarkRunner::ListBenchmarks(std::ostream& o) const {
+	for (const Benchmark& b : benchmarks) {
+		if (b.name.find(filter) != std::string::npos) {
+			o << b.name << "\n";
+		}
+	}
+}
+
+void BenchmarkRunner::RunAll() {
+	results.clear();
+	for (const Benchmark& b : benchmarks) {
+		if (b.name.find(filter) == std::string::npos) {
+			continue;
+		}
+		if (progress) {
+			*progress << "Running " << b.name << "..." << std::endl;
+		}
+		results.push_back(Run(b));
+	}
+}
+
+/*
+One untimed batch first, to warm the caches up and let anything that
+grows on first use (such as the QuadTree's node arrays) get to its full
+size, so that it's the steady state that gets measured.
+*/
+BenchmarkRunner::Result BenchmarkRunner::Run(const Benchmark& b) const {
+	if (b.setup) {
+		b.setup();
+	}
+	b.batch();
+
+	double		elapsed		= 0.0;
+	uint64_t	allocations	= 0;
+	uint64_t	batches		= 0;
+	while (elapsed < minTime || batches == 0) {
+		if (b.setup) {
+			b.setup();
+		}
+		uint64_t	allocationsBefore	= GetAllocationCount();
+		auto		start				= std::chrono::high_resolution_clock::now();
+		b.batch();
+		auto		end					= std::chrono::high_resolution_clock::now();
+		allocations += GetAllocationCount() - allocationsBefore;
+
+		elapsed += std::chrono::duration<double>(end - start).count();
+		batches++;
+	}
+	Result r;
+	r.name				= b.name;
+	r.operations		= batches * b.operationsPerBatch;
+	r.nsPerOp			= elapsed * 1e9 / (double)r.operations;
+	r.allocationsPerOp	= (double)allocations / (double)r.operations;
+	return r;
+}
+
+void BenchmarkRunner::PrintTable(std::ostream& o) const {
+	size_t nameWidth = 9;
+	for (const Result& r : results) {
+		nameWidth = std::max(nameWidth, r.name.size());
+	}
+	o << std::left << std::setw(nameWidth + 2) << "Benchmark"
+		<< std::right << std::setw(14) << "ns/op" << std::setw(14) << "allocs/op" << std::setw(14) << "ops" << "\n";
+	for (const Result& r : results) {
+		o << std::left << std::setw(nameWidth + 2) << r.name << std::right << std::fixed
+			<< std::setw(14) << std::setprecision(1) << r.nsPerOp
+			<< std::setw(14) << std::setprecision(3) << r.allocationsPerOp
+			<< std::setw(14) << r.operations << "\n";
+	}
+	o << std::defaultfloat;
+}
+
+//benchmark names are only ever letters, digits and punctuation, so they need no escaping
+void BenchmarkRunner::PrintJSON(std::ostream& o) const {
+	o << "{\n\t\"minTime\": " << minTime << ",\n\t\"benchmarks\": [";
+	for (size_t i = 0; i < results.size(); ++i) {
+		const Result& r = results[i];
+		o << (i ? ",\n" : "\n") << std::setprecision(6)
+			<< "\t\t{ \"name\": \"" << r.name << "\""
+			<< ", \"operations\": " << r.operations
+			<< ", \"nsPerOp\": " << r.nsPerOp
+			<< ", \"allocationsPerOp\": " << r.allocationsPerOp << " }";
+	}
+	o << "\n\t]\n}\n";
+}
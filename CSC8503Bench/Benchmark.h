@@ -0,0 +1,84 @@
+#pragma once
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		A small benchmark harness, so the collision kernels and the physics
+		step can be timed the same way on every commit. Each benchmark is a
+		batch function that does some fixed number of operations, and an
+		optional setup function that gets everything ready for a batch
+		without being timed (the physics benchmarks use this to rebuild
+		their scene, so every batch steps the same thing).
+
+		Batches are run until they've taken up at least the minimum time,
+		and the result is reported per operation: how long it took, and how
+		many heap allocations it made - every operator new in the program
+		is counted, so anything that allocates in a hot loop shows up.
+		*/
+		class BenchmarkRunner {
+		public:
+			typedef std::function<void()> BenchmarkFunc;
+
+			struct Result {
+				std::string name;
+				uint64_t	operations;
+				double		nsPerOp;
+				double		allocationsPerOp;
+			};
+
+			BenchmarkRunner();
+			~BenchmarkRunner() {}
+
+			void Add(const std::string& name, int operationsPerBatch, BenchmarkFunc batch, BenchmarkFunc setup = nullptr);
+
+			//only benchmarks with this in their name are run
+			void SetFilter(const std::string& filter) {
+				this->filter = filter;
+			}
+
+			void SetMinTime(double seconds) {
+				minTime = seconds;
+			}
+
+			//progress goes here as each benchmark is run, or nowhere if it's null
+			void SetProgressStream(std::ostream* o) {
+				progress = o;
+			}
+
+			void ListBenchmarks(std::ostream& o) const;
+			void RunAll();
+
+			const std::vector<Result>& GetResults() const {
+				return results;
+			}
+
+			void PrintTable(std::ostream& o) const;
+			void PrintJSON(std::ostream& o) const;
+
+			static uint64_t GetAllocationCount();
+
+			//stops the compiler throwing away work whose result is never used
+			static void Keep(int value) {
+				sink = sink + value;
+			}
+
+		protected:
+			struct Benchmark {
+				std::string		name;
+				int				operationsPerBatch;
+				BenchmarkFunc	batch;
+				BenchmarkFunc	setup;
+			};
+
+			Result Run(const Benchmark& b) const;
+
+			std::vector<Benchmark>	benchmarks;
+			std::vector<Result>		results;
+			std::string				filter;
+			double					minTime;
+			std::ostream*			progress;
+
+			static volatile int sink;
+		};
+	}
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "Benchmark.h"
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		Every dataset is made from a fixed seed, so every run (and every
+		commit) times exactly the same work.
+		*/
+		static const unsigned int BENCHMARK_SEED = 8503;
+
+		//GJK and EPA for every pair of dice, and the AABB and OBB / sphere tests
+		void AddCollisionBenchmarks(BenchmarkRunner& runner);
+
+		//building and querying a QuadTree of 100, 1000 and 10000 bodies
+		void AddQuadTreeBenchmarks(BenchmarkRunner& runner);
+
+		//whole PhysicsSystem frames, for scenes of 1 up to 1000 dice, and the integration kernels on their own
+		void AddPhysicsBenchmarks(BenchmarkRunner& runner);
+	}
+}
@@ -0,0 +1,195 @@
+#include "Benchmarks.h"
+#include "DiceSimulator.h"
+#include "GameWorld.h"
+#include "CollisionDetection.h"
+#include "AABBVolume.h"
+#include "OBBVolume.h"
+#include "SphereVolume.h"
+#include "ConvexHullVolume.h"
+#include "PhysicsObject.h"
+
+#include <random>
+#include <memory>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	const int DATASET_SIZE = 256;
+
+	struct DiceMaker {
+		const char* name;
+		GameObject* (*make)(GameWorld& world);
+	};
+
+	/*
+	A d20 made from a ConvexHullVolume, from the same corners the D20Volume
+	has typed in, so the generic hull's hill climbing can be compared with
+	the hand written one's.
+	*/
+	GameObject* AddHullD20(GameWorld& world) {
+		const float halfGoldRatio = (1.0f + sqrt(5.0f)) / 4.0f;
+		std::vector<Vector3> corners;
+		for (float a : { -0.5f, 0.5f }) {
+			for (float b : { -halfGoldRatio, halfGoldRatio }) {
+				corners.emplace_back(0.0f, a, b);
+				corners.emplace_back(b, 0.0f, a);
+				corners.emplace_back(a, b, 0.0f);
+			}
+		}
+		GameObject* hull = new GameObject();
+		hull->SetBoundingVolume((CollisionVolume*)new ConvexHullVolume(corners));
+		hull->SetPhysicsObject(new PhysicsObject(&hull->GetTransform(), hull->GetBoundingVolume()));
+		hull->GetPhysicsObject()->SetInverseMass(10.0f);
+		hull->GetPhysicsObject()->InitSphereInertia();
+		world.AddGameObject(hull);
+		return hull;
+	}
+
+	//the same sizes the DiceSimulator rolls them at, and a hull
+	const int DICE_MAKERS = DiceSimulator::MAX + 1;
+	const DiceMaker diceMakers[DICE_MAKERS] = {
+		{ "d4",		[](GameWorld& w) { return DiceSimulator::AddD4(w, Vector3(), 1); } },
+		{ "d6",		[](GameWorld& w) { return DiceSimulator::AddD6(w, Vector3(), Vector3(0.5f, 0.5f, 0.5f)); } },
+		{ "d8",		[](GameWorld& w) { return DiceSimulator::AddD8(w, Vector3(), 1); } },
+		{ "d10",	[](GameWorld& w) { return DiceSimulator::AddD10(w, Vector3(), 1); } },
+		{ "d12",	[](GameWorld& w) { return DiceSimulator::AddD12(w, Vector3(), 0.7f); } },
+		{ "d20",	[](GameWorld& w) { return DiceSimulator::AddD20(w, Vector3(), 1); } },
+		{ "hull",	[](GameWorld& w) { return AddHullD20(w); } },
+	};
+
+	struct Placement {
+		Vector3		positionA;
+		Quaternion	orientationA;
+		Vector3		positionB;
+		Quaternion	orientationB;
+	};
+
+	/*
+	Two of every die, so that every pair (a die against its own type
+	included) can be tested, with a set of placements where they overlap,
+	for GJK and EPA, and a set where they don't, for GJK on its own.
+	*/
+	struct DicePair {
+		GameWorld				world;
+		GameObject*				a;
+		GameObject*				b;
+		std::vector<Placement>	overlapping;
+		std::vector<Placement>	apart;
+	};
+
+	Quaternion RandomOrientation(std::mt19937& rng) {
+		std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+		return Quaternion::EulerAnglesToQuaternion(angle(rng), angle(rng), angle(rng));
+	}
+
+	void Place(GameObject* a, GameObject* b, const Placement& p) {
+		a->GetTransform().SetPosition(p.positionA).SetOrientation(p.orientationA);
+		b->GetTransform().SetPosition(p.positionB).SetOrientation(p.orientationB);
+	}
+
+	bool TestPair(GameObject* a, GameObject* b) {
+		CollisionDetection::CollisionInfo info;
+		info.a = a;
+		info.b = b;
+		return CollisionDetection::GJK(a, b, info);
+	}
+
+	std::shared_ptr<DicePair> MakeDicePair(int typeA, int typeB, std::mt19937& rng) {
+		std::shared_ptr<DicePair> pair = std::make_shared<DicePair>();
+		pair->a = diceMakers[typeA].make(pair->world);
+		pair->b = diceMakers[typeB].make(pair->world);
+
+		std::uniform_real_distribution<float> offset(-2.0f, 2.0f);
+		while ((int)pair->overlapping.size() < DATASET_SIZE || (int)pair->apart.size() < DATASET_SIZE) {
+			Placement p;
+			p.positionA		= Vector3();
+			p.orientationA	= RandomOrientation(rng);
+			p.positionB		= Vector3(offset(rng), offset(rng), offset(rng));
+			p.orientationB	= RandomOrientation(rng);
+
+			Place(pair->a, pair->b, p);
+			std::vector<Placement>& list = TestPair(pair->a, pair->b) ? pair->overlapping : pair->apart;
+			if ((int)list.size() < DATASET_SIZE) {
+				list.push_back(p);
+			}
+		}
+		return pair;
+	}
+
+	void AddGJKBenchmark(BenchmarkRunner& runner, const std::string& name, std::shared_ptr<DicePair> pair, const std::vector<Placement>& placements) {
+		runner.Add(name, (int)placements.size(),
+			[pair, &placements]() {
+				int hits = 0;
+				for (const Placement& p : placements) {
+					Place(pair->a, pair->b, p);
+					hits += TestPair(pair->a, pair->b);
+				}
+				BenchmarkRunner::Keep(hits);
+			}
+		);
+	}
+
+	template<typename VolumeA, typename VolumeB>
+	struct VolumePairs {
+		std::vector<VolumeA>	volumesA;
+		std::vector<Transform>	transformsA;
+		std::vector<VolumeB>	volumesB;
+		std::vector<Transform>	transformsB;
+	};
+}
+
+void NCL::CSC8503::AddCollisionBenchmarks(BenchmarkRunner& runner) {
+	std::mt19937 rng(BENCHMARK_SEED);
+
+	for (int i = 0; i < DICE_MAKERS; ++i) {
+		for (int j = i; j < DICE_MAKERS; ++j) {
+			std::shared_ptr<DicePair> pair = MakeDicePair(i, j, rng);
+			std::string types = std::string(diceMakers[i].name) + "-" + diceMakers[j].name;
+			AddGJKBenchmark(runner, "GJK/" + types, pair, pair->apart);
+			AddGJKBenchmark(runner, "GJK+EPA/" + types, pair, pair->overlapping);
+		}
+	}
+
+	//about half of the pairs overlap at these sizes
+	std::uniform_real_distribution<float> position(-2.5f, 2.5f);
+	std::uniform_real_distribution<float> size(0.25f, 1.5f);
+
+	auto aabbs = std::make_shared<VolumePairs<AABBVolume, AABBVolume>>();
+	for (int i = 0; i < DATASET_SIZE; ++i) {
+		aabbs->volumesA.emplace_back(Vector3(size(rng), size(rng), size(rng)));
+		aabbs->volumesB.emplace_back(Vector3(size(rng), size(rng), size(rng)));
+		aabbs->transformsA.emplace_back().SetPosition(Vector3(position(rng), position(rng), position(rng)));
+		aabbs->transformsB.emplace_back().SetPosition(Vector3(position(rng), position(rng), position(rng)));
+	}
+	runner.Add("AABBIntersection", DATASET_SIZE,
+		[aabbs]() {
+			int hits = 0;
+			for (int i = 0; i < DATASET_SIZE; ++i) {
+				CollisionDetection::CollisionInfo info;
+				hits += CollisionDetection::AABBIntersection(aabbs->volumesA[i], aabbs->transformsA[i], aabbs->volumesB[i], aabbs->transformsB[i], info);
+			}
+			BenchmarkRunner::Keep(hits);
+		}
+	);
+
+	auto obbSpheres = std::make_shared<VolumePairs<OBBVolume, SphereVolume>>();
+	for (int i = 0; i < DATASET_SIZE; ++i) {
+		obbSpheres->volumesA.emplace_back(Vector3(size(rng), size(rng), size(rng)));
+		obbSpheres->volumesB.emplace_back(size(rng));
+		obbSpheres->transformsA.emplace_back()
+			.SetPosition(Vector3(position(rng), position(rng), position(rng)))
+			.SetOrientation(RandomOrientation(rng));
+		obbSpheres->transformsB.emplace_back().SetPosition(Vector3(position(rng), position(rng), position(rng)));
+	}
+	runner.Add("OBBSphereIntersection", DATASET_SIZE,
+		[obbSpheres]() {
+			int hits = 0;
+			for (int i = 0; i < DATASET_SIZE; ++i) {
+				CollisionDetection::CollisionInfo info;
+				hits += CollisionDetection::OBBSphereIntersection(obbSpheres->volumesA[i], obbSpheres->transformsA[i], obbSpheres->volumesB[i], obbSpheres->transformsB[i], info);
+			}
+			BenchmarkRunner::Keep(hits);
+		}
+	);
+}
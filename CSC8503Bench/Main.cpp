@@ -0,0 +1,60 @@
+#include "Benchmarks.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+#include <cstring>
+#include <cstdlib>
+
+/*
+Runs the benchmarks without a window or renderer, so it can be run from
+a build script. The results go to stdout, either as a table or (with
+--json) as JSON that can be kept and compared against later runs, while
+the progress messages go to stderr so they don't get mixed in with them.
+
+	CSC8503Bench [--json] [--filter <text>] [--min-time <seconds>] [--list]
+*/
+int main(int argc, char** argv) {
+	BenchmarkRunner runner;
+	bool json = false;
+	bool list = false;
+
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--json") == 0) {
+			json = true;
+		}
+		else if (strcmp(argv[i], "--list") == 0) {
+			list = true;
+		}
+		else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+			runner.SetFilter(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+			runner.SetMinTime(atof(argv[++i]));
+		}
+		else {
+			std::cerr << "Usage: " << argv[0] << " [--json] [--filter <text>] [--min-time <seconds>] [--list]\n";
+			return 1;
+		}
+	}
+
+	AddCollisionBenchmarks(runner);
+	AddQuadTreeBenchmarks(runner);
+	AddPhysicsBenchmarks(runner);
+
+	if (list) {
+		runner.ListBenchmarks(std::cout);
+		return 0;
+	}
+
+	runner.SetProgressStream(&std::cerr);
+	runner.RunAll();
+
+	if (json) {
+		runner.PrintJSON(std::cout);
+	}
+	else {
+		runner.PrintTable(std::cout);
+	}
+	return 0;
+}
@@ -0,0 +1,159 @@
+#include "Benchmarks.h"
+#include "DiceSimulator.h"
+#include "PhysicsSystem.h"
+#include "GameWorld.h"
+#include "RigidBodyStore.h"
+
+#include <random>
+#include <memory>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	const int	FRAMES_PER_BATCH	= 120;
+	const float	FRAME_DT			= 1.0f / 60.0f;
+	const int	SUBSTEPS			= 2;	//the same rate the DiceSimulator steps at
+
+	/*
+	Dice dropped into a tray, in layers of up to 10 x 10, with a random
+	mix of types and orientations. The scene is rebuilt from the same seed
+	before every batch, so each batch steps through exactly the same 2
+	seconds of dice falling, bouncing and settling.
+	*/
+	class DiceScene {
+	public:
+		DiceScene(int diceCount) {
+			this->diceCount = diceCount;
+			world	= nullptr;
+			physics	= nullptr;
+		}
+
+		~DiceScene() {
+			Clear();
+		}
+
+		void Build() {
+			Clear();
+			world	= new GameWorld();
+			world->Seed(BENCHMARK_SEED);
+			physics	= new PhysicsSystem(*world);
+			physics->UseGravity(true);
+			physics->SetDeterministic(true);
+
+			int		side		= std::min(10, (int)std::ceil(std::sqrt((float)diceCount)));
+			float	spacing		= 2.0f;
+			float	trayHalf	= side * spacing * 0.5f + 2.0f;
+
+			Vector3 dimensions(trayHalf, 2, trayHalf);
+			DiceSimulator::AddFloor(*world, Vector3(0, 0, 0), dimensions);
+			DiceSimulator::AddCube(*world, Vector3(0, dimensions.y, dimensions.z - 1.0f), Vector3(dimensions.x, 4, 1), 0);
+			DiceSimulator::AddCube(*world, Vector3(0, dimensions.y, -dimensions.z + 1.0f), Vector3(dimensions.x, 4, 1), 0);
+			DiceSimulator::AddCube(*world, Vector3(dimensions.x - 1.0f, dimensions.y, 0), Vector3(1, 4, dimensions.z), 0);
+			DiceSimulator::AddCube(*world, Vector3(-dimensions.x + 1.0f, dimensions.y, 0), Vector3(1, 4, dimensions.z), 0);
+
+			std::mt19937 rng(BENCHMARK_SEED);
+			std::uniform_int_distribution<int>		type(0, DiceSimulator::MAX - 1);
+			std::uniform_real_distribution<float>	angle(0.0f, 360.0f);
+			for (int i = 0; i < diceCount; ++i) {
+				int layer	= i / (side * side);
+				int column	= i % side;
+				int row		= (i / side) % side;
+				Vector3 position(
+					(column - (side - 1) * 0.5f) * spacing,
+					5.0f + layer * spacing,
+					(row - (side - 1) * 0.5f) * spacing
+				);
+				GameObject* dice = AddDice((DiceSimulator::DiceType)type(rng), position);
+				dice->GetTransform().SetOrientation(Quaternion::EulerAnglesToQuaternion(angle(rng), angle(rng), angle(rng)));
+			}
+		}
+
+		void Step() {
+			for (int i = 0; i < FRAMES_PER_BATCH; ++i) {
+				physics->FixedUpdate(FRAME_DT, SUBSTEPS);
+			}
+		}
+
+	protected:
+		GameObject* AddDice(DiceSimulator::DiceType type, const Vector3& position) {
+			switch (type) {
+				case DiceSimulator::d4:		return DiceSimulator::AddD4(*world, position, 1);
+				case DiceSimulator::d6:		return DiceSimulator::AddD6(*world, position, Vector3(0.5f, 0.5f, 0.5f));
+				case DiceSimulator::d8:		return DiceSimulator::AddD8(*world, position, 1);
+				case DiceSimulator::d10:	return DiceSimulator::AddD10(*world, position, 1);
+				case DiceSimulator::d12:	return DiceSimulator::AddD12(*world, position, 0.7f);
+				default:					return DiceSimulator::AddD20(*world, position, 1);
+			}
+		}
+
+		void Clear() {
+			delete physics;
+			if (world) {
+				world->ClearAndErase();
+			}
+			delete world;
+			physics	= nullptr;
+			world	= nullptr;
+		}
+
+		int				diceCount;
+		GameWorld*		world;
+		PhysicsSystem*	physics;
+	};
+
+	/*
+	Just the SIMD integration kernels, over a store gathered from the same
+	dice, with nothing for them to collide with. The results are never
+	written back to the dice, so the scene only needs building once, and
+	each batch starts from a fresh gather of it.
+	*/
+	class IntegrationScene : public DiceScene {
+	public:
+		IntegrationScene(int diceCount) : DiceScene(diceCount) {
+		}
+
+		void Build() {
+			if (!world) {
+				DiceScene::Build();
+			}
+			store.Gather(*world, true);
+		}
+
+		void Step() {
+			for (int i = 0; i < FRAMES_PER_BATCH; ++i) {
+				store.IntegrateAccel(FRAME_DT, Vector3(0, -9.8f, 0));
+				store.IntegrateVelocity(FRAME_DT);
+			}
+		}
+
+	protected:
+		RigidBodyStore store;
+	};
+}
+
+void NCL::CSC8503::AddPhysicsBenchmarks(BenchmarkRunner& runner) {
+	for (int count : { 1, 10, 100, 1000 }) {
+		auto scene = std::make_shared<DiceScene>(count);
+		runner.Add("PhysicsFrame/" + std::to_string(count), FRAMES_PER_BATCH,
+			[scene]() {
+				scene->Step();
+			},
+			[scene]() {
+				scene->Build();
+			}
+		);
+	}
+
+	for (int count : { 1000, 10000 }) {
+		auto scene = std::make_shared<IntegrationScene>(count);
+		runner.Add("Integration/" + std::to_string(count), FRAMES_PER_BATCH,
+			[scene]() {
+				scene->Step();
+			},
+			[scene]() {
+				scene->Build();
+			}
+		);
+	}
+}
@@ -0,0 +1,76 @@
+#include "Benchmarks.h"
+#include "QuadTree.h"
+
+#include <random>
+#include <memory>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	struct Body {
+		Vector3 position;
+		Vector3 halfSize;
+	};
+
+	/*
+	The bodies are spread over an area that grows with how many there
+	are, so that each size of tree is about as crowded as the others.
+	*/
+	struct QuadTreeData {
+		QuadTreeData(float worldSize) : tree(Vector2(worldSize, worldSize)) {}
+
+		QuadTree<int>		tree;
+		std::vector<Body>	bodies;
+	};
+
+	void Build(QuadTreeData& data) {
+		data.tree.Clear();
+		for (int i = 0; i < (int)data.bodies.size(); ++i) {
+			data.tree.Insert(i, data.bodies[i].position, data.bodies[i].halfSize);
+		}
+	}
+
+	//every pair sharing a leaf is a candidate, just like in PhysicsSystem::QuadTreeBroadPhase
+	int Query(QuadTreeData& data) {
+		int pairs = 0;
+		data.tree.OperateOnContents(
+			[&](std::span<QuadTreeEntry<int>> entries) {
+				for (size_t i = 0; i < entries.size(); ++i) {
+					for (size_t j = i + 1; j < entries.size(); ++j) {
+						pairs += CollisionDetection::AABBTest(entries[i].pos, entries[j].pos, entries[i].size, entries[j].size);
+					}
+				}
+			}
+		);
+		return pairs;
+	}
+}
+
+void NCL::CSC8503::AddQuadTreeBenchmarks(BenchmarkRunner& runner) {
+	std::mt19937 rng(BENCHMARK_SEED);
+	std::uniform_real_distribution<float> size(0.25f, 1.5f);
+
+	for (int count : { 100, 1000, 10000 }) {
+		float worldSize = 2.0f * std::sqrt((float)count);
+		std::uniform_real_distribution<float> position(-worldSize, worldSize);
+
+		auto data = std::make_shared<QuadTreeData>(worldSize);
+		for (int i = 0; i < count; ++i) {
+			data->bodies.push_back({ Vector3(position(rng), size(rng), position(rng)), Vector3(size(rng), size(rng), size(rng)) });
+		}
+		Build(*data);
+
+		std::string bodies = std::to_string(count);
+		runner.Add("QuadTree/Build/" + bodies, 1,
+			[data]() {
+				Build(*data);
+			}
+		);
+		runner.Add("QuadTree/Query/" + bodies, 1,
+			[data]() {
+				BenchmarkRunner::Keep(Query(*data));
+			}
+		);
+	}
+}
@@ -8,7 +8,10 @@
 #include "Debug.h"
 #include "D4Volume.h"
 #include "D8Volume.h"
+#include "D10Volume.h"
+#include "D12Volume.h"
 #include "D20Volume.h"
+#include "ConvexHullVolume.h"
 
 using namespace NCL;
 
@@ -54,11 +57,26 @@ bool CollisionDetection::RayIntersection(const Ray& r, GameObject& object, RayCo
 		D8Volume* vol = (D8Volume*)object.GetBoundingVolume();
 		hasCollided = RaySphereIntersection(r, worldTransform, SphereVolume(vol->GetHeight()), collision); break;
 	}
+	case VolumeType::D10_Dice:
+	{
+		D10Volume* vol = (D10Volume*)object.GetBoundingVolume();
+		hasCollided = RaySphereIntersection(r, worldTransform, SphereVolume(vol->GetRadius()), collision); break;
+	}
+	case VolumeType::D12_Dice:
+	{
+		D12Volume* vol = (D12Volume*)object.GetBoundingVolume();
+		hasCollided = RaySphereIntersection(r, worldTransform, SphereVolume(vol->GetRadius()), collision); break;
+	}
 	case VolumeType::D20_Dice: 
 	{
 		D20Volume* vol = (D20Volume*)object.GetBoundingVolume();
 		hasCollided = RaySphereIntersection(r, worldTransform, SphereVolume(vol->GetEdgeLength() * 2), collision); break;
 	}
+	case VolumeType::Mesh:
+	{
+		ConvexHullVolume* vol = (ConvexHullVolume*)object.GetBoundingVolume();
+		hasCollided = RaySphereIntersection(r, worldTransform, SphereVolume(vol->GetRadius()), collision); break;
+	}
 
 	case VolumeType::Capsule:	hasCollided = RayCapsuleIntersection(r, worldTransform, (const CapsuleVolume&)*volume, collision); break;
 	}
@@ -161,112 +179,109 @@ bool CollisionDetection::RayCapsuleIntersection(const Ray& r, const Transform& w
 	return false;
 }
 
-bool CollisionDetection::ObjectIntersection(GameObject* a, GameObject* b, CollisionInfo& collisionInfo) {
-	const CollisionVolume* volA = a->GetBoundingVolume();
-	const CollisionVolume* volB = b->GetBoundingVolume();
-
-	if (!volA || !volB) {
-		return false;
+namespace {
+	using CollisionInfo = CollisionDetection::CollisionInfo;
+	using GJKCache		= CollisionDetection::GJKCache;
+
+	//Newell's method, as the corners SupportFeature finds aren't always quite in a plane
+	Vector3 FeatureNormal(const Vector3* points, int count) {
+		Vector3 normal;
+		for (int i = 0; i < count; ++i) {
+			const Vector3& cur	= points[i];
+			const Vector3& next = points[(i + 1) % count];
+			normal.x += (cur.y - next.y) * (cur.z + next.z);
+			normal.y += (cur.z - next.z) * (cur.x + next.x);
+			normal.z += (cur.x - next.x) * (cur.y + next.y);
+		}
+		return normal.Normalised();
 	}
 
-	
-
-	collisionInfo.a = a;
-	collisionInfo.b = b;
-
-	Transform& transformA = a->GetTransform();
-	Transform& transformB = b->GetTransform();
-
-	VolumeType pairType = (VolumeType)((int)volA->type | (int)volB->type);
-
-	//Two AABBs
-	if (pairType == VolumeType::AABB) {
-		return AABBIntersection((AABBVolume&)*volA, transformA, (AABBVolume&)*volB, transformB, collisionInfo);
-	}
-	//Two Spheres
-	if (pairType == VolumeType::Sphere) {
-		return SphereIntersection((SphereVolume&)*volA, transformA, (SphereVolume&)*volB, transformB, collisionInfo);
-	}
-	//Two OBBs
-	if (pairType == VolumeType::OBB) {
-		return GJK(a, b, collisionInfo);
+	//wraps up the tests that take volumes and transforms, so they can go in the intersection table
+	template<typename VolumeA, typename VolumeB, bool (*Test)(const VolumeA&, const Transform&, const VolumeB&, const Transform&, CollisionInfo&)>
+	bool VolumeIntersection(GameObject* a, GameObject* b, CollisionInfo& collisionInfo, GJKCache* cache) {
+		return Test((const VolumeA&)*a->GetBoundingVolume(), a->GetTransform(), (const VolumeB&)*b->GetBoundingVolume(), b->GetTransform(), collisionInfo);
 	}
+}
 
-	if (pairType == VolumeType::D4_Dice)
-	{
-		return GJK(a, b, collisionInfo);
-	}
-	//Two Capsules
+CollisionDetection::IntersectionFunc CollisionDetection::intersectionTable[VOLUME_TYPE_COUNT][VOLUME_TYPE_COUNT];
+bool CollisionDetection::intersectionTableBuilt = CollisionDetection::BuildIntersectionTable();
+thread_local CollisionDetection::IterationCounts CollisionDetection::iterationCounts;
 
-	//AABB vs Sphere pairs
-	if (volA->type == VolumeType::AABB && volB->type == VolumeType::Sphere) {
-		return AABBSphereIntersection((AABBVolume&)*volA, transformA, (SphereVolume&)*volB, transformB, collisionInfo);
-	}
-	if (volA->type == VolumeType::Sphere && volB->type == VolumeType::AABB) {
-		collisionInfo.a = b;
-		collisionInfo.b = a;
-		return AABBSphereIntersection((AABBVolume&)*volB, transformB, (SphereVolume&)*volA, transformA, collisionInfo);
-	}
+CollisionDetection::IterationCounts CollisionDetection::TakeIterationCounts() {
+	IterationCounts counts = iterationCounts;
+	iterationCounts = IterationCounts();
+	return counts;
+}
 
-	//AABB vs OBB
-	if (volA->type == VolumeType::AABB && volB->type == VolumeType::OBB)
-	{
-		return GJK(a, b, collisionInfo);
-	}
-	if (volA->type == VolumeType::OBB && volB->type == VolumeType::AABB)
-	{
-		collisionInfo.a = b;
-		collisionInfo.b = a;
-		return GJK(b, a, collisionInfo);
-	}
+bool CollisionDetection::NoIntersection(GameObject* a, GameObject* b, CollisionInfo& collisionInfo, GJKCache* cache) {
+	return false;
+}
 
-	//OBB vs sphere pairs
-	if (volA->type == VolumeType::OBB && volB->type == VolumeType::Sphere) {
-		return OBBSphereIntersection((OBBVolume&)*volA, transformA, (SphereVolume&)*volB, transformB, collisionInfo);
-	}
-	if (volA->type == VolumeType::Sphere && volB->type == VolumeType::OBB) {
-		collisionInfo.a = b;
-		collisionInfo.b = a;
-		return OBBSphereIntersection((OBBVolume&)*volB, transformB, (SphereVolume&)*volA, transformA, collisionInfo);
-	}
+template<CollisionDetection::IntersectionFunc F>
+bool CollisionDetection::SwappedIntersection(GameObject* a, GameObject* b, CollisionInfo& collisionInfo, GJKCache* cache) {
+	collisionInfo.a = b;
+	collisionInfo.b = a;
+	return F(b, a, collisionInfo, cache);
+}
 
-	//Capsule vs other interactions
-	if (volA->type == VolumeType::Capsule && volB->type == VolumeType::Sphere) {
-		return SphereCapsuleIntersection((CapsuleVolume&)*volA, transformA, (SphereVolume&)*volB, transformB, collisionInfo);
-	}
-	if (volA->type == VolumeType::Sphere && volB->type == VolumeType::Capsule) {
-		collisionInfo.a = b;
-		collisionInfo.b = a;
-		return SphereCapsuleIntersection((CapsuleVolume&)*volB, transformB, (SphereVolume&)*volA, transformA, collisionInfo);
+//F takes its objects in the order a, b - objects the other way round get swapped before they reach it
+template<CollisionDetection::IntersectionFunc F>
+void CollisionDetection::SetIntersection(VolumeType a, VolumeType b) {
+	intersectionTable[VolumeIndex(a)][VolumeIndex(b)] = F;
+	if (a != b) {
+		intersectionTable[VolumeIndex(b)][VolumeIndex(a)] = SwappedIntersection<F>;
 	}
+}
 
-	if (volA->type == VolumeType::Capsule && volB->type == VolumeType::AABB) {
-		return AABBCapsuleIntersection((CapsuleVolume&)*volA, transformA, (AABBVolume&)*volB, transformB, collisionInfo);
+//for tests that don't mind which way round the objects are
+template<CollisionDetection::IntersectionFunc F>
+void CollisionDetection::SetSymmetricIntersection(VolumeType a, VolumeType b) {
+	intersectionTable[VolumeIndex(a)][VolumeIndex(b)] = F;
+	intersectionTable[VolumeIndex(b)][VolumeIndex(a)] = F;
+}
+
+bool CollisionDetection::BuildIntersectionTable() {
+	for (int i = 0; i < VOLUME_TYPE_COUNT; ++i) {
+		for (int j = 0; j < VOLUME_TYPE_COUNT; ++j) {
+			intersectionTable[i][j] = NoIntersection;
+		}
 	}
-	if (volB->type == VolumeType::Capsule && volA->type == VolumeType::AABB) {
-		collisionInfo.a = b;
-		collisionInfo.b = a;
-		return AABBCapsuleIntersection((CapsuleVolume&)*volB, transformB, (AABBVolume&)*volA, transformA, collisionInfo);
+	SetIntersection<VolumeIntersection<AABBVolume, AABBVolume, AABBIntersection>>(VolumeType::AABB, VolumeType::AABB);
+	SetIntersection<VolumeIntersection<SphereVolume, SphereVolume, SphereIntersection>>(VolumeType::Sphere, VolumeType::Sphere);
+	SetIntersection<GJK>(VolumeType::OBB, VolumeType::OBB);
+
+	SetIntersection<VolumeIntersection<AABBVolume, SphereVolume, AABBSphereIntersection>>(VolumeType::AABB, VolumeType::Sphere);
+	SetIntersection<GJK>(VolumeType::AABB, VolumeType::OBB);
+	SetIntersection<VolumeIntersection<OBBVolume, SphereVolume, OBBSphereIntersection>>(VolumeType::OBB, VolumeType::Sphere);
+	SetIntersection<VolumeIntersection<CapsuleVolume, SphereVolume, SphereCapsuleIntersection>>(VolumeType::Capsule, VolumeType::Sphere);
+	SetIntersection<VolumeIntersection<CapsuleVolume, AABBVolume, AABBCapsuleIntersection>>(VolumeType::Capsule, VolumeType::AABB);
+
+	//dice (and hulls built from meshes) use GJK against anything
+	const VolumeType gjkTypes[] = { VolumeType::D4_Dice, VolumeType::D8_Dice, VolumeType::D10_Dice, VolumeType::D12_Dice, VolumeType::D20_Dice, VolumeType::Mesh };
+	for (VolumeType gjkType : gjkTypes) {
+		for (int i = 0; i < VOLUME_TYPE_COUNT; ++i) {
+			VolumeType other = (VolumeType)(1 << i);
+			if (other != VolumeType::Invalid) {
+				SetSymmetricIntersection<GJK>(gjkType, other);
+			}
+		}
 	}
+	return true;
+}
 
-	//D4 with anything
-	if (volA->type == VolumeType::D4_Dice || volB->type == VolumeType::D4_Dice)
-	{
-		return GJK(a, b, collisionInfo);
-	}
+bool CollisionDetection::ObjectIntersection(GameObject* a, GameObject* b, CollisionInfo& collisionInfo, GJKCache* cache) {
+	const CollisionVolume* volA = a->GetBoundingVolume();
+	const CollisionVolume* volB = b->GetBoundingVolume();
 
-	//D8 with anything
-	if (volA->type == VolumeType::D8_Dice || volB->type == VolumeType::D8_Dice)
-	{
-		return GJK(a, b, collisionInfo);
+	if (!volA || !volB) {
+		return false;
 	}
 
-	if (volA->type == VolumeType::D20_Dice || volB->type == VolumeType::D20_Dice)
-	{
-		return GJK(a, b, collisionInfo);
-	}
+	collisionInfo.a = a;
+	collisionInfo.b = b;
+	collisionInfo.ClearContactPoints();
 
-	return false;
+	return intersectionTable[VolumeIndex(volA->type)][VolumeIndex(volB->type)](a, b, collisionInfo, cache);
 }
 
 bool CollisionDetection::AABBTest(const Vector3& posA, const Vector3& posB, const Vector3& halfSizeA, const Vector3& halfSizeB) {
@@ -394,10 +409,10 @@ bool  CollisionDetection::OBBSphereIntersection(const OBBVolume& volumeA, const
 	Transform aBBBoxAtOrigin;
 	if (AABBSphereIntersection(tempVA, aBBBoxAtOrigin, volumeB, tempSphere, collisionInfo))
 	{
-		collisionInfo.point.localA = worldTransformA.GetOrientation() * collisionInfo.point.localA;
-		collisionInfo.point.localB = worldTransformA.GetOrientation() * collisionInfo.point.localB;
-		collisionInfo.point.normal = worldTransformA.GetOrientation() * collisionInfo.point.normal;
-		collisionInfo.point.normal.Normalise();
+		collisionInfo.points[0].localA = worldTransformA.GetOrientation() * collisionInfo.points[0].localA;
+		collisionInfo.points[0].localB = worldTransformA.GetOrientation() * collisionInfo.points[0].localB;
+		collisionInfo.points[0].normal = worldTransformA.GetOrientation() * collisionInfo.points[0].normal;
+		collisionInfo.points[0].normal.Normalise();
 		return true;
 	}
 	return false;
@@ -408,20 +423,43 @@ bool  CollisionDetection::OBBSphereIntersection(const OBBVolume& volumeA, const
 * It also follows the improvements provided by Kevin Moran's implementation of GJK (https://github.com/kevinmoran/GJK/blob/master/GJK.h, accessed Dec '23), which
 * streamlines away some of the unnecessary checks in Muratori's original version.
 */
-bool CollisionDetection::GJK(GameObject* a, GameObject* b, CollisionInfo& collisionInfo)
+bool CollisionDetection::GJK(GameObject* a, GameObject* b, CollisionInfo& collisionInfo, GJKCache* cache)
 {
 	//draw a tetrahedron within a Minkowski difference, searching for an encapsulation of the origin
 	//if found, return true, but also run EPA to fill in collionInfo with collision point & normal
 
 	MinkVals corners[GJK_MAX];
 
+	if (cache)
+	{
+		if (cache->hasSeparatingAxis)
+		{
+			//still apart along the axis that separated them last time? Then there's nothing more to do
+			BuildMinkVals(cache->separatingAxis, a, b, corners, GJK_A);
+			if (Vector3::Dot(corners[GJK_A].mkw, cache->separatingAxis) < 0) return false;
+			cache->hasSeparatingAxis = false;
+		}
+		if (cache->hasSimplex && GJKWarmStart(a, b, corners, *cache))
+		{
+			return EPA(a, b, corners, collisionInfo);
+		}
+	}
+
 	Vector3 searchIn = b->GetTransform().GetPosition() - a->GetTransform().GetPosition();
 	BuildMinkVals(searchIn, a, b, corners, GJK_C);
 	searchIn = -corners[GJK_C].mkw;
 	BuildMinkVals(searchIn, a, b, corners, GJK_B);
 
 	//early out if origin not crossed by second point
-	if (Vector3::Dot(corners[GJK_B].mkw, searchIn) < 0) return false;
+	if (Vector3::Dot(corners[GJK_B].mkw, searchIn) < 0)
+	{
+		if (cache)
+		{
+			cache->separatingAxis		= searchIn;
+			cache->hasSeparatingAxis	= true;
+		}
+		return false;
+	}
 
 	//if we didn't early out, our newest point, b, must be beyond the origin. Therefore, search in the direction of the origin, perpendicular to BC
 	searchIn = Vector3::Cross(Vector3::Cross(corners[GJK_C].mkw - corners[GJK_B].mkw, -corners[GJK_B].mkw), corners[GJK_C].mkw - corners[GJK_B].mkw);
@@ -435,8 +473,17 @@ bool CollisionDetection::GJK(GameObject* a, GameObject* b, CollisionInfo& collis
 	bool triCasePassed = false;
 	for (int i = 0; i < 64; i++)
 	{
+		iterationCounts.gjk++;
 		BuildMinkVals(searchIn, a, b, corners, GJK_A);
-		if (Vector3::Dot(corners[GJK_A].mkw, searchIn) < 0) return false;
+		if (Vector3::Dot(corners[GJK_A].mkw, searchIn) < 0)
+		{
+			if (cache)
+			{
+				cache->separatingAxis		= searchIn;
+				cache->hasSeparatingAxis	= true;
+			}
+			return false;
+		}
 
 		if (!triCasePassed)
 		{
@@ -448,8 +495,11 @@ bool CollisionDetection::GJK(GameObject* a, GameObject* b, CollisionInfo& collis
 		{
 			if (GJKTetraCase(corners, searchIn))
 			{
-				EPA(a, b, corners, collisionInfo);
-				return true;
+				if (cache)
+				{
+					cache->hasSimplex = TetraEnclosesOrigin(corners, cache->simplexDirs);
+				}
+				return EPA(a, b, corners, collisionInfo);
 			}
 		}
 
@@ -549,6 +599,55 @@ bool CollisionDetection::GJKTetraCase(MinkVals* corners, Vector3& searchIn)
 	return true;
 }
 
+/*
+Rebuilds last time's tetrahedron by searching in the same directions that
+made it. If the objects have barely moved, it'll still have the origin
+inside it, and GJK's search can be skipped entirely. If not, the cache is
+dropped and GJK starts from scratch.
+*/
+bool CollisionDetection::GJKWarmStart(GameObject* a, GameObject* b, MinkVals* corners, GJKCache& cache)
+{
+	for (int i = 0; i < GJK_MAX; i++)
+	{
+		BuildMinkVals(cache.simplexDirs[i], a, b, corners, (GJK_Points)i);
+	}
+	cache.hasSimplex = TetraEnclosesOrigin(corners, cache.simplexDirs);
+	return cache.hasSimplex;
+}
+
+/*
+EPA expects the tetrahedron's faces wound so that ABC, ACD, ADB and BDC all
+face outwards, which is what GJK hands it. A rebuilt tetrahedron could have
+been flipped inside out, or squashed flat, so both that and the origin being
+inside are checked here. If all is well, each corner's direction is set to
+point away from the face opposite it - the direction that corner is furthest
+out in, and so the best direction to search in to find it again next time.
+*/
+bool CollisionDetection::TetraEnclosesOrigin(const MinkVals* corners, Vector3* cornerDirs)
+{
+	const int faces[GJK_MAX][4] = {
+		//3 corners of an outward facing face, and the corner opposite it
+		{ GJK_B, GJK_D, GJK_C, GJK_A },
+		{ GJK_A, GJK_C, GJK_D, GJK_B },
+		{ GJK_A, GJK_D, GJK_B, GJK_C },
+		{ GJK_A, GJK_B, GJK_C, GJK_D },
+	};
+	Vector3 dirs[GJK_MAX];
+	for (int i = 0; i < GJK_MAX; i++)
+	{
+		const Vector3& p = corners[faces[i][0]].mkw;
+		Vector3 normal = Vector3::Cross(corners[faces[i][1]].mkw - p, corners[faces[i][2]].mkw - p);
+		if (Vector3::Dot(normal, corners[faces[i][3]].mkw - p) >= 0) return false;
+		if (Vector3::Dot(normal, -p) > 0) return false;
+		dirs[faces[i][3]] = -normal;
+	}
+	for (int i = 0; i < GJK_MAX; i++)
+	{
+		cornerDirs[i] = dirs[i];
+	}
+	return true;
+}
+
 void CollisionDetection::BuildMinkVals(Vector3 searchIn, GameObject* a, GameObject* b, MinkVals* mv, GJK_Points gjk_ind)
 {
 	mv[gjk_ind].aPos = a->GetBoundingVolume()->Support(-searchIn, a->GetTransform());
@@ -556,163 +655,548 @@ void CollisionDetection::BuildMinkVals(Vector3 searchIn, GameObject* a, GameObje
 	mv[gjk_ind].mkw = mv[gjk_ind].bPos - mv[gjk_ind].aPos;
 }
 
-void CollisionDetection::EPA(GameObject* a, GameObject* b, MinkVals* corners, CollisionInfo& collisionInfo)
+/*
+EPA grows a polytope out from the GJK simplex, inside the Minkowski difference,
+until the face closest to the origin can't be pushed out any further - that
+face's distance is how far the objects overlap, and its normal is the
+direction to push them apart in. If the simplex is too flat for any of
+its faces to have a normal, there's no overlap worth pushing apart, and
+it gives up.
+*/
+bool CollisionDetection::EPA(GameObject* a, GameObject* b, MinkVals* corners, CollisionInfo& collisionInfo)
 {
-	std::vector<Face> faces = ConvertSimplexToFaces(corners);
-	std::vector<std::pair <MinkVals, MinkVals>> uniqueEdges;
-	std::pair<int, float> closestFaceInfo;
+	EPAPolytope poly;
+	poly.Init(corners);
+
+	//Expand never leaves the polytope with a hole in it, so there's always a closest face - starting with one of the simplex's
+	int closestFace = poly.ClosestFace();
+	if (poly.faces[closestFace].distance == FLT_MAX)
+	{
+		return false; //the simplex was squashed flat, so the objects are only just touching, if that
+	}
+
 	int interations = 64;
 	for (int i = 0; i < interations; i++)
 	{
-		closestFaceInfo = FindClosestFace(faces);
-		int closestFaceIndex = closestFaceInfo.first;
-		float closestFaceDist = closestFaceInfo.second;
+		iterationCounts.epa++;
+		const EPAPolytope::PolyFace& face = poly.faces[closestFace];
 		MinkVals newCorner;
-		BuildMinkVals(faces[closestFaceIndex].normal, a, b, &newCorner);
+		BuildMinkVals(face.normal, a, b, &newCorner);
 
-		float oldVsNewFaceDistance = abs(Vector3::Dot(faces[closestFaceIndex].normal, newCorner.mkw) - closestFaceDist);
+		float oldVsNewFaceDistance = std::abs(Vector3::Dot(face.normal, newCorner.mkw) - face.distance);
 
 		if (oldVsNewFaceDistance < 0.001f)
 		{
-			LogGJKEPACollisionInfo(faces, closestFaceInfo, collisionInfo, a->GetTransform().GetPosition(), b->GetTransform().GetPosition());
-			return;
+			break;
 		}
-		else
+		//if the polytope is full, or the new corner doesn't push it out any further, we'll have to make do with what we've got
+		if (poly.vertCount == EPAPolytope::MAX_VERTS || !poly.Expand(poly.AddVert(newCorner)))
 		{
-			FindUniqueEdges(faces, uniqueEdges, newCorner);
-			ConvertEdgesToFaces(uniqueEdges, faces, newCorner);
-		}		
+			break;
+		}
+		int nextFace = poly.ClosestFace();
+		if (nextFace < 0)
+		{
+			break;
+		}
+		closestFace = nextFace;
 	}
-	//if, after an arbitrary number of runs, we cannot find an edge within tolerance, send our best guess
-	closestFaceInfo = FindClosestFace(faces);
-	LogGJKEPACollisionInfo(faces, closestFaceInfo, collisionInfo, a->GetTransform().GetPosition(), b->GetTransform().GetPosition());
+	//if we ran out of runs without finding a face within tolerance, this is our best guess
+	LogGJKEPACollisionInfo(poly.GetFace(closestFace), poly.faces[closestFace].distance, collisionInfo, a->GetTransform().GetPosition(), b->GetTransform().GetPosition());
+	BuildContactManifold(a, b, collisionInfo);
+	return true;
 }
 
-std::vector<CollisionDetection::Face> CollisionDetection::ConvertSimplexToFaces(MinkVals* corners)
+void CollisionDetection::EPAPolytope::Init(MinkVals* corners)
 {
-	std::vector<CollisionDetection::Face> faces(4);
-	faces[0].a = corners[GJK_A]; faces[0].b = corners[GJK_B]; faces[0].c = corners[GJK_C];
-	faces[1].a = corners[GJK_A]; faces[1].b = corners[GJK_C]; faces[1].c = corners[GJK_D];
-	faces[2].a = corners[GJK_A]; faces[2].b = corners[GJK_D]; faces[2].c = corners[GJK_B];
-	faces[3].a = corners[GJK_B]; faces[3].b = corners[GJK_D]; faces[3].c = corners[GJK_C];
-	for (int i = 0; i < faces.size(); i++)
-		faces[i].BuildNorm();
-	return faces;
+	vertCount	= 0;
+	aliveCount	= 0;
+	freeCount	= 0;
+	slotsUsed	= 0;
+	heapCount	= 0;
+	edgeCount	= 0;
+	facesMade	= 0;
+	interior	= Vector3(0, 0, 0);
+	for (int i = 0; i < GJK_MAX; i++)
+	{
+		verts[vertCount++] = corners[i];
+		interior += corners[i].mkw;
+	}
+	//the polytope only ever grows, so the middle of the simplex stays inside it
+	interior = interior / (float)GJK_MAX;
+
+	AddFace(GJK_A, GJK_B, GJK_C);
+	AddFace(GJK_A, GJK_C, GJK_D);
+	AddFace(GJK_A, GJK_D, GJK_B);
+	AddFace(GJK_B, GJK_D, GJK_C);
 }
 
-void CollisionDetection::ConvertEdgesToFaces(const std::vector<std::pair<MinkVals, MinkVals>>& uniqueEdges, std::vector<Face>& faces, const MinkVals& newCorner)
+//the support functions can hand back a corner we already have, and it needs to be the same corner, so that edges match up
+int CollisionDetection::EPAPolytope::AddVert(const MinkVals& v)
 {
-	for (int i = 0; i < uniqueEdges.size(); i++)
-	{
-		Face f;
-		f.a = uniqueEdges[i].first;
-		f.b = uniqueEdges[i].second;
-		f.c = newCorner;
-		f.BuildNorm();
-		//all normals must by definition face away from the normal: now I don't have to worry my pretty little head about winding :)
-		if (Vector3::Dot(f.a.mkw, f.normal) < 0)
+	for (int i = 0; i < vertCount; i++)
+	{
+		if (verts[i].mkw == v.mkw)
+		{
+			return i;
+		}
+	}
+	verts[vertCount] = v;
+	return vertCount++;
+}
+
+//callers make sure there's a slot free first
+void CollisionDetection::EPAPolytope::AddFace(int a, int b, int c)
+{
+	int slot;
+	if (freeCount > 0)
+	{
+		slot = freeSlots[--freeCount];
+	}
+	else
+	{
+		slot = slotsUsed++;
+		faces[slot].generation = 0;
+	}
+	PolyFace& f = faces[slot];
+	f.v[0] = a;
+	f.v[1] = b;
+	f.v[2] = c;
+	Vector3 normal = Vector3::Cross(verts[b].mkw - verts[a].mkw, verts[c].mkw - verts[a].mkw);
+	if (normal.LengthSquared() < 1e-12f)
+	{
+		//a new corner in line with a horizon edge makes a face with no area, and no normal. It still
+		//closes off the polytope, but it can't be seen past and must never be picked as the closest face
+		f.normal	= Vector3(0, 0, 0);
+		f.distance	= FLT_MAX;
+	}
+	else
+	{
+		f.normal = normal.Normalised();
+		//all normals must point out of the polytope: now I don't have to worry my pretty little head about winding :)
+		if (Vector3::Dot(verts[a].mkw - interior, f.normal) < 0)
+		{
 			f.normal *= -1;
+		}
+		f.distance = std::abs(Vector3::Dot(verts[a].mkw, f.normal));
+	}
+	f.aliveIndex	= aliveCount;
+	f.order			= facesMade++;
+	alive[aliveCount++] = slot;
 
-		faces.push_back(f);
+	if (heapCount == MAX_HEAP)
+	{
+		RebuildHeap(); //throws away all the entries for faces that no longer exist
 	}
+	PushHeap({ f.distance, f.order, slot, f.generation });
 }
 
-void CollisionDetection::FindUniqueEdges(std::vector<Face>& faces, std::vector<std::pair<MinkVals, MinkVals>>& uniqueEdges, const MinkVals& newCorner)
+void CollisionDetection::EPAPolytope::RemoveFace(int slot)
 {
-	uniqueEdges.clear();
+	PolyFace& f = faces[slot];
+	int last = alive[--aliveCount];
+	alive[f.aliveIndex]			= last;
+	faces[last].aliveIndex		= f.aliveIndex;
+	f.aliveIndex = -1;
+	f.generation++;
+	freeSlots[freeCount++] = slot;
+}
 
-	//note the non-standard for-loop: it's because we're erasing values as we go, and C++ gets very angry if you try to then iterate on an erased value
-	for (auto i = faces.begin(); i != faces.end();)
+//-1 if the polytope somehow has no faces left at all
+int CollisionDetection::EPAPolytope::ClosestFace()
+{
+	if (aliveCount == 0)
 	{
-		if (Vector3::Dot(i->normal, newCorner.mkw) > 0)
+		return -1;
+	}
+	while (heapCount > 0)
+	{
+		const HeapEntry& top = heap[0];
+		if (faces[top.face].aliveIndex >= 0 && faces[top.face].generation == top.generation)
 		{
-			std::pair<Vector3, Vector3> edges[3];
-			edges[0] = std::make_pair(i->a.mkw, i->b.mkw);
-			edges[1] = std::make_pair(i->a.mkw, i->c.mkw);
-			edges[2] = std::make_pair(i->b.mkw, i->c.mkw);
-
-			bool found[3] = { false };
-			DeleteSharedEdges(uniqueEdges, edges, found);
-			
-			if (!found[0])
-				uniqueEdges.push_back(std::make_pair(i->a, i->b));
-			if (!found[1])
-				uniqueEdges.push_back(std::make_pair(i->a, i->c));
-			if (!found[2])
-				uniqueEdges.push_back(std::make_pair(i->b, i->c));
-			i = faces.erase(i);
-			continue;
+			return top.face;
+		}
+		PopHeap();
+	}
+	return alive[0]; //can't happen, there's always a live entry for every live face
+}
+
+/*
+Each edge of a removed face is added to the horizon, unless it's already there
+(going either way round) - in which case it's shared with another removed face,
+so it can't be on the horizon at all, and is removed instead.
+*/
+bool CollisionDetection::EPAPolytope::AddHorizonEdge(int a, int b)
+{
+	for (int i = 0; i < edgeCount; i++)
+	{
+		if ((edges[i][0] == a && edges[i][1] == b) || (edges[i][0] == b && edges[i][1] == a))
+		{
+			--edgeCount;
+			edges[i][0] = edges[edgeCount][0];
+			edges[i][1] = edges[edgeCount][1];
+			return true;
 		}
-		i++;
 	}
+	if (edgeCount == MAX_EDGES)
+	{
+		return false;
+	}
+	edges[edgeCount][0] = a;
+	edges[edgeCount][1] = b;
+	edgeCount++;
+	return true;
 }
 
-void CollisionDetection::DeleteSharedEdges(std::vector<std::pair<MinkVals, MinkVals>>& uniqueEdges, std::pair<Vector3, Vector3>* edges, bool* foundEdges)
+/*
+Knocks out every face the new corner can see - that is, every face it's in
+front of - and fills the hole with faces fanning out from the new corner.
+The horizon is worked out, and checked to fit, before anything is removed,
+so if the polytope can't take the new corner, it's left just as it was.
+*/
+bool CollisionDetection::EPAPolytope::Expand(int newVert)
 {
-	//note the non-standard for-loop: it's because we're erasing values as we go, and C++ gets very angry if you try to then iterate on an erased value
-	for (auto j = uniqueEdges.begin(); j != uniqueEdges.end();)
+	const Vector3& corner = verts[newVert].mkw;
+	int visibleCount = 0;
+	edgeCount = 0;
+	for (int i = 0; i < aliveCount; i++)
 	{
-		bool matched = false;
-		for (int k = 0; k < 3; k++)
+		const PolyFace& f = faces[alive[i]];
+		if (Vector3::Dot(f.normal, corner - verts[f.v[0]].mkw) > 0)
 		{
-			if ((j->first.mkw == edges[k].first && j->second.mkw == edges[k].second)
-				|| (j->first.mkw == edges[k].second && j->second.mkw == edges[k].first))
+			if (!AddHorizonEdge(f.v[0], f.v[1]) || !AddHorizonEdge(f.v[1], f.v[2]) || !AddHorizonEdge(f.v[2], f.v[0]))
 			{
-				j = uniqueEdges.erase(j);
-				foundEdges[k] = true;
-				matched = true;
-				break;
-			}			
+				return false;
+			}
+			visible[visibleCount++] = alive[i];
 		}
-		if (!matched) j++;
 	}
+	if (visibleCount == 0 || freeCount + (MAX_FACES - slotsUsed) + visibleCount < edgeCount)
+	{
+		return false;
+	}
+	for (int i = 0; i < visibleCount; i++)
+	{
+		RemoveFace(visible[i]);
+	}
+	for (int i = 0; i < edgeCount; i++)
+	{
+		AddFace(edges[i][0], edges[i][1], newVert);
+	}
+	return true;
+}
+
+CollisionDetection::Face CollisionDetection::EPAPolytope::GetFace(int slot) const
+{
+	Face face;
+	face.a		= verts[faces[slot].v[0]];
+	face.b		= verts[faces[slot].v[1]];
+	face.c		= verts[faces[slot].v[2]];
+	face.normal = faces[slot].normal;
+	return face;
 }
 
-std::pair<int,float> CollisionDetection::FindClosestFace(std::vector<Face>& faces)
+void CollisionDetection::EPAPolytope::PushHeap(const HeapEntry& e)
 {
-	int closestFaceIndex = 0;
-	float minDist = FLT_MAX;
-	for (int i = 0; i < faces.size(); i++)
+	int i = heapCount++;
+	while (i > 0)
 	{
-		float dist = abs(Vector3::Dot(faces[i].a.mkw, faces[i].normal));
-		if (dist < minDist)
+		int parent = (i - 1) / 2;
+		if (!(e < heap[parent]))
 		{
-			minDist = dist;
-			closestFaceIndex = i;
+			break;
 		}
+		heap[i] = heap[parent];
+		i = parent;
 	}
-	std::pair<int, float> faceInfo;
-	faceInfo.first = closestFaceIndex;
-	faceInfo.second = minDist;
-	return faceInfo;
+	heap[i] = e;
 }
 
-void CollisionDetection::LogGJKEPACollisionInfo(std::vector<Face>& faces, std::pair<int, float> closestFaceInfo, CollisionInfo& collisionInfo, Vector3 aPos, Vector3 bPos)
+void CollisionDetection::EPAPolytope::PopHeap()
+{
+	HeapEntry e = heap[--heapCount];
+	int i = 0;
+	while (true)
+	{
+		int child = (i * 2) + 1;
+		if (child >= heapCount)
+		{
+			break;
+		}
+		if (child + 1 < heapCount && heap[child + 1] < heap[child])
+		{
+			child++;
+		}
+		if (!(heap[child] < e))
+		{
+			break;
+		}
+		heap[i] = heap[child];
+		i = child;
+	}
+	if (heapCount > 0)
+	{
+		heap[i] = e;
+	}
+}
+
+void CollisionDetection::EPAPolytope::RebuildHeap()
+{
+	heapCount = 0;
+	for (int i = 0; i < aliveCount; i++)
+	{
+		const PolyFace& f = faces[alive[i]];
+		PushHeap({ f.distance, f.order, alive[i], f.generation });
+	}
+}
+
+void CollisionDetection::LogGJKEPACollisionInfo(const Face& face, float faceDistance, CollisionInfo& collisionInfo, Vector3 aPos, Vector3 bPos)
 {
 	Plane triPlane;
-	triPlane.PlaneFromTri(faces[closestFaceInfo.first].a.mkw, faces[closestFaceInfo.first].b.mkw, faces[closestFaceInfo.first].c.mkw);
+	triPlane.PlaneFromTri(face.a.mkw, face.b.mkw, face.c.mkw);
 	Vector3 projectedOrigin = triPlane.ProjectPointOntoPlane(Vector3(0, 0, 0));
-	float areaA = Maths::AreaofTri3D(projectedOrigin, faces[closestFaceInfo.first].b.mkw, faces[closestFaceInfo.first].c.mkw);
-	float areaB = Maths::AreaofTri3D(projectedOrigin, faces[closestFaceInfo.first].c.mkw, faces[closestFaceInfo.first].a.mkw);
-	float areaC = Maths::AreaofTri3D(projectedOrigin, faces[closestFaceInfo.first].a.mkw, faces[closestFaceInfo.first].b.mkw);
-	float totalArea = Maths::AreaofTri3D(faces[closestFaceInfo.first].a.mkw, faces[closestFaceInfo.first].b.mkw, faces[closestFaceInfo.first].c.mkw);
+	float areaA = Maths::AreaofTri3D(projectedOrigin, face.b.mkw, face.c.mkw);
+	float areaB = Maths::AreaofTri3D(projectedOrigin, face.c.mkw, face.a.mkw);
+	float areaC = Maths::AreaofTri3D(projectedOrigin, face.a.mkw, face.b.mkw);
+	float totalArea = Maths::AreaofTri3D(face.a.mkw, face.b.mkw, face.c.mkw);
 	Vector3 barycentric({ 0,0,0 });
 	barycentric.x = areaA / totalArea;
 	barycentric.y = areaB / totalArea;
 	barycentric.z = areaC / totalArea;
-	Vector3 localA = { faces[closestFaceInfo.first].a.aPos * barycentric.x
-		+ faces[closestFaceInfo.first].b.aPos * barycentric.y
-		+ faces[closestFaceInfo.first].c.aPos * barycentric.z };
-	Vector3 localB = faces[closestFaceInfo.first].a.bPos * barycentric.x
-		+ faces[closestFaceInfo.first].b.bPos * barycentric.y
-		+ faces[closestFaceInfo.first].c.bPos * barycentric.z;
+	Vector3 localA = { face.a.aPos * barycentric.x
+		+ face.b.aPos * barycentric.y
+		+ face.c.aPos * barycentric.z };
+	Vector3 localB = face.a.bPos * barycentric.x
+		+ face.b.bPos * barycentric.y
+		+ face.c.bPos * barycentric.z;
 
 	localA -= aPos;
 	localB -= bPos;	
 	
-	collisionInfo.AddContactPoint(localA, localB, -faces[closestFaceInfo.first].normal, closestFaceInfo.second);
+	collisionInfo.AddContactPoint(localA, localB, -face.normal, faceDistance);
+}
+
+
+/*
+Finds the corners of an object that are furthest along dir - the face,
+edge or corner that's touching whatever is that way. Volumes only give
+out one support point at a time, so it asks for the support point in
+directions tilted a little way off dir, all the way round it. Each tilt
+finds whichever corner of the face is furthest that way, so going round
+finds the face's corners in order (anticlockwise, looking back along
+dir). The tilts are worked out in the object's own space, so the same
+corner keeps coming from the same tilt while the object turns, and the
+tilt's index can be used to tell which corner it is.
+
+The face is never quite square on to dir, so its far corners drop back a
+little from the furthest one - by more the further away they are. On a
+face as big as the tray's floor, even a tiny tilt drops the far corners
+back by a lot, so how far back a corner can be grows with its distance
+from the furthest point, by as much as a face tilted as far as the
+support directions are would drop.
+*/
+int CollisionDetection::SupportFeature(GameObject* object, const Vector3& dir, Vector3* points, int* ids)
+{
+	const float tilt		= 0.1f;		//about 6 degrees - much less than the angle between any 2 faces of a die
+	const float tolerance	= 0.02f;	//how far behind the furthest point a corner can be, and still count as part of the feature
+
+	const CollisionVolume*	volume		= object->GetBoundingVolume();
+	const Transform&		transform	= object->GetTransform();
+	Quaternion				orientation = transform.GetOrientation();
+
+	Vector3 normal		= dir.Normalised();
+	Vector3 localNormal = orientation.Conjugate() * normal;
+	Vector3 axis		= std::abs(localNormal.x) < std::abs(localNormal.y) ?
+		(std::abs(localNormal.x) < std::abs(localNormal.z) ? Vector3(1, 0, 0) : Vector3(0, 0, 1)) :
+		(std::abs(localNormal.y) < std::abs(localNormal.z) ? Vector3(0, 1, 0) : Vector3(0, 0, 1));
+	Vector3 u = orientation * Vector3::Cross(localNormal, axis).Normalised();
+	Vector3 v = Vector3::Cross(normal, u);
+
+	Vector3 furthestPoint	= volume->Support(normal, transform);
+	float	furthest		= Vector3::Dot(normal, furthestPoint);
+
+	int count = 0;
+	for (int i = 0; i < MAX_FEATURE_POINTS; ++i)
+	{
+		float	angle	= i * (2.0f * PI / MAX_FEATURE_POINTS);
+		Vector3 point	= volume->Support(normal + (u * cos(angle) + v * sin(angle)) * tilt, transform);
+		if (Vector3::Dot(normal, point) < furthest - tolerance - (point - furthestPoint).Length() * tilt)
+		{
+			continue;
+		}
+		bool found = false;
+		for (int j = 0; j < count && !found; ++j)
+		{
+			found = (points[j] - point).LengthSquared() < 1e-8f;
+		}
+		if (!found)
+		{
+			points[count]	= point;
+			ids[count]		= i;
+			count++;
+		}
+	}
+	return count;
+}
+
+//Sutherland-Hodgman - keeps the part of the polygon behind the plane, naming any new corners after the plane and the edge it cut
+int CollisionDetection::ClipPolygon(const Vector3* in, const int* inIDs, int inCount, const Vector3& planeNormal, float planeOffset, int planeID, Vector3* out, int* outIDs)
+{
+	int outCount = 0;
+	for (int i = 0; i < inCount; ++i)
+	{
+		int		next	= (i + 1) % inCount;
+		float	distA	= Vector3::Dot(planeNormal, in[i]) - planeOffset;
+		float	distB	= Vector3::Dot(planeNormal, in[next]) - planeOffset;
+		if (distA <= 0.0f)
+		{
+			out[outCount]		= in[i];
+			outIDs[outCount]	= inIDs[i];
+			outCount++;
+		}
+		if ((distA < 0.0f && distB > 0.0f) || (distA > 0.0f && distB < 0.0f))
+		{
+			out[outCount]		= in[i] + (in[next] - in[i]) * (distA / (distA - distB));
+			outIDs[outCount]	= ((planeID + 1) << 16) | ((inIDs[i] & 0xFF) << 8) | (inIDs[next] & 0xFF);
+			outCount++;
+		}
+	}
+	return outCount;
 }
 
+/*
+EPA only finds the one point where the objects overlap the most. To get the
+rest, the features of each object facing the other are found, and the one
+lined up best with the collision normal becomes the reference face. The
+other (the incident feature) is clipped to the sides of the reference face,
+and whatever is left of it that's behind the reference face is touching.
+If neither object has a face pointing the right way (such as 2 edges
+crossing), EPA's point is as good as it gets, and is left as it is.
+*/
+void CollisionDetection::BuildContactManifold(GameObject* a, GameObject* b, CollisionInfo& collisionInfo)
+{
+	const int	MAX_CLIP_POINTS = MAX_FEATURE_POINTS * 2;
+	const float contactMargin	= 0.01f;	//points just short of touching are kept too, so a corner about to land is already held up
+
+	Vector3 normal = collisionInfo.points[0].normal;
+
+	Vector3 featureA[MAX_FEATURE_POINTS];
+	Vector3 featureB[MAX_FEATURE_POINTS];
+	int		idsA[MAX_FEATURE_POINTS];
+	int		idsB[MAX_FEATURE_POINTS];
+	int		countA = SupportFeature(a, normal, featureA, idsA);
+	int		countB = SupportFeature(b, -normal, featureB, idsB);
+
+	float alignA = countA >= 3 ? std::abs(Vector3::Dot(FeatureNormal(featureA, countA), normal)) : -1.0f;
+	float alignB = countB >= 3 ? std::abs(Vector3::Dot(FeatureNormal(featureB, countB), normal)) : -1.0f;
+	if (alignA < 0.0f && alignB < 0.0f)
+	{
+		return;
+	}
+	//a small bias towards A stops the reference face flicking between two faces that are equally good
+	bool	referenceIsA	= alignA >= alignB - 0.001f;
+	Vector3 referenceNormal = referenceIsA ? normal : -normal;
+	const Vector3*	reference		= referenceIsA ? featureA	: featureB;
+	int				referenceCount	= referenceIsA ? countA		: countB;
+
+	Vector3 clipped[2][MAX_CLIP_POINTS];
+	int		clippedIDs[2][MAX_CLIP_POINTS];
+	int		clippedCount = referenceIsA ? countB : countA;
+	for (int i = 0; i < clippedCount; ++i)
+	{
+		clipped[0][i]		= referenceIsA ? featureB[i] : featureA[i];
+		clippedIDs[0][i]	= referenceIsA ? idsB[i] : idsA[i];
+	}
+
+	//the reference face's corners go anticlockwise round its normal, so each edge's side plane faces outwards
+	int current = 0;
+	for (int i = 0; i < referenceCount && clippedCount > 0; ++i)
+	{
+		const Vector3& start	= reference[i];
+		const Vector3& end		= reference[(i + 1) % referenceCount];
+		Vector3 sideNormal		= Vector3::Cross(end - start, referenceNormal);
+		clippedCount	= ClipPolygon(clipped[current], clippedIDs[current], clippedCount, sideNormal, Vector3::Dot(sideNormal, start), i, clipped[1 - current], clippedIDs[1 - current]);
+		current			= 1 - current;
+	}
+
+	//the reference face is rarely quite square on to the normal, so depths are measured along the normal to the face's own plane - a flat plane through one corner misses however far the others stick out past it
+	Vector3 faceNormal		= FeatureNormal(reference, referenceCount);
+	float	faceOffset		= Vector3::Dot(faceNormal, reference[0]);
+	float	faceAlignment	= Vector3::Dot(faceNormal, referenceNormal);
+	Vector3 touching[MAX_CLIP_POINTS];
+	float	depths[MAX_CLIP_POINTS];
+	int		touchingIDs[MAX_CLIP_POINTS];
+	int		touchingCount = 0;
+	for (int i = 0; i < clippedCount; ++i)
+	{
+		float depth = (faceOffset - Vector3::Dot(faceNormal, clipped[current][i])) / faceAlignment;
+		if (depth >= -contactMargin)
+		{
+			touching[touchingCount]		= clipped[current][i];
+			depths[touchingCount]		= depth;
+			touchingIDs[touchingCount]	= clippedIDs[current][i] | (referenceIsA ? 0 : (1 << 24));
+			touchingCount++;
+		}
+	}
+	if (touchingCount == 0)
+	{
+		return;
+	}
+
+	//too many points - keep the deepest, then whichever spread the contact out the most
+	int keep[CollisionInfo::MAX_CONTACTS];
+	int keepCount = 0;
+	if (touchingCount <= CollisionInfo::MAX_CONTACTS)
+	{
+		for (int i = 0; i < touchingCount; ++i)
+		{
+			keep[keepCount++] = i;
+		}
+	}
+	else
+	{
+		keep[0] = 0;
+		for (int i = 1; i < touchingCount; ++i)
+		{
+			if (depths[i] > depths[keep[0]]) keep[0] = i;
+		}
+		keepCount = 1;
+		while (keepCount < CollisionInfo::MAX_CONTACTS)
+		{
+			int		best		= -1;
+			float	bestSpread	= -1.0f;
+			for (int i = 0; i < touchingCount; ++i)
+			{
+				float spread = 0.0f;
+				bool kept = false;
+				for (int k = 0; k < keepCount; ++k)
+				{
+					kept	|= (keep[k] == i);
+					spread	+= (touching[i] - touching[keep[k]]).Length();
+				}
+				if (!kept && spread > bestSpread)
+				{
+					bestSpread	= spread;
+					best		= i;
+				}
+			}
+			keep[keepCount++] = best;
+		}
+	}
+
+	Vector3 aPos = a->GetTransform().GetPosition();
+	Vector3 bPos = b->GetTransform().GetPosition();
+	collisionInfo.ClearContactPoints();
+	for (int k = 0; k < keepCount; ++k)
+	{
+		int		i			= keep[k];
+		Vector3 incident	= touching[i];
+		Vector3 onReference = incident + referenceNormal * depths[i];
+		Vector3 pointA		= referenceIsA ? onReference : incident;
+		Vector3 pointB		= referenceIsA ? incident : onReference;
+		collisionInfo.AddContactPoint(pointA - aPos, pointB - bPos, normal, depths[i], touchingIDs[i]);
+	}
+}
 
 bool CollisionDetection::AABBCapsuleIntersection(
 	const CapsuleVolume& volumeA, const Transform& worldTransformA,
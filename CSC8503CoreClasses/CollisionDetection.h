@@ -11,6 +11,7 @@
 #include "CapsuleVolume.h"
 #include "Ray.h"
 #include <unordered_set>
+#include <bit>
 
 using NCL::Camera;
 using namespace NCL::Maths;
@@ -24,23 +25,60 @@ namespace NCL {
 			Vector3 localB;
 			Vector3 normal;
 			float	penetration;
+			int		featureID;		//which parts of the two shapes made this point, so it can be found again next substep
+			float	normalImpulse;	//the impulse applied along the normal here, carried over while the point persists
+			Vector3	tangentImpulse;	//and the friction impulse, in world space
 		};
+
+		/*
+		A pair of objects can touch at up to MAX_CONTACTS points at once - a die
+		lying flat on the tray touches it at every corner of the face it's on.
+		Resolving all of them together stops the die rocking from corner to
+		corner, which it does if it only ever gets pushed at one point.
+		*/
 		struct CollisionInfo {
+			static const int MAX_CONTACTS = 4;
+
 			GameObject* a;
 			GameObject* b;		
 			int		framesLeft;
 
-			ContactPoint point;
+			ContactPoint	points[MAX_CONTACTS];
+			int				pointCount;
 
 			CollisionInfo() {
-
+				pointCount = 0;
 			}
 
-			void AddContactPoint(const Vector3& localA, const Vector3& localB, const Vector3& normal, float p) {
+			void AddContactPoint(const Vector3& localA, const Vector3& localB, const Vector3& normal, float p, int featureID = 0) {
+				if (pointCount == MAX_CONTACTS) {
+					return;
+				}
+				ContactPoint& point = points[pointCount++];
 				point.localA		= localA;
 				point.localB		= localB;
 				point.normal		= normal;
 				point.penetration	= p;
+				point.featureID		= featureID;
+				point.normalImpulse	= 0.0f;
+				point.tangentImpulse	= Vector3();
+			}
+
+			void ClearContactPoints() {
+				pointCount = 0;
+			}
+
+			//points made by the same features as one of last substep's points pick up where that point left off
+			void MatchContactPoints(const CollisionInfo& previous) {
+				for (int i = 0; i < pointCount; ++i) {
+					for (int j = 0; j < previous.pointCount; ++j) {
+						if (points[i].featureID == previous.points[j].featureID) {
+							points[i].normalImpulse		= previous.points[j].normalImpulse;
+							points[i].tangentImpulse	= previous.points[j].tangentImpulse;
+							break;
+						}
+					}
+				}
 			}
 
 			//Advanced collision detection / resolution
@@ -69,6 +107,29 @@ namespace NCL {
 			Vector3 mkw;
 		};
 
+		/*
+		What GJK learned about a pair of objects last time it tested them. If
+		they were apart, the axis that proved it is kept, and as objects don't
+		move far in a substep, that same axis usually still separates them -
+		which takes a single support point to check. If they overlapped, the
+		directions that built the enclosing tetrahedron are kept instead, so
+		the next test can rebuild it straight away and go on to EPA.
+		Either is only ever a starting point - nothing is assumed until the
+		support functions have confirmed it.
+		*/
+		struct GJKCache
+		{
+			Vector3 separatingAxis;
+			Vector3 simplexDirs[4];
+			bool	hasSeparatingAxis;
+			bool	hasSimplex;
+
+			GJKCache() {
+				hasSeparatingAxis	= false;
+				hasSimplex			= false;
+			}
+		};
+
 		static bool AABBCapsuleIntersection(
 			const CapsuleVolume& volumeA, const Transform& worldTransformA,
 			const AABBVolume& volumeB, const Transform& worldTransformB, CollisionInfo& collisionInfo);
@@ -96,7 +157,7 @@ namespace NCL {
 		static bool	AABBTest(const Vector3& posA, const Vector3& posB, const Vector3& halfSizeA, const Vector3& halfSizeB);
 
 
-		static bool ObjectIntersection(GameObject* a, GameObject* b, CollisionInfo& collisionInfo);
+		static bool ObjectIntersection(GameObject* a, GameObject* b, CollisionInfo& collisionInfo, GJKCache* cache = nullptr);
 
 
 		static bool AABBIntersection(	const AABBVolume& volumeA, const Transform& worldTransformA,
@@ -115,7 +176,20 @@ namespace NCL {
 		static bool OBBSphereIntersection(const OBBVolume& volumeA, const Transform& worldTransformA,
 			const SphereVolume& volumeB, const Transform& worldTransformB, CollisionInfo& collisionInfo);
 
-		static bool GJK(GameObject* a, GameObject* b, CollisionInfo& collisionInfo);
+		static bool GJK(GameObject* a, GameObject* b, CollisionInfo& collisionInfo, GJKCache* cache = nullptr);
+
+		/*
+		How many GJK and EPA iterations have been run, so the profiler can
+		see how hard the narrowphase is working. Each thread keeps its own
+		counts, which are reset once they've been taken.
+		*/
+		struct IterationCounts
+		{
+			uint32_t gjk = 0;
+			uint32_t epa = 0;
+		};
+
+		static IterationCounts TakeIterationCounts();
 		
 
 		static Vector3 Unproject(const Vector3& screenPos, const PerspectiveCamera& cam);
@@ -149,20 +223,117 @@ namespace NCL {
 				normal = Vector3::Cross(b.mkw - a.mkw, c.mkw - a.mkw).Normalised();
 			}
 		};
-		
+
+		/*
+		Everything EPA needs, in fixed size arrays, so that it can live on the
+		stack rather than allocating for every colliding pair. Faces refer to
+		their corners by index, and are kept in slots that get handed back out
+		when faces are removed. A min-heap of face distances finds the closest
+		face - entries for faces that have since been removed are just skipped
+		over when they reach the top, which is cheaper than digging them out.
+
+		The arrays are only as big as a polytope of MAX_VERTS corners can ever
+		need, and slots are only touched once they're handed out, so a short
+		EPA run never has to clear the whole thing.
+		*/
+		struct EPAPolytope
+		{
+			static const int MAX_VERTS	= GJK_MAX + 64;		//the GJK simplex, plus 1 new corner per EPA iteration
+			static const int MAX_FACES	= 2 * MAX_VERTS - 4;	//the most faces a closed polytope with that many corners can have
+			static const int MAX_EDGES	= 3 * MAX_VERTS - 6;	//and the most edges
+			static const int MAX_HEAP	= 2 * MAX_FACES;
+
+			struct PolyFace {
+				int		v[3];
+				Vector3 normal;
+				float	distance;
+				int		generation;	//bumped whenever the slot is reused, so stale heap entries can be spotted
+				int		aliveIndex;	//where this face is in the alive list, or -1 if the slot is free
+				int		order;
+			};
+
+			struct HeapEntry {
+				float	distance;
+				int		order;		//faces are made in increasing order, so equally close faces go oldest first
+				int		face;
+				int		generation;
+
+				bool operator<(const HeapEntry& other) const {
+					return distance < other.distance || (distance == other.distance && order < other.order);
+				}
+			};
+
+			MinkVals	verts[MAX_VERTS];
+			PolyFace	faces[MAX_FACES];
+			int			alive[MAX_FACES];
+			int			freeSlots[MAX_FACES];
+			int			visible[MAX_FACES];
+			HeapEntry	heap[MAX_HEAP];
+			int			edges[MAX_EDGES][2];
+			Vector3		interior;	//a point inside the polytope, which every face normal points away from
+
+			int vertCount;
+			int aliveCount;
+			int freeCount;
+			int slotsUsed;	//slots past this have never been handed out
+			int heapCount;
+			int edgeCount;
+			int facesMade;
+
+			void Init(MinkVals* corners);
+			int  AddVert(const MinkVals& v);
+			void AddFace(int a, int b, int c);
+			void RemoveFace(int slot);
+			int  ClosestFace();
+			bool AddHorizonEdge(int a, int b);
+			bool Expand(int newVert);
+			Face GetFace(int slot) const;
+
+			void PushHeap(const HeapEntry& e);
+			void PopHeap();
+			void RebuildHeap();
+		};
 
 		CollisionDetection()	{}
 		~CollisionDetection()	{}
+
+		/*
+		ObjectIntersection finds the test for a pair of volumes in a table,
+		indexed by which bit of VolumeType each volume is, so that dispatching
+		is a single call however many volume types there are. Tests written for
+		one order of volumes get an entry for the other order too, which swaps
+		the objects round before calling them. Pairs that can't collide get
+		NoIntersection rather than an empty entry, so there's nothing to check.
+		*/
+		typedef bool (*IntersectionFunc)(GameObject* a, GameObject* b, CollisionInfo& collisionInfo, GJKCache* cache);
+		static const int VOLUME_TYPE_COUNT = 12; //one for each bit of VolumeType, up to and including Invalid
+
+		static int VolumeIndex(VolumeType type) {
+			return std::countr_zero((unsigned int)type);
+		}
+
+		static bool BuildIntersectionTable();
+		template<IntersectionFunc F> static void SetIntersection(VolumeType a, VolumeType b);
+		template<IntersectionFunc F> static void SetSymmetricIntersection(VolumeType a, VolumeType b);
+		template<IntersectionFunc F> static bool SwappedIntersection(GameObject* a, GameObject* b, CollisionInfo& collisionInfo, GJKCache* cache);
+		static bool NoIntersection(GameObject* a, GameObject* b, CollisionInfo& collisionInfo, GJKCache* cache);
+
+		static IntersectionFunc	intersectionTable[VOLUME_TYPE_COUNT][VOLUME_TYPE_COUNT];
+		static thread_local IterationCounts iterationCounts;
+		static bool				intersectionTableBuilt;
+
 		static bool GJKTriangleCase(MinkVals* corners, Vector3& searchIn);
 		static bool GJKTetraCase(MinkVals* corners, Vector3& searchIn);
+		static bool GJKWarmStart(GameObject* a, GameObject* b, MinkVals* corners, GJKCache& cache);
+		static bool TetraEnclosesOrigin(const MinkVals* corners, Vector3* cornerDirs);
 		static void BuildMinkVals(Vector3 searchIn, GameObject* a, GameObject* b, MinkVals* mv, GJK_Points gjk_ind = GJK_A);
-		static void EPA(GameObject* a, GameObject* b, MinkVals* corners, CollisionInfo& collisionInfo);
-		static void LogGJKEPACollisionInfo(std::vector<Face>& faces, std::pair<int, float> closestFaceInfo, CollisionInfo& collisionInfo, Vector3 aPos, Vector3 bPos);
-		static std::pair<int, float> FindClosestFace(std::vector<Face>& faces);
-		static void FindUniqueEdges(std::vector<Face>& faces, std::vector<std::pair<MinkVals, MinkVals>>& uniqueEdges, const MinkVals& newCorner);
-		static void DeleteSharedEdges(std::vector<std::pair<MinkVals, MinkVals>>& uniqueEdges, std::pair<Vector3, Vector3>* edges, bool* foundEdges);
-		static std::vector<Face> ConvertSimplexToFaces(MinkVals* corners);
-		static void ConvertEdgesToFaces(const std::vector<std::pair<MinkVals, MinkVals>>& uniqueEdges, std::vector<Face>& faces, const MinkVals& newCorner);
+		static bool EPA(GameObject* a, GameObject* b, MinkVals* corners, CollisionInfo& collisionInfo);
+		static void LogGJKEPACollisionInfo(const Face& face, float faceDistance, CollisionInfo& collisionInfo, Vector3 aPos, Vector3 bPos);
+
+		static const int MAX_FEATURE_POINTS = 8;
+		static int	SupportFeature(GameObject* object, const Vector3& dir, Vector3* points, int* ids);
+		static int	ClipPolygon(const Vector3* in, const int* inIDs, int inCount, const Vector3& planeNormal, float planeOffset, int planeID, Vector3* out, int* outIDs);
+		static void BuildContactManifold(GameObject* a, GameObject* b, CollisionInfo& collisionInfo);
 	};
 }
 
@@ -0,0 +1,151 @@
+#include "CollisionPairCache.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+CollisionPairCache::CollisionPairCache(int initialCapacity) {
+	int slotCount = 16;
+	while (slotCount < initialCapacity * 2) {
+		slotCount *= 2;
+	}
+	slots.assign(slotCount, -1);
+	slotMask = slotCount - 1;
+	pairs.reserve(initialCapacity);
+	pairKeys.reserve(initialCapacity);
+	gjkCaches.reserve(initialCapacity);
+	stamps.reserve(initialCapacity);
+}
+
+//the pair is unordered - (a,b) and (b,a) are the same collision
+uint64_t CollisionPairCache::PairKey(const GameObject* a, const GameObject* b) {
+	uint32_t idA = (uint32_t)a->GetWorldID();
+	uint32_t idB = (uint32_t)b->GetWorldID();
+	if (idA > idB) {
+		std::swap(idA, idB);
+	}
+	return ((uint64_t)idA << 32) | idB;
+}
+
+//world IDs are small and sequential, so they need a good stir before they're any use as a hash
+uint64_t CollisionPairCache::HashKey(uint64_t key) {
+	key ^= key >> 33;
+	key *= 0xFF51AFD7ED558CCDull;
+	key ^= key >> 33;
+	key *= 0xC4CEB9FE1A85EC53ull;
+	key ^= key >> 33;
+	return key;
+}
+
+//returns the slot holding this key, or the empty slot it would go in
+int CollisionPairCache::FindSlot(uint64_t key) const {
+	uint64_t slot = HashKey(key) & slotMask;
+	while (slots[slot] != -1 && pairKeys[slots[slot]] != key) {
+		slot = (slot + 1) & slotMask;
+	}
+	return (int)slot;
+}
+
+bool CollisionPairCache::Insert(const CollisionInfo& info) {
+	uint64_t key = PairKey(info.a, info.b);
+	int slot = FindSlot(key);
+	if (slots[slot] != -1) {
+		return false;
+	}
+	//keep the table at most half full, so probe runs stay short
+	if ((pairs.size() + 1) * 2 > slots.size()) {
+		Grow();
+		slot = FindSlot(key);
+	}
+	slots[slot] = (int)pairs.size();
+	pairs.push_back(info);
+	pairKeys.push_back(key);
+	gjkCaches.emplace_back();
+	stamps.push_back(0);
+	return true;
+}
+
+void CollisionPairCache::Touch(const CollisionInfo& info, int stamp) {
+	int slot = FindSlot(PairKey(info.a, info.b));
+	int index = slots[slot];
+	if (index == -1) {
+		Insert(info);
+		index = (int)pairs.size() - 1;
+	}
+	else {
+		pairs[index].a = info.a;
+		pairs[index].b = info.b;
+	}
+	stamps[index] = stamp;
+}
+
+//going backwards means the pair swapped into a removed pair's place has already been checked
+void CollisionPairCache::RemoveUntouched(int stamp) {
+	for (int i = (int)pairs.size() - 1; i >= 0; --i) {
+		if (stamps[i] != stamp) {
+			RemoveAt(i);
+		}
+	}
+}
+
+CollisionDetection::CollisionInfo* CollisionPairCache::Find(const GameObject* a, const GameObject* b) {
+	int slot = FindSlot(PairKey(a, b));
+	if (slots[slot] == -1) {
+		return nullptr;
+	}
+	return &pairs[slots[slot]];
+}
+
+/*
+Linear probing can't just blank out a removed slot, as that would cut short
+the probe run of anything that was pushed past it. Instead, the rest of the
+run is shuffled back to fill the hole (so there are no tombstones to clean
+up later), and then the last pair in the array is swapped down into the
+removed pair's place.
+*/
+void CollisionPairCache::RemoveAt(int index) {
+	uint64_t hole = FindSlot(pairKeys[index]);
+	uint64_t next = (hole + 1) & slotMask;
+	while (slots[next] != -1) {
+		uint64_t home = HashKey(pairKeys[slots[next]]) & slotMask;
+		//can the entry in 'next' legally live in the hole? Only if its home slot isn't cyclically between the two
+		bool movable = (hole <= next) ? (home <= hole || home > next) : (home <= hole && home > next);
+		if (movable) {
+			slots[hole] = slots[next];
+			hole = next;
+		}
+		next = (next + 1) & slotMask;
+	}
+	slots[hole] = -1;
+
+	int lastIndex = (int)pairs.size() - 1;
+	if (index != lastIndex) {
+		slots[FindSlot(pairKeys[lastIndex])] = index;
+		pairs[index]	= pairs[lastIndex];
+		pairKeys[index] = pairKeys[lastIndex];
+		gjkCaches[index] = gjkCaches[lastIndex];
+		stamps[index]	= stamps[lastIndex];
+	}
+	pairs.pop_back();
+	pairKeys.pop_back();
+	gjkCaches.pop_back();
+	stamps.pop_back();
+}
+
+void CollisionPairCache::Clear() {
+	if (pairs.empty()) {
+		return;
+	}
+	std::fill(slots.begin(), slots.end(), -1);
+	pairs.clear();
+	pairKeys.clear();
+	gjkCaches.clear();
+	stamps.clear();
+}
+
+void CollisionPairCache::Grow() {
+	slots.assign(slots.size() * 2, -1);
+	slotMask = slots.size() - 1;
+	for (int i = 0; i < (int)pairs.size(); ++i) {
+		slots[FindSlot(pairKeys[i])] = i;
+	}
+}
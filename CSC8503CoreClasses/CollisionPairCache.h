@@ -0,0 +1,82 @@
+#pragma once
+#include "CollisionDetection.h"
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		A flat replacement for std::set<CollisionInfo>. The pairs themselves live
+		in one contiguous array, so walking them is a straight run through
+		memory, and an open-addressed table of indices into that array (keyed
+		on the world IDs of the two objects) gives constant time lookups.
+		Removing a pair swaps the last one into its place, so nothing shuffles
+		down, and clearing keeps the storage around - once the cache has grown
+		to fit a scene, it doesn't allocate again.
+
+		Each pair also carries a GJKCache, so a cache that is kept from one
+		substep to the next (rather than cleared and refilled) lets the
+		narrowphase pick up where it left off with each pair. Touch and
+		RemoveUntouched are for keeping a cache that way.
+		*/
+		class CollisionPairCache {
+		public:
+			typedef CollisionDetection::CollisionInfo CollisionInfo;
+
+			CollisionPairCache(int initialCapacity = 64);
+			~CollisionPairCache() {}
+
+			//adds the pair if it isn't already in the cache. An existing pair is left untouched, just like std::set::insert
+			bool Insert(const CollisionInfo& info);
+
+			CollisionInfo* Find(const GameObject* a, const GameObject* b);
+
+			//adds the pair if it isn't already in the cache, and marks it as seen at this stamp either way
+			void Touch(const CollisionInfo& info, int stamp);
+
+			//removes every pair that wasn't touched at this stamp
+			void RemoveUntouched(int stamp);
+
+			//the last pair in the cache is moved into the removed pair's place
+			void RemoveAt(int index);
+
+			void Clear();
+
+			int Size() const {
+				return (int)pairs.size();
+			}
+
+			bool Empty() const {
+				return pairs.empty();
+			}
+
+			CollisionInfo& operator[](int index) {
+				return pairs[index];
+			}
+
+			CollisionDetection::GJKCache& GetGJKCache(int index) {
+				return gjkCaches[index];
+			}
+
+			std::vector<CollisionInfo>::iterator begin() {
+				return pairs.begin();
+			}
+
+			std::vector<CollisionInfo>::iterator end() {
+				return pairs.end();
+			}
+
+		protected:
+			static uint64_t PairKey(const GameObject* a, const GameObject* b);
+			static uint64_t	HashKey(uint64_t key);
+
+			int  FindSlot(uint64_t key) const;
+			void Grow();
+
+			std::vector<CollisionInfo>	pairs;
+			std::vector<uint64_t>		pairKeys;	//kept alongside pairs, so probing doesn't have to touch the objects
+			std::vector<CollisionDetection::GJKCache>	gjkCaches;
+			std::vector<int>			stamps;
+			std::vector<int>			slots;		//indices into pairs, or -1 for an empty slot
+			uint64_t					slotMask;
+		};
+	}
+}
@@ -23,7 +23,7 @@ namespace NCL {
 		CollisionVolume() {
 			type = VolumeType::Invalid;
 		}
-		~CollisionVolume() {}
+		virtual ~CollisionVolume() {}
 
 		virtual Maths::Vector3 Support(const Maths::Vector3& dir, const NCL::CSC8503::Transform& tr) const { return Vector3(); }
 
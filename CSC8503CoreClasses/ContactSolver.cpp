@@ -0,0 +1,189 @@
+#include "ContactSolver.h"
+#include "PhysicsObject.h"
+#include "GameObject.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+ContactSolver::ContactSolver() {
+	iterationCount			= 10;
+	lastIterationCount		= 0;
+	convergenceTolerance	= 1e-5f;
+	restitutionThreshold	= 1.0f;
+	correctionRate			= 0.2f;
+	penetrationSlop			= 0.005f;
+}
+
+void ContactSolver::Solve(std::vector<CollisionDetection::CollisionInfo>& manifolds, float dt) {
+	points.clear();
+	for (CollisionDetection::CollisionInfo& manifold : manifolds) {
+		PrepareManifold(manifold, dt);
+	}
+	lastIterationCount = 0;
+	if (points.empty()) {
+		return;
+	}
+	WarmStart();
+
+	for (int i = 0; i < iterationCount; ++i) {
+		float largestChange = 0.0f;
+		for (SolverPoint& p : points) {
+			largestChange = std::max(largestChange, SolvePoint(p));
+		}
+		lastIterationCount = i + 1;
+		if (largestChange < convergenceTolerance) {
+			break;
+		}
+	}
+
+	//friction is kept as a world space impulse, as the directions it's split into are picked again next substep
+	for (SolverPoint& p : points) {
+		p.contact->tangentImpulse = p.tangents[0] * p.tangentImpulse[0] + p.tangents[1] * p.tangentImpulse[1];
+	}
+}
+
+/*
+Everything about a contact point that doesn't change while it's being
+solved is worked out once here - the directions it pushes along, how
+much each object resists being pushed that way at that point, and how
+fast the point should end up separating.
+
+How bouncy and how grippy a pair is comes from both objects - a die
+hitting a rubber mat bounces less than one hitting glass. Bounciness is
+only used for points that are actually hitting each other, and not ones
+that are just resting - otherwise gravity pulling a die into the tray
+each substep makes it bounce a tiny bit each substep, and it never stops
+jittering.
+*/
+void ContactSolver::PrepareManifold(CollisionDetection::CollisionInfo& manifold, float dt) {
+	PhysicsObject* physA = manifold.a->GetPhysicsObject();
+	PhysicsObject* physB = manifold.b->GetPhysicsObject();
+
+	if (physA->GetInverseMass() + physB->GetInverseMass() == 0.0f) {
+		return;
+	}
+
+	float restitution	= physA->GetElasticity() * physB->GetElasticity();
+	float friction		= sqrt(physA->GetFriction() * physB->GetFriction());
+
+	for (int i = 0; i < manifold.pointCount; ++i) {
+		CollisionDetection::ContactPoint& contact = manifold.points[i];
+
+		SolverPoint p;
+		p.physA		= physA;
+		p.physB		= physB;
+		p.contact	= &contact;
+		p.normal	= contact.normal;
+		p.friction	= friction;
+
+		Vector3 velocity	= RelativeVelocity(*physA, *physB, contact.localA, contact.localB);
+		float normalSpeed	= Vector3::Dot(velocity, p.normal);
+
+		//friction works against sliding, so if the point is sliding, that's the best direction to push along
+		Vector3 sliding = velocity - p.normal * normalSpeed;
+		if (sliding.LengthSquared() > 1e-6f) {
+			p.tangents[0] = sliding.Normalised();
+		}
+		else {
+			Vector3 axis = std::abs(p.normal.x) < 0.57f ? Vector3(1, 0, 0) : Vector3(0, 1, 0);
+			p.tangents[0] = Vector3::Cross(p.normal, axis).Normalised();
+		}
+		p.tangents[1] = Vector3::Cross(p.normal, p.tangents[0]);
+
+		float k = EffectiveMass(*physA, *physB, contact.localA, contact.localB, p.normal);
+		p.normalMass = k > 0.0f ? 1.0f / k : 0.0f;
+		for (int t = 0; t < 2; ++t) {
+			k = EffectiveMass(*physA, *physB, contact.localA, contact.localB, p.tangents[t]);
+			p.tangentMass[t]	= k > 0.0f ? 1.0f / k : 0.0f;
+			p.tangentImpulse[t]	= Vector3::Dot(contact.tangentImpulse, p.tangents[t]);
+		}
+
+		//points just short of touching can close the gap this substep, but no further
+		float penetrationBias = 0.0f;
+		if (contact.penetration > penetrationSlop) {
+			penetrationBias = (correctionRate / dt) * (contact.penetration - penetrationSlop);
+		}
+		else if (contact.penetration < 0.0f) {
+			penetrationBias = contact.penetration / dt;
+		}
+		p.velocityBias = penetrationBias;
+		if (normalSpeed < -restitutionThreshold) {
+			p.velocityBias = std::max(penetrationBias, -restitution * normalSpeed);
+		}
+		points.emplace_back(p);
+	}
+}
+
+//each point starts off pushing as hard as it did last substep, and the solver corrects it from there
+void ContactSolver::WarmStart() {
+	for (SolverPoint& p : points) {
+		Vector3 impulse = p.normal * p.contact->normalImpulse
+			+ p.tangents[0] * p.tangentImpulse[0]
+			+ p.tangents[1] * p.tangentImpulse[1];
+		ApplyImpulse(*p.physA, *p.physB, p.contact->localA, p.contact->localB, impulse);
+	}
+}
+
+/*
+Friction goes first, limited by how hard the point was pushing at the
+end of the last pass, then the push itself. Returns the largest change
+made to any of the point's impulses.
+*/
+float ContactSolver::SolvePoint(SolverPoint& p) {
+	CollisionDetection::ContactPoint& contact = *p.contact;
+	float largestChange = 0.0f;
+
+	Vector3 velocity = RelativeVelocity(*p.physA, *p.physB, contact.localA, contact.localB);
+
+	float oldTangent[2] = { p.tangentImpulse[0], p.tangentImpulse[1] };
+	for (int t = 0; t < 2; ++t) {
+		p.tangentImpulse[t] -= Vector3::Dot(velocity, p.tangents[t]) * p.tangentMass[t];
+	}
+	float maxFriction		= p.friction * contact.normalImpulse;
+	float frictionSquared	= p.tangentImpulse[0] * p.tangentImpulse[0] + p.tangentImpulse[1] * p.tangentImpulse[1];
+	if (frictionSquared > maxFriction * maxFriction) {
+		float scale = maxFriction / sqrt(frictionSquared);
+		p.tangentImpulse[0] *= scale;
+		p.tangentImpulse[1] *= scale;
+	}
+	float tangentChange[2] = { p.tangentImpulse[0] - oldTangent[0], p.tangentImpulse[1] - oldTangent[1] };
+	ApplyImpulse(*p.physA, *p.physB, contact.localA, contact.localB,
+		p.tangents[0] * tangentChange[0] + p.tangents[1] * tangentChange[1]);
+	largestChange = std::max(std::abs(tangentChange[0]), std::abs(tangentChange[1]));
+
+	velocity = RelativeVelocity(*p.physA, *p.physB, contact.localA, contact.localB);
+
+	float normalSpeed	= Vector3::Dot(velocity, p.normal);
+	float oldNormal		= contact.normalImpulse;
+	contact.normalImpulse = std::max(oldNormal + (p.velocityBias - normalSpeed) * p.normalMass, 0.0f);
+
+	float normalChange = contact.normalImpulse - oldNormal;
+	ApplyImpulse(*p.physA, *p.physB, contact.localA, contact.localB, p.normal * normalChange);
+
+	return std::max(largestChange, std::abs(normalChange));
+}
+
+//how much impulse it takes to change the speed of the point along dir by 1
+float ContactSolver::EffectiveMass(const PhysicsObject& a, const PhysicsObject& b, const Vector3& relativeA, const Vector3& relativeB, const Vector3& dir) {
+	Vector3 inertiaA = Vector3::Cross(a.GetInertiaTensor() * Vector3::Cross(relativeA, dir), relativeA);
+	Vector3 inertiaB = Vector3::Cross(b.GetInertiaTensor() * Vector3::Cross(relativeB, dir), relativeB);
+
+	return a.GetInverseMass() + b.GetInverseMass() + Vector3::Dot(inertiaA + inertiaB, dir);
+}
+
+//how fast the point on b is moving away from the point on a
+Vector3 ContactSolver::RelativeVelocity(const PhysicsObject& a, const PhysicsObject& b, const Vector3& relativeA, const Vector3& relativeB) {
+	Vector3 fullVelocityA = a.GetLinearVelocity() + Vector3::Cross(a.GetAngularVelocity(), relativeA);
+	Vector3 fullVelocityB = b.GetLinearVelocity() + Vector3::Cross(b.GetAngularVelocity(), relativeB);
+
+	return fullVelocityB - fullVelocityA;
+}
+
+//impulse is what b gets - a gets the opposite
+void ContactSolver::ApplyImpulse(PhysicsObject& a, PhysicsObject& b, const Vector3& relativeA, const Vector3& relativeB, const Vector3& impulse) {
+	a.ApplyLinearImpulse(-impulse);
+	b.ApplyLinearImpulse(impulse);
+
+	a.ApplyAngularImpulse(Vector3::Cross(relativeA, -impulse));
+	b.ApplyAngularImpulse(Vector3::Cross(relativeB, impulse));
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include "CollisionDetection.h"
+
+namespace NCL {
+	namespace CSC8503 {
+		class PhysicsObject;
+
+		/*
+		Resolves every contact found in a substep together, rather than one
+		pair at a time. Each pass goes round all of the contact points,
+		working out how hard each one needs to push (and how much friction
+		it can hold) given everything the other points have already done,
+		and keeps a running total of the impulse at each point. A total is
+		never allowed to pull the objects together, and the friction at a
+		point is never allowed to be more than its friction coefficient
+		times how hard it is pushing. A stack of dice needs a few passes for
+		the push from the tray to get all the way up it, but once a pass
+		makes almost no difference, the rest are skipped.
+
+		Each point starts from the totals it finished last substep with
+		(if the narrowphase found the same point again), which means a die
+		sitting still on the tray is already being held up before the first
+		pass, and comes to rest far sooner.
+
+		Objects that overlap are pushed apart a little each substep, by
+		asking their contact points to separate a bit faster, rather than by
+		moving them directly - moving them directly lets a die tip off
+		its corner every time it's pushed out.
+		*/
+		class ContactSolver {
+		public:
+			ContactSolver();
+			~ContactSolver() {}
+
+			//the impulses each point ends up with are written back into the manifolds
+			void Solve(std::vector<CollisionDetection::CollisionInfo>& manifolds, float dt);
+
+			void SetIterationCount(int count) {
+				iterationCount = count;
+			}
+
+			int GetIterationCount() const {
+				return iterationCount;
+			}
+
+			//solving stops early once no point's impulse changes by more than this in a pass
+			void SetConvergenceTolerance(float tolerance) {
+				convergenceTolerance = tolerance;
+			}
+
+			float GetConvergenceTolerance() const {
+				return convergenceTolerance;
+			}
+
+			//objects hitting each other slower than this don't bounce, so resting contacts stay resting
+			void SetRestitutionThreshold(float speed) {
+				restitutionThreshold = speed;
+			}
+
+			//how much of any overlap is pushed out each substep, and how much is allowed before it's pushed out at all
+			void SetPenetrationCorrection(float rate, float slop) {
+				correctionRate	= rate;
+				penetrationSlop	= slop;
+			}
+
+			//how many passes the last Solve needed
+			int GetLastIterationCount() const {
+				return lastIterationCount;
+			}
+
+		protected:
+			struct SolverPoint {
+				PhysicsObject*	physA;
+				PhysicsObject*	physB;
+				CollisionDetection::ContactPoint* contact;
+
+				Vector3 normal;
+				Vector3 tangents[2];
+
+				float	normalMass;
+				float	tangentMass[2];
+
+				float	tangentImpulse[2];
+				float	velocityBias;	//how fast the point should be separating, from bounce or overlap
+				float	friction;
+			};
+
+			void	PrepareManifold(CollisionDetection::CollisionInfo& manifold, float dt);
+			void	WarmStart();
+			float	SolvePoint(SolverPoint& p);
+
+			static float EffectiveMass(const PhysicsObject& a, const PhysicsObject& b, const Vector3& relativeA, const Vector3& relativeB, const Vector3& dir);
+			static Vector3 RelativeVelocity(const PhysicsObject& a, const PhysicsObject& b, const Vector3& relativeA, const Vector3& relativeB);
+			static void ApplyImpulse(PhysicsObject& a, PhysicsObject& b, const Vector3& relativeA, const Vector3& relativeB, const Vector3& impulse);
+
+			std::vector<SolverPoint> points;	//kept between calls so it doesn't allocate every substep
+
+			int		iterationCount;
+			int		lastIterationCount;
+			float	convergenceTolerance;
+			float	restitutionThreshold;
+			float	correctionRate;
+			float	penetrationSlop;
+		};
+	}
+}
@@ -0,0 +1,275 @@
+#include "ContinuousCollision.h"
+#include "CollisionVolume.h"
+#include "GameObject.h"
+#include "PhysicsObject.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	//the volume shrunk down about the object's position, so it's always inside the real one
+	class CoreVolume : public CollisionVolume {
+	public:
+		CoreVolume(const CollisionVolume& volume, float scale) : volume(volume), scale(scale) {
+			type = volume.type;
+		}
+
+		Vector3 Support(const Vector3& dir, const Transform& tr) const override {
+			return tr.GetPosition() + (volume.Support(dir, tr) - tr.GetPosition()) * scale;
+		}
+
+	protected:
+		const CollisionVolume&	volume;
+		float					scale;
+	};
+}
+
+ContinuousCollision::ContinuousCollision() {
+	velocityThreshold	= 5.0f;
+	coreScale			= 0.5f;
+	touchDistance		= 0.005f;
+	maxIterations		= 32;
+}
+
+bool ContinuousCollision::CanSweep(const GameObject* object) {
+	const CollisionVolume* volume = object->GetBoundingVolume();
+	if (!volume) {
+		return false;
+	}
+	switch (volume->type) {
+		case VolumeType::Sphere:
+		case VolumeType::Capsule:
+		case VolumeType::Compound:
+		case VolumeType::Invalid:
+			return false;
+		default:
+			return true;
+	}
+}
+
+void ContinuousCollision::GetBounds(GameObject* object, Vector3& boundsMin, Vector3& boundsMax) {
+	const CollisionVolume&	volume		= *object->GetBoundingVolume();
+	const Transform&		transform	= object->GetTransform();
+	boundsMin.x = volume.Support(Vector3(-1, 0, 0), transform).x;
+	boundsMin.y = volume.Support(Vector3(0, -1, 0), transform).y;
+	boundsMin.z = volume.Support(Vector3(0, 0, -1), transform).z;
+	boundsMax.x = volume.Support(Vector3(1, 0, 0), transform).x;
+	boundsMax.y = volume.Support(Vector3(0, 1, 0), transform).y;
+	boundsMax.z = volume.Support(Vector3(0, 0, 1), transform).z;
+}
+
+/*
+The moving object is put where (and at the angle) the integrator would
+have it after t of the substep, using the same sums, so that the time
+found here is the time it ends up at once the integrator has moved it.
+*/
+float ContinuousCollision::TimeOfImpact(GameObject* moving, float radius, GameObject* fixed, float dt) const {
+	const PhysicsObject* object = moving->GetPhysicsObject();
+
+	Vector3 linearMove	= object->GetLinearVelocity() * dt;
+	Vector3 angularMove	= object->GetAngularVelocity() * dt;
+	float	spinBound	= angularMove.Length() * radius * coreScale;	//the furthest any point of the core can move from spin alone
+
+	Transform	movingTransform	= moving->GetTransform();
+	Vector3		startPosition	= movingTransform.GetPosition();
+	Quaternion	startOrientation= movingTransform.GetOrientation();
+
+	CoreVolume core(*moving->GetBoundingVolume(), coreScale);
+	const CollisionVolume& fixedVolume = *fixed->GetBoundingVolume();
+
+	float t = 0.0f;
+	for (int i = 0; i < maxIterations; ++i) {
+		Quaternion orientation = startOrientation + (Quaternion(angularMove * (t * 0.5f), 0.05f) * startOrientation);
+		orientation.Normalise();
+		movingTransform.SetPosition(startPosition + linearMove * t).SetOrientation(orientation);
+
+		float	distance;
+		Vector3 normal;
+		if (!Distance(core, movingTransform, fixedVolume, fixed->GetTransform(), distance, normal)) {
+			//if it's already this far in, it's too late to stop it - the narrowphase will have to deal with it
+			return t == 0.0f ? 1.0f : t;
+		}
+		if (distance < touchDistance) {
+			return t;
+		}
+		float closingSpeed = std::max(0.0f, Vector3::Dot(linearMove, normal)) + spinBound;
+		if (closingSpeed <= 0.0f) {
+			return 1.0f;
+		}
+		t += distance / closingSpeed;
+		if (t >= 1.0f) {
+			return 1.0f;
+		}
+	}
+	return t; //it's still closing in, and the next substep can carry on from here
+}
+
+/*
+The distance part of GJK: rather than stopping as soon as it knows
+whether the origin is inside the Minkowski difference, it keeps moving
+the simplex towards the origin, until the support point in the direction
+of the origin is no closer than the closest point on the simplex.
+*/
+bool ContinuousCollision::Distance(const CollisionVolume& volumeA, const Transform& worldTransformA,
+	const CollisionVolume& volumeB, const Transform& worldTransformB, float& distance, Vector3& normal) {
+	SimplexVert simplex[4];
+	int count = 0;
+
+	//both positions are inside their volumes, so this is a point in the Minkowski difference to start from
+	Vector3 closest = worldTransformA.GetPosition() - worldTransformB.GetPosition();
+	if (closest.LengthSquared() < 1e-12f) {
+		return false;
+	}
+	for (int i = 0; i < 32; ++i) {
+		SimplexVert v;
+		v.a = volumeA.Support(-closest, worldTransformA);
+		v.b = volumeB.Support(closest, worldTransformB);
+		v.w = v.a - v.b;
+
+		float closestSq = closest.LengthSquared();
+		if (closestSq - Vector3::Dot(closest, v.w) <= closestSq * 1e-6f) {
+			break; //no point in the difference is meaningfully nearer the origin
+		}
+		bool repeated = false;
+		for (int j = 0; j < count; ++j) {
+			repeated |= (simplex[j].w - v.w).LengthSquared() < 1e-12f;
+		}
+		if (repeated) {
+			break;
+		}
+		simplex[count++] = v;
+		closest = ClosestOnSimplex(simplex, count);
+
+		if (count == 4 || closest.LengthSquared() < 1e-10f) {
+			return false;
+		}
+	}
+	distance	= closest.Length();
+	normal		= -closest / distance;
+	return true;
+}
+
+/*
+Finds the point on the simplex closest to the origin, and cuts the
+simplex down to just the corners needed to make that point. A
+tetrahedron is only left whole if the origin is inside it.
+*/
+Vector3 ContinuousCollision::ClosestOnSimplex(SimplexVert* simplex, int& count) {
+	if (count == 1) {
+		return simplex[0].w;
+	}
+	if (count == 2) {
+		Vector3 a	= simplex[0].w;
+		Vector3 ab	= simplex[1].w - a;
+		float t = -Vector3::Dot(a, ab) / ab.LengthSquared();
+		if (t <= 0.0f) {
+			count = 1;
+			return a;
+		}
+		if (t >= 1.0f) {
+			simplex[0]	= simplex[1];
+			count		= 1;
+			return simplex[0].w;
+		}
+		return a + ab * t;
+	}
+	if (count == 3) {
+		SimplexVert reduced[3];
+		Vector3 point = ClosestOnTriangle(simplex, reduced, count);
+		std::copy(reduced, reduced + count, simplex);
+		return point;
+	}
+	//the origin is inside the tetrahedron if it's on the same side of each face as the corner opposite it
+	const int faces[4][4] = { {0,1,2,3}, {0,2,3,1}, {0,3,1,2}, {1,3,2,0} };
+
+	float		bestSq = FLT_MAX;
+	Vector3		best;
+	SimplexVert	bestVerts[3];
+	int			bestCount = 0;
+	for (const int* f : faces) {
+		Vector3 a = simplex[f[0]].w;
+		Vector3 faceNormal	= Vector3::Cross(simplex[f[1]].w - a, simplex[f[2]].w - a);
+		float originSide	= -Vector3::Dot(faceNormal, a);
+		float cornerSide	= Vector3::Dot(faceNormal, simplex[f[3]].w - a);
+		if (originSide * cornerSide > 0.0f) {
+			continue;
+		}
+		SimplexVert tri[3]		= { simplex[f[0]], simplex[f[1]], simplex[f[2]] };
+		SimplexVert reduced[3];
+		int reducedCount;
+		Vector3 point = ClosestOnTriangle(tri, reduced, reducedCount);
+		if (point.LengthSquared() < bestSq) {
+			bestSq		= point.LengthSquared();
+			best		= point;
+			bestCount	= reducedCount;
+			std::copy(reduced, reduced + reducedCount, bestVerts);
+		}
+	}
+	if (bestCount == 0) {
+		return Vector3(); //the origin is inside
+	}
+	std::copy(bestVerts, bestVerts + bestCount, simplex);
+	count = bestCount;
+	return best;
+}
+
+/*
+Works out which of the triangle's Voronoi regions (its corners, edges or
+face) the origin is in, as in Ericson's Real-Time Collision Detection.
+*/
+Vector3 ContinuousCollision::ClosestOnTriangle(const SimplexVert* in, SimplexVert* out, int& outCount) {
+	Vector3 a	= in[0].w;
+	Vector3 b	= in[1].w;
+	Vector3 c	= in[2].w;
+	Vector3 ab	= b - a;
+	Vector3 ac	= c - a;
+
+	float d1 = -Vector3::Dot(ab, a);
+	float d2 = -Vector3::Dot(ac, a);
+	if (d1 <= 0.0f && d2 <= 0.0f) {
+		out[0] = in[0];
+		outCount = 1;
+		return a;
+	}
+	float d3 = -Vector3::Dot(ab, b);
+	float d4 = -Vector3::Dot(ac, b);
+	if (d3 >= 0.0f && d4 <= d3) {
+		out[0] = in[1];
+		outCount = 1;
+		return b;
+	}
+	float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+		out[0] = in[0];
+		out[1] = in[1];
+		outCount = 2;
+		return a + ab * (d1 / (d1 - d3));
+	}
+	float d5 = -Vector3::Dot(ab, c);
+	float d6 = -Vector3::Dot(ac, c);
+	if (d6 >= 0.0f && d5 <= d6) {
+		out[0] = in[2];
+		outCount = 1;
+		return c;
+	}
+	float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+		out[0] = in[0];
+		out[1] = in[2];
+		outCount = 2;
+		return a + ac * (d2 / (d2 - d6));
+	}
+	float va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+		out[0] = in[1];
+		out[1] = in[2];
+		outCount = 2;
+		return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+	}
+	float denom = 1.0f / (va + vb + vc);
+	out[0] = in[0];
+	out[1] = in[1];
+	out[2] = in[2];
+	outCount = 3;
+	return a + ab * (vb * denom) + ac * (vc * denom);
+}
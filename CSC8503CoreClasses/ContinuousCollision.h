@@ -0,0 +1,101 @@
+#pragma once
+#include "Transform.h"
+
+namespace NCL {
+	class CollisionVolume;
+
+	namespace CSC8503 {
+		class GameObject;
+
+		/*
+		A die thrown hard enough can move further in one substep than the
+		tray's walls are thick, and the narrowphase only ever looks at
+		where things are at the end of a substep - so it can start a
+		substep on one side of a wall and end it on the other without
+		anything ever being found to overlap. That gets more likely the
+		lower the substep rate is, which is exactly what the StepController
+		drops it to when physics is running slowly.
+
+		So before anything fast is moved, this works out when during the
+		substep it would first hit each immovable object near its path,
+		by conservative advancement: GJK finds how far apart the two are,
+		and, as nothing on the moving object can close that gap faster
+		than its speed towards the other one plus its spin times its
+		radius, the object can safely be moved on by however long that
+		gap takes to close at that speed. That's repeated until the gap is
+		small enough to count as touching, or the substep runs out, and
+		the object is only moved as far as that this substep. The rest of
+		its movement is lost, but its velocity isn't, so the narrowphase
+		finds the contact next substep and the contact solver bounces it
+		off properly.
+
+		It's not the whole object that's swept, but a smaller copy of it
+		(its core) - a die sliding along a wall, or rolling across the
+		floor, is always touching it, and shouldn't be held up by it.
+		Anything that only gets as far into a wall as the gap between its
+		core and its surface, the narrowphase can deal with on its own.
+
+		Only volumes with a support function (boxes, dice and convex hulls)
+		can be swept, as that's all GJK knows how to work with.
+		*/
+		class ContinuousCollision {
+		public:
+			ContinuousCollision();
+			~ContinuousCollision() {}
+
+			/*
+			How much of a substep of dt seconds the moving object can move
+			for before its core hits the fixed one - 1 if it can make the
+			whole move. The radius is the furthest any part of the
+			moving object is from its position.
+			*/
+			float TimeOfImpact(GameObject* moving, float radius, GameObject* fixed, float dt) const;
+
+			static bool CanSweep(const GameObject* object);
+
+			//the world space box around an object's volume, from its support points along each axis
+			static void GetBounds(GameObject* object, Vector3& boundsMin, Vector3& boundsMax);
+
+			//anything moving slower than this isn't swept at all
+			void SetVelocityThreshold(float speed) {
+				velocityThreshold = speed;
+			}
+
+			float GetVelocityThreshold() const {
+				return velocityThreshold;
+			}
+
+			//how big the swept core is, as a fraction of the object's size
+			void SetCoreScale(float scale) {
+				coreScale = scale;
+			}
+
+			float GetCoreScale() const {
+				return coreScale;
+			}
+
+			void SetMaxIterations(int count) {
+				maxIterations = count;
+			}
+
+		protected:
+			struct SimplexVert {
+				Vector3 w;	//a - b, a corner of the Minkowski difference
+				Vector3 a;
+				Vector3 b;
+			};
+
+			//false if the two overlap, otherwise how far apart they are, and the direction from A to B
+			static bool Distance(const CollisionVolume& volumeA, const Transform& worldTransformA,
+				const CollisionVolume& volumeB, const Transform& worldTransformB, float& distance, Vector3& normal);
+
+			static Vector3 ClosestOnSimplex(SimplexVert* simplex, int& count);
+			static Vector3 ClosestOnTriangle(const SimplexVert* in, SimplexVert* out, int& outCount);
+
+			float	velocityThreshold;
+			float	coreScale;
+			float	touchDistance;	//gaps smaller than this count as touching
+			int		maxIterations;
+		};
+	}
+}
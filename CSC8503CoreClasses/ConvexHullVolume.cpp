@@ -0,0 +1,362 @@
+#include "ConvexHullVolume.h"
+#include "Mesh.h"
+#include <map>
+#include <stdexcept>
+
+using namespace NCL;
+using namespace NCL::Maths;
+
+namespace {
+	struct HullFace {
+		int		v[3];
+		Vector3 normal;
+		float	offset;
+		bool	alive;
+		std::vector<int> outside;	//points in front of this face, that it's up to this face to deal with
+	};
+
+	HullFace MakeFace(const std::vector<Vector3>& points, int a, int b, int c) {
+		HullFace f;
+		f.v[0]		= a;
+		f.v[1]		= b;
+		f.v[2]		= c;
+		f.normal	= Vector3::Cross(points[b] - points[a], points[c] - points[a]).Normalised();
+		f.offset	= Vector3::Dot(f.normal, points[a]);
+		f.alive		= true;
+		return f;
+	}
+
+	float Distance(const HullFace& f, const Vector3& p) {
+		return Vector3::Dot(f.normal, p) - f.offset;
+	}
+
+	void AddFace(std::vector<HullFace>& faces, std::map<std::pair<int, int>, int>& edgeFaces, const HullFace& f) {
+		for (int e = 0; e < 3; ++e) {
+			edgeFaces[std::make_pair(f.v[e], f.v[(e + 1) % 3])] = (int)faces.size();
+		}
+		faces.emplace_back(f);
+	}
+
+	//points that aren't in front of any face from firstFace on are inside the hull, and can be forgotten about
+	void ClaimPoints(const std::vector<Vector3>& points, std::vector<HullFace>& faces, int firstFace, const std::vector<int>& unclaimed, float epsilon) {
+		for (int i : unclaimed) {
+			int		best		= -1;
+			float	bestDist	= epsilon;
+			for (int f = firstFace; f < (int)faces.size(); ++f) {
+				float d = Distance(faces[f], points[i]);
+				if (d > bestDist) {
+					bestDist	= d;
+					best		= f;
+				}
+			}
+			if (best >= 0) {
+				faces[best].outside.emplace_back(i);
+			}
+		}
+	}
+
+	float DistanceFromLine(const Vector3& p, const Vector3& a, const Vector3& b) {
+		return Vector3::Cross(p - a, (b - a).Normalised()).Length();
+	}
+}
+
+ConvexHullVolume::ConvexHullVolume(const Rendering::Mesh& mesh, float scale) {
+	type = VolumeType::Mesh;
+	std::vector<Vector3> points = mesh.GetPositionData();
+	for (Vector3& p : points) {
+		p = p * scale;
+	}
+	Build(points);
+}
+
+ConvexHullVolume::ConvexHullVolume(const std::vector<Vector3>& points, float scale) {
+	type = VolumeType::Mesh;
+	std::vector<Vector3> scaled(points.size());
+	for (size_t i = 0; i < points.size(); ++i) {
+		scaled[i] = points[i] * scale;
+	}
+	Build(scaled);
+}
+
+/*
+Builds the hull with quickhull, starting from a tetrahedron of points that
+are well spread out. Each face keeps the points in front of it, and the
+one furthest out is added to the hull next: every face it can see is
+removed, and it's joined up to the edges round the hole that leaves. The
+points the removed faces had are shared out among the new faces, and any
+that are now inside are dropped - which is most of them for a mesh, as
+its corners get repeated for every face they're part of, and a repeat of
+a corner that's already been added is never in front of anything.
+*/
+void ConvexHullVolume::Build(const std::vector<Vector3>& points) {
+	if (points.empty()) {
+		throw std::invalid_argument("ConvexHullVolume needs at least one point");
+	}
+	radius = 0.0f;
+
+	Vector3 minPoint( FLT_MAX,  FLT_MAX,  FLT_MAX);
+	Vector3 maxPoint(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for (const Vector3& p : points) {
+		for (int i = 0; i < 3; ++i) {
+			minPoint[i] = std::min(minPoint[i], p[i]);
+			maxPoint[i] = std::max(maxPoint[i], p[i]);
+		}
+	}
+	float extent	= (maxPoint - minPoint).Length();
+	float epsilon	= extent * 1e-4f;
+
+	std::vector<HullFace>	faces;
+	std::vector<bool>		onHull(points.size(), false);
+
+	int start[4] = { 0, 0, 0, 0 };
+	bool solid = points.size() >= 4;
+	if (solid) {
+		for (int i = 1; i < (int)points.size(); ++i) {
+			if (points[i].x < points[start[0]].x) {
+				start[0] = i;
+			}
+		}
+		float best = 0.0f;
+		for (int i = 0; i < (int)points.size(); ++i) {
+			float d = (points[i] - points[start[0]]).Length();
+			if (d > best) {
+				best		= d;
+				start[1]	= i;
+			}
+		}
+		best = 0.0f;
+		for (int i = 0; i < (int)points.size(); ++i) {
+			float d = DistanceFromLine(points[i], points[start[0]], points[start[1]]);
+			if (d > best) {
+				best		= d;
+				start[2]	= i;
+			}
+		}
+		solid = best > epsilon;
+	}
+	if (solid) {
+		HullFace base = MakeFace(points, start[0], start[1], start[2]);
+		float best = 0.0f;
+		for (int i = 0; i < (int)points.size(); ++i) {
+			float d = std::abs(Vector3::Dot(base.normal, points[i]) - base.offset);
+			if (d > best) {
+				best		= d;
+				start[3]	= i;
+			}
+		}
+		solid = best > epsilon;
+	}
+
+	if (!solid) {
+		//flat (or tiny) shapes have no faces to speak of, but can still give support points by trying every corner
+		for (const Vector3& p : points) {
+			x.emplace_back(p.x);
+			y.emplace_back(p.y);
+			z.emplace_back(p.z);
+			radius = std::max(radius, p.Length());
+		}
+		neighbourStart.assign(points.size() + 1, 0);
+		for (int i = 0; i < 8; ++i) {
+			octantStart[i] = 0;
+		}
+		return;
+	}
+
+	//the 4th point is kept behind every starting face, so they all face outwards
+	const int tetra[4][3] = { {0, 1, 2}, {0, 3, 1}, {1, 3, 2}, {2, 3, 0} };
+	std::map<std::pair<int, int>, int> edgeFaces;
+	for (int i = 0; i < 4; ++i) {
+		HullFace f = MakeFace(points, start[tetra[i][0]], start[tetra[i][1]], start[tetra[i][2]]);
+		int opposite = start[6 - tetra[i][0] - tetra[i][1] - tetra[i][2]];
+		if (Vector3::Dot(f.normal, points[opposite]) > f.offset) {
+			f = MakeFace(points, f.v[0], f.v[2], f.v[1]);
+		}
+		AddFace(faces, edgeFaces, f);
+		onHull[start[i]] = true;
+	}
+
+	//every point outside the hull belongs to the face it's furthest in front of
+	std::vector<int> unclaimed;
+	for (int i = 0; i < (int)points.size(); ++i) {
+		if (!onHull[i]) {
+			unclaimed.emplace_back(i);
+		}
+	}
+	ClaimPoints(points, faces, 0, unclaimed, epsilon);
+
+	std::vector<int>					visible;
+	std::vector<std::pair<int, int>>	horizon;
+	for (int current = 0; current < (int)faces.size(); ++current) {
+		if (!faces[current].alive || faces[current].outside.empty()) {
+			continue;
+		}
+		int eye = faces[current].outside[0];
+		for (int i : faces[current].outside) {
+			if (Distance(faces[current], points[i]) > Distance(faces[current], points[eye])) {
+				eye = i;
+			}
+		}
+
+		//the faces the eye can see are all joined up, so they're found by spreading out from the one it came from. Unlike
+		//picking the eye, this can't allow any leeway - a face the eye is only just in front of would fold over the new ones
+		//next to it, which can leave corners sticking out of the hull
+		visible.clear();
+		horizon.clear();
+		faces[current].alive = false;
+		visible.emplace_back(current);
+		for (size_t v = 0; v < visible.size(); ++v) {
+			const HullFace& f = faces[visible[v]];
+			for (int e = 0; e < 3; ++e) {
+				int a = f.v[e];
+				int b = f.v[(e + 1) % 3];
+				int other = edgeFaces[std::make_pair(b, a)];
+				if (!faces[other].alive) {
+					continue;
+				}
+				if (Distance(faces[other], points[eye]) > 0.0f) {
+					faces[other].alive = false;
+					visible.emplace_back(other);
+				}
+				else {
+					horizon.emplace_back(a, b);
+				}
+			}
+		}
+
+		unclaimed.clear();
+		for (int v : visible) {
+			for (int e = 0; e < 3; ++e) {
+				edgeFaces.erase(std::make_pair(faces[v].v[e], faces[v].v[(e + 1) % 3]));
+			}
+			for (int i : faces[v].outside) {
+				if (i != eye) {
+					unclaimed.emplace_back(i);
+				}
+			}
+			faces[v].outside.clear();
+		}
+		int firstNew = (int)faces.size();
+		for (const std::pair<int, int>& edge : horizon) {
+			AddFace(faces, edgeFaces, MakeFace(points, edge.first, edge.second, eye));
+		}
+		ClaimPoints(points, faces, firstNew, unclaimed, epsilon);
+	}
+	faces.erase(std::remove_if(faces.begin(), faces.end(), [](const HullFace& f) { return !f.alive; }), faces.end());
+
+	//only the points still used by a face are corners of the hull
+	std::vector<int> remap(points.size(), -1);
+	for (const HullFace& f : faces) {
+		for (int i = 0; i < 3; ++i) {
+			if (remap[f.v[i]] < 0) {
+				remap[f.v[i]] = (int)x.size();
+				x.emplace_back(points[f.v[i]].x);
+				y.emplace_back(points[f.v[i]].y);
+				z.emplace_back(points[f.v[i]].z);
+				radius = std::max(radius, points[f.v[i]].Length());
+			}
+		}
+	}
+
+	int vertCount = (int)x.size();
+	std::vector<std::vector<int>> adjacent(vertCount);
+	for (const HullFace& f : faces) {
+		for (int e = 0; e < 3; ++e) {
+			int a = remap[f.v[e]];
+			int b = remap[f.v[(e + 1) % 3]];
+			if (std::find(adjacent[a].begin(), adjacent[a].end(), b) == adjacent[a].end()) {
+				adjacent[a].emplace_back(b);
+				adjacent[b].emplace_back(a);
+			}
+		}
+	}
+	neighbourStart.emplace_back(0);
+	for (int i = 0; i < vertCount; ++i) {
+		neighbours.insert(neighbours.end(), adjacent[i].begin(), adjacent[i].end());
+		neighbourStart.emplace_back((int)neighbours.size());
+	}
+	for (int i = 0; i < 8; ++i) {
+		octantStart[i] = ArgMax(Vector3(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f));
+	}
+
+	//triangles facing the same way are all part of one face of the hull, and are weighted by their area to get its normal
+	std::vector<Vector3> summedNormals;
+	for (const HullFace& f : faces) {
+		Vector3 areaNormal = Vector3::Cross(points[f.v[1]] - points[f.v[0]], points[f.v[2]] - points[f.v[0]]);
+		bool merged = false;
+		for (size_t i = 0; i < faceNormals.size(); ++i) {
+			if (Vector3::Dot(faceNormals[i], f.normal) > 0.999f) {
+				summedNormals[i] = summedNormals[i] + areaNormal;
+				merged = true;
+				break;
+			}
+		}
+		if (!merged) {
+			faceNormals.emplace_back(f.normal);
+			summedNormals.emplace_back(areaNormal);
+		}
+	}
+	for (size_t i = 0; i < faceNormals.size(); ++i) {
+		faceNormals[i] = summedNormals[i].Normalised();
+	}
+	if ((int)faceNormals.size() <= MAX_LOOKUP_FACES) {
+		faceLookup.Build(faceNormals.data(), (int)faceNormals.size());
+	}
+}
+
+int ConvexHullVolume::ArgMax(const Vector3& dir) const {
+	float	bestDot		= -FLT_MAX;
+	int		bestIndex	= 0;
+	for (int i = 0; i < (int)x.size(); ++i) {
+		float dot = Dot(dir, i);
+		if (dot > bestDot) {
+			bestDot		= dot;
+			bestIndex	= i;
+		}
+	}
+	return bestIndex;
+}
+
+int ConvexHullVolume::HillClimb(const Vector3& dir) const {
+	if (neighbours.empty()) {
+		return ArgMax(dir);
+	}
+	int current = octantStart[(dir.x > 0 ? 1 : 0) | (dir.y > 0 ? 2 : 0) | (dir.z > 0 ? 4 : 0)];
+	float currentDot = Dot(dir, current);
+	while (true) {
+		int next = current;
+		for (int i = neighbourStart[current]; i < neighbourStart[current + 1]; ++i) {
+			int n = neighbours[i];
+			float dot = Dot(dir, n);
+			if (dot > currentDot) {
+				currentDot	= dot;
+				next		= n;
+			}
+		}
+		if (next == current) {
+			return current;
+		}
+		current = next;
+	}
+}
+
+//0 if the hull is flat, and so has no faces to land on
+short ConvexHullVolume::GetFaceResult(const NCL::CSC8503::Transform& tr) const {
+	if (faceNormals.empty()) {
+		return 0;
+	}
+	Vector3 upLocalised = tr.GetOrientation().Conjugate() * Vector3(0, 1, 0);
+	if ((int)faceNormals.size() <= MAX_LOOKUP_FACES) {
+		return faceLookup.Find(upLocalised) + 1;
+	}
+	//too many faces for the lookup, so it's every face in turn
+	int		best	= 0;
+	float	bestDot = -FLT_MAX;
+	for (int i = 0; i < (int)faceNormals.size(); ++i) {
+		float dot = Vector3::Dot(upLocalised, faceNormals[i]);
+		if (dot > bestDot) {
+			bestDot = dot;
+			best	= i;
+		}
+	}
+	return best + 1;
+}
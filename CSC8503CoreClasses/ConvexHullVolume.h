@@ -0,0 +1,81 @@
+#pragma once
+#include "CollisionVolume.h"
+#include "FaceLookup.h"
+#include <vector>
+
+namespace NCL {
+	namespace Rendering {
+		class Mesh;
+	}
+	/*
+	A collision volume for any convex shape, built from a mesh's vertex
+	positions when it's loaded, so new dice don't need their own volume
+	class with their corners typed in by hand.
+
+	The hull is built once, keeping only the points that are actually
+	corners of it. These are stored as separate x, y and z arrays, along
+	with which corners are joined by an edge, so support points can be
+	found by hill climbing from a good starting corner, as the D20 does.
+	Triangles of the hull that lie in the same plane are merged into one
+	face, and their normals kept, so GetFaceResult can tell which face is
+	pointing up.
+
+	The hull's faces are numbered in the order they're found, which won't
+	match the numbers printed on a die. GetFaceResult returns an index into
+	faces (plus 1, like the other dice), and it's up to the game to map it
+	to whatever is printed on that face. It uses a FaceLookup, like the D10
+	and D12 do, as long as the hull has no more than MAX_LOOKUP_FACES faces.
+
+	There has to be at least one point to build a hull from - an empty
+	list of points throws std::invalid_argument.
+	*/
+	class ConvexHullVolume : CollisionVolume
+	{
+	public:
+		static const int MAX_LOOKUP_FACES = 64;
+
+		ConvexHullVolume(const Rendering::Mesh& mesh, float scale = 1.0f);
+		ConvexHullVolume(const std::vector<Maths::Vector3>& points, float scale = 1.0f);
+		~ConvexHullVolume() {}
+
+		Maths::Vector3 Support(const Maths::Vector3& dir, const NCL::CSC8503::Transform& tr) const override
+		{
+			Maths::Vector3 localDir = tr.GetOrientation().Conjugate() * dir;
+			int index = HillClimb(localDir);
+			return tr.GetOrientation() * Maths::Vector3(x[index], y[index], z[index]) + tr.GetPosition();
+		}
+
+		short GetFaceResult(const NCL::CSC8503::Transform& tr) const;
+
+		int		GetVertexCount()	const { return (int)x.size(); }
+		int		GetFaceCount()		const { return (int)faceNormals.size(); }
+		float	GetRadius()			const { return radius; }
+
+		Maths::Vector3 GetVertex(int i)		const { return Maths::Vector3(x[i], y[i], z[i]); }
+		Maths::Vector3 GetFaceNormal(int i)	const { return faceNormals[i]; }
+
+	protected:
+		void Build(const std::vector<Maths::Vector3>& points);
+
+		int ArgMax(const Maths::Vector3& dir) const;
+		int HillClimb(const Maths::Vector3& dir) const;
+
+		float Dot(const Maths::Vector3& dir, int i) const {
+			return dir.x * x[i] + dir.y * y[i] + dir.z * z[i];
+		}
+
+		float radius;
+
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+
+		//corner i's neighbours are neighbours[neighbourStart[i]] up to neighbours[neighbourStart[i + 1]]
+		std::vector<int> neighbourStart;
+		std::vector<int> neighbours;
+		int octantStart[8];
+
+		std::vector<Maths::Vector3> faceNormals;
+		FaceLookup<MAX_LOOKUP_FACES> faceLookup;
+	};
+}
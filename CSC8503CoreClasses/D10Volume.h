@@ -0,0 +1,98 @@
+#pragma once
+#include "CollisionVolume.h"
+#include "SupportTable.h"
+#include "FaceLookup.h"
+
+namespace NCL {
+	class D10Volume : CollisionVolume
+	{
+	public:
+		//TEN is the face printed as 0
+		enum DiceNumber
+		{
+			ONE,
+			TWO,
+			THREE,
+			FOUR,
+			FIVE,
+			SIX,
+			SEVEN,
+			EIGHT,
+			NINE,
+			TEN,
+			MAX
+		};
+		/*The corners here are taken straight from d10.msh, so this is very particular to that model and texture of dice. The mesh's
+		points are flattened off a little, so it has 5 corners around each end rather than a single point*/
+		D10Volume(float height = 1.0f)
+		{
+			type = VolumeType::D10_Dice;
+			this->height = height;
+
+			static const Vector3 meshVerts[VERT_COUNT] = {
+				{ -0.8043f, 0.1142f, -0.5871f },	{ 0.3096f, 0.1147f, -0.9459f },		{ -0.3084f, -0.1122f, -0.9466f },	{ -0.0622f, 1.0000f, -0.0454f },
+				{ 0.0240f, 1.0000f, -0.0732f },		{ -0.0770f, -1.0000f, 0.0024f },	{ 0.0623f, -1.0000f, 0.0477f },		{ -0.0238f, -1.0000f, 0.0757f },
+				{ 0.0623f, -1.0000f, -0.0428f },	{ -0.0238f, -1.0000f, -0.0708f },	{ 0.9966f, 0.1134f, 0.0022f },		{ 0.3063f, 0.1122f, 0.9497f },
+				{ 0.8056f, -0.1142f, 0.5878f },		{ 0.0236f, 1.0000f, 0.0733f },		{ 0.0771f, 1.0000f, 0.0002f },		{ -0.0624f, 1.0000f, 0.0452f },
+				{ -0.9966f, -0.1134f, 0.0024f },	{ -0.3076f, -0.1146f, 0.9490f },	{ -0.8082f, 0.1127f, 0.5845f },		{ 0.8069f, -0.1126f, -0.5838f }
+			};
+			radius = 0.0f;
+			for (int i = 0; i < VERT_COUNT; i++)
+			{
+				localVerts[i] = meshVerts[i] * height;
+				radius = std::max(radius, localVerts[i].Length());
+			}
+			SetFaceNormals();
+			supportTable.Build(localVerts, false);
+			faceLookup.Build(faceNormals);
+		}
+		~D10Volume() {}
+
+		//each numbered face is a kite, with its point cut off where it meets the end of the die
+		void SetFaceNormals()
+		{
+			static const int faceVerts[MAX][5] = {
+				{ 8, 9, 2, 1, 19 },		//ONE
+				{ 1, 2, 0, 3, 4 },		//TWO
+				{ 17, 18, 16, 5, 7 },	//THREE
+				{ 11, 12, 10, 14, 13 },	//FOUR
+				{ 16, 0, 2, 9, 5 },		//FIVE
+				{ 4, 14, 10, 19, 1 },	//SIX
+				{ 6, 12, 11, 17, 7 },	//SEVEN
+				{ 13, 15, 18, 17, 11 },	//EIGHT
+				{ 8, 19, 10, 12, 6 },	//NINE
+				{ 15, 3, 0, 16, 18 }	//TEN
+			};
+			for (int i = 0; i < MAX; i++)
+			{
+				faceNormals[i] = PolygonNormal(localVerts, faceVerts[i], 5);
+			}
+		}
+
+		float GetHeight() const { return height; }
+		float GetRadius() const { return radius; }
+
+		Maths::Vector3 Support(const Maths::Vector3& dir, const NCL::CSC8503::Transform& tr) const override
+		{
+			Vector3 localDir = tr.GetOrientation().Conjugate() * dir;
+			int index = supportTable.ArgMax(localDir);
+			return tr.GetOrientation() * localVerts[index] + tr.GetPosition();
+		}
+
+		short GetFaceResult(const NCL::CSC8503::Transform& tr) const
+		{
+			Vector3 upLocalised = tr.GetOrientation().Conjugate() * Vector3(0, 1, 0);
+			return faceLookup.Find(upLocalised) + 1;
+		}
+
+	protected:
+		static const int VERT_COUNT = 20;
+
+		float	height;
+		float	radius;
+		Vector3 localVerts[VERT_COUNT];
+		Vector3 faceNormals[MAX];
+		SupportTable<VERT_COUNT>	supportTable;
+		FaceLookup<MAX>				faceLookup;
+	};
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "CollisionVolume.h"
+#include "SupportTable.h"
+#include "FaceLookup.h"
+
+namespace NCL {
+	class D12Volume : CollisionVolume
+	{
+	public:
+		enum DiceNumber
+		{
+			ONE,
+			TWO,
+			THREE,
+			FOUR,
+			FIVE,
+			SIX,
+			SEVEN,
+			EIGHT,
+			NINE,
+			TEN,
+			ELEVEN,
+			TWELVE,
+			MAX
+		};
+		/*The corners here are taken straight from d12.msh (a dodecahedron with an edge length of 1), so this is very particular
+		to that model and texture of dice*/
+		D12Volume(float edgeLength = 1.0f)
+		{
+			type = VolumeType::D12_Dice;
+			this->edgeLength = edgeLength;
+
+			static const Vector3 meshVerts[VERT_COUNT] = {
+				{ -0.8507f, -1.1112f, 0.0000f },	{ -1.1135f, 0.2652f, 0.8090f },		{ -1.3764f, -0.2605f, 0.0000f },	{ -0.2629f, -1.1112f, 0.8090f },
+				{ -0.4253f, -0.2605f, 1.3090f },	{ -0.6882f, 1.1159f, 0.5000f },		{ 0.4253f, 0.2652f, 1.3090f },		{ 0.2629f, 1.1159f, 0.8090f },
+				{ 0.2629f, 1.1159f, -0.8090f },		{ -1.1135f, 0.2652f, -0.8090f },	{ -0.6882f, 1.1159f, -0.5000f },	{ 0.4253f, 0.2652f, -1.3090f },
+				{ -0.4253f, -0.2605f, -1.3090f },	{ 0.8507f, 1.1159f, 0.0000f },		{ 1.1135f, -0.2605f, -0.8090f },	{ 1.3764f, 0.2652f, 0.0000f },
+				{ 0.6882f, -1.1112f, -0.5000f },	{ -0.2629f, -1.1112f, -0.8090f },	{ 0.6882f, -1.1112f, 0.5000f },		{ 1.1135f, -0.2605f, 0.8090f }
+			};
+			radius = 0.0f;
+			for (int i = 0; i < VERT_COUNT; i++)
+			{
+				localVerts[i] = meshVerts[i] * edgeLength;
+				radius = std::max(radius, localVerts[i].Length());
+			}
+			SetFaceNormals();
+			supportTable.Build(localVerts, false);
+			supportTable.BuildNeighbours(localVerts, edgeLength);
+			faceLookup.Build(faceNormals);
+		}
+		~D12Volume() {}
+
+		void SetFaceNormals()
+		{
+			static const int faceVerts[MAX][5] = {
+				{ 6, 7, 5, 1, 4 },			//ONE
+				{ 19, 18, 16, 14, 15 },		//TWO
+				{ 13, 8, 10, 5, 7 },		//THREE
+				{ 9, 12, 17, 0, 2 },		//FOUR
+				{ 4, 3, 18, 19, 6 },		//FIVE
+				{ 14, 11, 8, 13, 15 },		//SIX
+				{ 1, 2, 0, 3, 4 },			//SEVEN
+				{ 9, 10, 8, 11, 12 },		//EIGHT
+				{ 7, 6, 19, 15, 13 },		//NINE
+				{ 0, 17, 16, 18, 3 },		//TEN
+				{ 1, 5, 10, 9, 2 },			//ELEVEN
+				{ 14, 16, 17, 12, 11 }		//TWELVE
+			};
+			for (int i = 0; i < MAX; i++)
+			{
+				faceNormals[i] = PolygonNormal(localVerts, faceVerts[i], 5);
+			}
+		}
+
+		float GetEdgeLength() const { return edgeLength; }
+		float GetRadius() const { return radius; }
+
+		//NB: this support function is particular to this mesh's orientation
+		Maths::Vector3 Support(const Maths::Vector3& dir, const NCL::CSC8503::Transform& tr) const override
+		{
+			Vector3 localDir = tr.GetOrientation().Conjugate() * dir;
+			int index = supportTable.HillClimb(localDir);
+			return tr.GetOrientation() * localVerts[index] + tr.GetPosition();
+		}
+
+		short GetFaceResult(const NCL::CSC8503::Transform& tr) const
+		{
+			Vector3 upLocalised = tr.GetOrientation().Conjugate() * Vector3(0, 1, 0);
+			return faceLookup.Find(upLocalised) + 1;
+		}
+
+	protected:
+		static const int VERT_COUNT = 20;
+
+		float	edgeLength;
+		float	radius;
+		Vector3 localVerts[VERT_COUNT];
+		Vector3 faceNormals[MAX];
+		SupportTable<VERT_COUNT>	supportTable;
+		FaceLookup<MAX>				faceLookup;
+	};
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "CollisionVolume.h"
+#include "SupportTable.h"
 
 namespace NCL {
 	class D20Volume : CollisionVolume
@@ -52,6 +53,8 @@ namespace NCL {
 			localVerts[11] = { -0.5f * edgeLength,-halfGoldRatio * edgeLength,0.0f };
 
 			SetFaceNormals();
+			supportTable.Build(localVerts);
+			supportTable.BuildNeighbours(localVerts, edgeLength);
 		}
 		~D20Volume() {}
 
@@ -84,18 +87,8 @@ namespace NCL {
 		//NB: while the d20 is a regular icosahedron, this support function is particular to this mesh's orientation. 
 		Maths::Vector3 Support(const Maths::Vector3& dir, const NCL::CSC8503::Transform& tr) const override
 		{
-			Vector3 localDir = (tr.GetOrientation().Conjugate() * dir).Normalised();
-			float dotMax = FLT_MIN;
-			int index = -1;
-			for (int i = 0; i < 12; i++)
-			{
-				float currentDot = Vector3::Dot(localDir, localVerts[i].Normalised());
-				if (currentDot > dotMax)
-				{
-					dotMax = currentDot;
-					index = i;
-				}
-			}
+			Vector3 localDir = tr.GetOrientation().Conjugate() * dir;
+			int index = supportTable.HillClimb(localDir);
 			return tr.GetOrientation() * localVerts[index] + tr.GetPosition();
 
 		}
@@ -121,6 +114,7 @@ namespace NCL {
 	protected:
 		Vector3 localVerts[12];
 		Vector3 faceNormals[20];
+		SupportTable<12> supportTable;
 		float edgeLength;
 		//the golden ratio is used here to work out where the vertices are. It's halved, because the whole golden ratio works for an edge length of 2, not 1
 		float halfGoldRatio = (1.0f + sqrt(5.0f)) / 2.0f / 2.0f;		
@@ -1,5 +1,6 @@
 #pragma once
 #include "CollisionVolume.h"
+#include "SupportTable.h"
 
 namespace NCL {
 	class D4Volume : CollisionVolume
@@ -24,6 +25,7 @@ namespace NCL {
 			localVerts[FOUR] = Matrix4::Rotation(270 - (60 * (1-ratioOfHeightAboveOrigin)), rotatedZ) * localVerts[ONE];
 			rotatedZ = Matrix4::Rotation(120, { 0,1,0 }) * rotatedZ;
 			localVerts[TWO] = Matrix4::Rotation(270 - (60 * (1 - ratioOfHeightAboveOrigin)), rotatedZ) * localVerts[ONE];
+			supportTable.Build(localVerts);
 		}
 		~D4Volume() {}
 
@@ -33,35 +35,16 @@ namespace NCL {
 		/*NOTE: while the d4 shape is a tetrahedron, this support point is specific to this mesh and its orientation, and not general to all tetrahedra*/
 		Maths::Vector3 Support(const Maths::Vector3& dir, const NCL::CSC8503::Transform& tr) const override
 		{
-			Vector3 localDir = (tr.GetOrientation().Conjugate() * dir).Normalised();
-			float dotMax = FLT_MIN;
-			int index = -1;
-			for (int i = 0; i < 4; i++)
-			{
-				if (Vector3::Dot(localDir, localVerts[i].Normalised()) > dotMax)
-				{
-					dotMax = Vector3::Dot(localDir, localVerts[i].Normalised());
-					index = i;
-				}
-			}
+			Vector3 localDir = tr.GetOrientation().Conjugate() * dir;
+			int index = supportTable.ArgMax(localDir);
 			return tr.GetOrientation() * localVerts[index] + tr.GetPosition();
 
 		}
 
 		short GetCornerResult(const NCL::CSC8503::Transform& tr) const
 		{
-			Vector3 localUp = (tr.GetOrientation().Conjugate() * Vector3(0,1,0)).Normalised();
-			float dotMax = FLT_MIN;
-			int index = -1;
-			for (int i = 0; i < MAX; i++)
-			{
-				if (Vector3::Dot(localUp, localVerts[i].Normalised()) > dotMax)
-				{
-					dotMax = Vector3::Dot(localUp, localVerts[i].Normalised());
-					index = i;
-				}
-			}
-			return index + 1;
+			Vector3 localUp = tr.GetOrientation().Conjugate() * Vector3(0,1,0);
+			return supportTable.ArgMax(localUp) + 1;
 
 		}
 		
@@ -69,5 +52,6 @@ namespace NCL {
 		float height;
 		float ratioOfHeightAboveOrigin = 0.7;
 		Vector3 localVerts[MAX];
+		SupportTable<MAX> supportTable;
 	};
 }
\ No newline at end of file
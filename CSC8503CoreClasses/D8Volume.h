@@ -1,5 +1,6 @@
 #pragma once
 #include "CollisionVolume.h"
+#include "SupportTable.h"
 
 namespace NCL {
 	class D8Volume : CollisionVolume
@@ -31,6 +32,7 @@ namespace NCL {
 			localVerts[4] = { 0,0,height };
 			localVerts[5] = { 0,0,-height };
 			SetFaceNormals();
+			supportTable.Build(localVerts);
 		}
 		~D8Volume() {}
 
@@ -51,17 +53,8 @@ namespace NCL {
 		/*NOTE: while the d8 shape is an octohedron, this support point is specific to this mesh and its orientation, and not general to all octohedra*/
 		Maths::Vector3 Support(const Maths::Vector3& dir, const NCL::CSC8503::Transform& tr) const override
 		{
-			Vector3 localDir = (tr.GetOrientation().Conjugate() * dir).Normalised();
-			float dotMax = FLT_MIN;
-			int index = -1;
-			for (int i = 0; i < 6; i++)
-			{
-				if (Vector3::Dot(localDir, localVerts[i].Normalised()) > dotMax)
-				{
-					dotMax = Vector3::Dot(localDir, localVerts[i].Normalised());
-					index = i;
-				}
-			}
+			Vector3 localDir = tr.GetOrientation().Conjugate() * dir;
+			int index = supportTable.ArgMax(localDir);
 			return tr.GetOrientation() * localVerts[index] + tr.GetPosition();
 
 		}
@@ -88,6 +81,7 @@ namespace NCL {
 		float height;
 		Vector3 localVerts[6];
 		Vector3 faceNormals[8];
+		SupportTable<6> supportTable;
 
 	};
 }
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "DiceRollFarm.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+DiceRollFarm::DiceRollFarm(int workerCount) {
+	if (workerCount <= 0) {
+		workerCount = std::max(1, (int)std::thread::hardware_concurrency());
+	}
+	workers.resize(workerCount);
+	for (Worker& w : workers) {
+		w.simulator = new DiceSimulator();
+	}
+	for (int i = 0; i < DiceSimulator::MAX; i++) {
+		diceInRoll[i] = true;
+	}
+	ClearHistograms(histograms);
+}
+
+DiceRollFarm::~DiceRollFarm() {
+	for (Worker& w : workers) {
+		delete w.simulator;
+	}
+}
+
+void DiceRollFarm::ClearHistograms(Histogram* h) {
+	for (int i = 0; i < DiceSimulator::MAX; i++) {
+		h[i].counts.assign(DiceSimulator::GetFaceCount((DiceSimulator::DiceType)i), 0);
+		h[i].total		= 0;
+		h[i].unsettled	= 0;
+		h[i].escaped	= 0;
+	}
+}
+
+/*
+A splitmix-style mix of the farm seed and roll index, so that neighbouring
+rolls get unrelated seeds, and roll n always gets the same seed no matter
+which worker picks it up.
+*/
+unsigned int DiceRollFarm::RollSeed(unsigned int farmSeed, int rollIndex) {
+	uint64_t z = ((uint64_t)farmSeed << 32) + (uint64_t)rollIndex + 0x9E3779B97F4A7C15ull;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	z = z ^ (z >> 31);
+	return (unsigned int)(z ^ (z >> 32));
+}
+
+void DiceRollFarm::Run(int rollCount, unsigned int seed, float maxRollTime) {
+	ClearHistograms(histograms);
+
+	int workerCount = (int)workers.size();
+	std::vector<std::thread> threads;
+	threads.reserve(workerCount);
+
+	//each worker gets a contiguous block of roll indices
+	for (int i = 0; i < workerCount; i++) {
+		int firstRoll	= (int)(((int64_t)rollCount * i) / workerCount);
+		int lastRoll	= (int)(((int64_t)rollCount * (i + 1)) / workerCount);
+		threads.emplace_back(&DiceRollFarm::RunWorker, this, std::ref(workers[i]), firstRoll, lastRoll, seed, maxRollTime);
+	}
+	for (std::thread& t : threads) {
+		t.join();
+	}
+
+	for (Worker& w : workers) {
+		for (int d = 0; d < DiceSimulator::MAX; d++) {
+			for (size_t f = 0; f < histograms[d].counts.size(); f++) {
+				histograms[d].counts[f] += w.histograms[d].counts[f];
+			}
+			histograms[d].total		+= w.histograms[d].total;
+			histograms[d].unsettled	+= w.histograms[d].unsettled;
+			histograms[d].escaped	+= w.histograms[d].escaped;
+		}
+	}
+}
+
+void DiceRollFarm::RunWorker(Worker& w, int firstRoll, int lastRoll, unsigned int seed, float maxRollTime) {
+	ClearHistograms(w.histograms);
+	for (int i = 0; i < DiceSimulator::MAX; i++) {
+		w.simulator->SetDiceInRoll((DiceSimulator::DiceType)i, diceInRoll[i]);
+	}
+
+	for (int roll = firstRoll; roll < lastRoll; roll++) {
+		w.simulator->Seed(RollSeed(seed, roll));
+		DiceSimulator::RollResult result = w.simulator->Roll(maxRollTime);
+
+		for (int d = 0; d < DiceSimulator::MAX; d++) {
+			if (!diceInRoll[d]) {
+				continue;
+			}
+			Histogram&	h		= w.histograms[d];
+			short		face	= result.faces[d];
+			if (!result.settled) {
+				h.unsettled++;
+			}
+			else if (!result.inTray[d]) {
+				h.escaped++;
+			}
+			else if (face >= 1 && face <= (short)h.counts.size()) {
+				h.counts[face - 1]++;
+				h.total++;
+			}
+		}
+	}
+}
+
+float DiceRollFarm::Histogram::ChiSquared() const {
+	if (total == 0 || counts.empty()) {
+		return 0.0f;
+	}
+	double expected = (double)total / counts.size();
+	double chi = 0.0;
+	for (int c : counts) {
+		double diff = c - expected;
+		chi += (diff * diff) / expected;
+	}
+	return (float)chi;
+}
+
+/*
+The chance of a fair die giving a chi-squared value at least this large.
+This uses the Wilson-Hilferty approximation, which turns the chi-squared
+distribution into a normal one - it's plenty accurate enough for the 3 to 19
+degrees of freedom our dice have.
+*/
+float DiceRollFarm::Histogram::PValue() const {
+	int k = DegreesOfFreedom();
+	if (k <= 0 || total == 0) {
+		return 1.0f;
+	}
+	double h = 2.0 / (9.0 * k);
+	double z = (std::cbrt(ChiSquared() / k) - (1.0 - h)) / std::sqrt(h);
+	return (float)(0.5 * std::erfc(z / std::sqrt(2.0)));
+}
+
+void DiceRollFarm::PrintResults(std::ostream& o) const {
+	static const char* names[DiceSimulator::MAX] = { "d4", "d6", "d8", "d10", "d12", "d20" };
+	for (int d = 0; d < DiceSimulator::MAX; d++) {
+		const Histogram& h = histograms[d];
+		if (h.total + h.unsettled + h.escaped == 0) {
+			continue;
+		}
+		o << names[d] << " (" << h.total << " rolls):";
+		for (size_t f = 0; f < h.counts.size(); f++) {
+			o << " " << (f + 1) << "=" << h.counts[f];
+		}
+		o << "\n\tchi-squared " << h.ChiSquared() << " (" << h.DegreesOfFreedom() << " dof), p = " << h.PValue()
+			<< " - excluded " << h.unsettled << " unsettled, " << h.escaped << " out of the tray\n";
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "DiceSimulator.h"
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		Runs a large number of headless rolls spread over several worker threads.
+		Each worker owns a whole DiceSimulator (and so its own GameWorld and
+		PhysicsSystem), and keeps its own tallies, which are only merged once
+		every worker has finished. Every roll is seeded from the farm seed and
+		its roll index, so the results don't depend on how many threads ran them.
+
+		Only dice that came to rest inside the tray are counted - a roll that
+		timed out, or a die that got thrown out of the tray, is tallied
+		separately instead, so that it can't skew the fairness test.
+		*/
+		class DiceRollFarm {
+		public:
+			struct Histogram
+			{
+				std::vector<int> counts;	//counts[0] is the number of times face 1 came up, and so on
+				int total = 0;
+
+				//rolls that were left out of the counts, as their face isn't a fair result
+				int unsettled	= 0;	//still moving when the roll gave up
+				int escaped		= 0;	//ended up outside of the tray
+
+				float	ChiSquared() const;
+				int		DegreesOfFreedom() const { return (int)counts.size() - 1; }
+				float	PValue() const;
+			};
+
+			DiceRollFarm(int workerCount = 0);
+			~DiceRollFarm();
+
+			void SetDiceInRoll(DiceSimulator::DiceType dice, bool state) {
+				diceInRoll[dice] = state;
+			}
+
+			void Run(int rollCount, unsigned int seed, float maxRollTime = 5.0f);
+
+			const Histogram& GetHistogram(DiceSimulator::DiceType dice) const {
+				return histograms[dice];
+			}
+
+			int GetWorkerCount() const {
+				return (int)workers.size();
+			}
+
+			void PrintResults(std::ostream& o) const;
+
+			static unsigned int RollSeed(unsigned int farmSeed, int rollIndex);
+
+		protected:
+			struct Worker
+			{
+				DiceSimulator*	simulator;
+				Histogram		histograms[DiceSimulator::MAX];
+			};
+
+			void ClearHistograms(Histogram* h);
+			void RunWorker(Worker& w, int firstRoll, int lastRoll, unsigned int seed, float maxRollTime);
+
+			std::vector<Worker> workers;
+			bool				diceInRoll[DiceSimulator::MAX];
+			Histogram			histograms[DiceSimulator::MAX];
+		};
+	}
+}
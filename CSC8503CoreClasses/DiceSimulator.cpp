@@ -0,0 +1,376 @@
+#include "DiceSimulator.h"
+#include "GameObject.h"
+#include "PhysicsObject.h"
+
+#include "D4Volume.h"
+#include "D6Volume.h"
+#include "D8Volume.h"
+#include "D10Volume.h"
+#include "D12Volume.h"
+#include "D20Volume.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	//the half size of the tray's floor, and how high up the tops of its walls are
+	const Vector3	trayDimensions	= { 10,2,10 };
+	const float		trayWallTop		= 10.0f;
+
+	//how bouncy the dice are against each other and the tray, and how quickly they lose speed
+	const float		diceElasticity	= 0.5f;
+	const float		diceDamping		= 2.0f;
+
+	//how slow a die has to be moving, and for how many substeps, before it can go to sleep
+	const float		diceRestLinear		= 0.15f;
+	const float		diceRestAngular		= 0.3f;
+	const int		diceRestSubsteps	= 20;
+}
+
+DiceSimulator::DiceSimulator(float frameDT, int substeps, BroadPhaseType broadPhase) {
+	world	= new GameWorld();
+	physics = new PhysicsSystem(*world, broadPhase);
+	physics->UseGravity(true);
+	physics->SetDeterministic(true);
+	InitRestThresholds(*physics);
+
+	this->frameDT	= frameDT;
+	this->substeps	= substeps;
+
+	//these match the positions the DiceRoller resets its dice to before a roll
+	diceStart[d4]	= { -5,5,-4 };
+	diceStart[d6]	= { -5,5,-2 };
+	diceStart[d8]	= { -5,5,0 };
+	diceStart[d20]	= { -5,5,2 };
+	diceStart[d10]	= { -5,5,4 };
+	diceStart[d12]	= { -5,5,6 };
+
+	for (int i = d4; i < MAX; i++) {
+		diceInRoll[i] = true;
+	}
+
+	InitWorld();
+}
+
+DiceSimulator::~DiceSimulator() {
+	world->ClearAndErase();
+	delete physics;
+	delete world;
+}
+
+void DiceSimulator::InitWorld() {
+	world->ClearAndErase();
+	physics->Clear();
+
+	InitDiceTray(*world);
+
+	rollingDice[d4]		= AddD4(*world, diceStart[d4], 1, 10);
+	rollingDice[d6]		= AddD6(*world, diceStart[d6], { 0.5,0.5,0.5 }, 10);
+	rollingDice[d8]		= AddD8(*world, diceStart[d8], 1, 10);
+	rollingDice[d10]	= AddD10(*world, diceStart[d10], 1, 10);
+	rollingDice[d12]	= AddD12(*world, diceStart[d12], 0.7f, 10);	//the d12 mesh has an edge length of 1, which makes it a lot bigger than the others
+	rollingDice[d20]	= AddD20(*world, diceStart[d20], 1, 10);
+
+	for (int i = d4; i < MAX; i++) {
+		InitRollingDice(rollingDice[i]);
+	}
+}
+
+/*
+A die bouncing around at the default elasticity and damping can still be
+tipping over from one face to the next after several seconds, and ones
+rocking on an edge, or leaning on another die, can hover just around the
+default rest thresholds without ever staying under them for long enough
+to go to sleep. Softer, more heavily damped dice, with slightly looser
+thresholds, settle nearly every roll well within the DiceSimulator's
+time limit, and the DiceRoller uses the same settings so the two agree.
+*/
+void DiceSimulator::InitRollingDice(GameObject* dice) {
+	dice->GetPhysicsObject()->SetElasticity(diceElasticity);
+	dice->GetPhysicsObject()->SetFrameLinearDampingCoeff(diceDamping);
+	dice->GetPhysicsObject()->SetFrameAngularDampingCoeff(diceDamping);
+}
+
+void DiceSimulator::InitRestThresholds(PhysicsSystem& physics) {
+	physics.SetRestThresholds(diceRestLinear, diceRestAngular, diceRestSubsteps);
+}
+
+/*
+Runs a single roll to completion: puts the dice back at the start, throws them
+the same way the DiceRoller does, then steps the physics at a fixed rate until
+every die has come to rest, or maxTime seconds of simulated time have passed.
+*/
+DiceSimulator::RollResult DiceSimulator::Roll(float maxTime) {
+	ResetDice();
+	ThrowDice();
+
+	RollResult result;
+	result.simTime = 0.0f;
+	result.settled = false;
+	physics->ResetStepHash();
+	while (result.simTime < maxTime) {
+		physics->FixedUpdate(frameDT, substeps);
+		result.simTime += frameDT;
+		if (DiceSettled()) {
+			result.settled = true;
+			break;
+		}
+	}
+
+	for (int i = d4; i < MAX; i++) {
+		result.faces[i]		= diceInRoll[i] ? GetResult((DiceType)i, rollingDice[i]) : 0;
+		result.inTray[i]	= !diceInRoll[i] || IsInTray(rollingDice[i]->GetTransform().GetPosition());
+	}
+	result.stateHash = physics->GetStepHash();
+	return result;
+}
+
+void DiceSimulator::ResetDice() {
+	physics->Clear();
+
+	//the tray will have gone to sleep during the last roll - waking it puts every roll back to the same starting point
+	world->OperateOnContents(
+		[](GameObject* o) {
+			o->GetPhysicsObject()->Wake();
+		}
+	);
+
+	for (int i = d4; i < MAX; i++) {
+		GameObject* dice = rollingDice[i];
+		dice->GetTransform()
+			.SetPosition(diceStart[i])
+			.SetOrientation(Quaternion());
+
+		PhysicsObject* object = dice->GetPhysicsObject();
+		object->SetLinearVelocity({ 0,0,0 });
+		object->SetAngularVelocity({ 0,0,0 });
+		object->ClearForces();
+		object->Wake();
+
+		dice->SetActive(diceInRoll[i]);
+		object->useGravity = diceInRoll[i];
+	}
+}
+
+void DiceSimulator::ThrowDice() {
+	for (int i = d4; i < MAX; i++) {
+		if (!rollingDice[i]->IsActive()) {
+			continue;
+		}
+		//random torque, and +/- 40 degrees from positive x direction
+		rollingDice[i]->GetPhysicsObject()->AddTorque({ world->RandomValue(0,50), world->RandomValue(0,50),world->RandomValue(0,50) });
+		Vector3 roll = Matrix4::Rotation(world->RandomValue(-40, 40), { 0,1,0 }) * Vector3(1, 0, 0) * 200;
+		rollingDice[i]->GetPhysicsObject()->AddForce(roll);
+	}
+}
+
+bool DiceSimulator::DiceSettled() const {
+	for (int i = d4; i < MAX; i++) {
+		if (diceInRoll[i] && !rollingDice[i]->GetPhysicsObject()->IsSettled()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+Whether a die's centre is between the tray's walls, above its floor, and
+no higher than the tops of the walls. A die sat on top of a wall, or that
+has fallen off the edge of the floor, isn't in the tray, and whatever face
+it shows isn't a result.
+*/
+bool DiceSimulator::IsInTray(const Vector3& position) {
+	return	std::abs(position.x) < trayDimensions.x - 1.0f &&
+			std::abs(position.z) < trayDimensions.z - 1.0f &&
+			position.y > 0.0f &&
+			position.y < trayWallTop;
+}
+
+int DiceSimulator::GetFaceCount(DiceType type) {
+	switch (type) {
+	case d4:	return 4;
+	case d6:	return 6;
+	case d8:	return 8;
+	case d10:	return 10;
+	case d12:	return 12;
+	case d20:	return 20;
+	}
+	return 0;
+}
+
+short DiceSimulator::GetResult(DiceType type, GameObject* dice) {
+	const CollisionVolume* volume = dice->GetBoundingVolume();
+	switch (type) {
+	case d4:	return ((D4Volume*)volume)->GetCornerResult(dice->GetTransform());
+	case d6:	return ((D6Volume*)volume)->GetFaceResult(dice->GetTransform());
+	case d8:	return ((D8Volume*)volume)->GetFaceResult(dice->GetTransform());
+	case d10:	return ((D10Volume*)volume)->GetFaceResult(dice->GetTransform());
+	case d12:	return ((D12Volume*)volume)->GetFaceResult(dice->GetTransform());
+	case d20:	return ((D20Volume*)volume)->GetFaceResult(dice->GetTransform());
+	}
+	return 0;
+}
+
+GameObject* DiceSimulator::AddD4(GameWorld& world, const Vector3& position, float height, float inverseMass) {
+	GameObject* d4 = new GameObject();
+	D4Volume* volume = new D4Volume(height);
+
+	Vector3 d4Size = Vector3(height, height, height);
+	d4->SetBoundingVolume((CollisionVolume*)volume);
+
+	d4->GetTransform()
+		.SetScale(d4Size)
+		.SetPosition(position);
+
+	d4->SetPhysicsObject(new PhysicsObject(&d4->GetTransform(), d4->GetBoundingVolume()));
+	d4->GetPhysicsObject()->SetInverseMass(inverseMass);
+	d4->GetPhysicsObject()->InitSphereInertia();
+	world.AddGameObject(d4);
+	return d4;
+}
+
+GameObject* DiceSimulator::AddD6(GameWorld& world, const Vector3& position, Vector3 dimensions, float inverseMass) {
+	GameObject* d6 = new GameObject();
+	D6Volume* volume = new D6Volume(dimensions);
+	d6->SetBoundingVolume((CollisionVolume*)volume);
+
+	d6->GetTransform()
+		.SetPosition(position)
+		//this adjustment here is due to the size of the d6 mesh: its base has side length sqrt(2), so multiplying it by sqrt(2)/2 gets us back to 1
+		.SetScale(dimensions * (sqrt(2) / 2) * 2);
+
+	d6->SetPhysicsObject(new PhysicsObject(&d6->GetTransform(), d6->GetBoundingVolume()));
+	d6->GetPhysicsObject()->SetInverseMass(inverseMass);
+	d6->GetPhysicsObject()->InitCubeInertia();
+	world.AddGameObject(d6);
+	return d6;
+}
+
+GameObject* DiceSimulator::AddD8(GameWorld& world, const Vector3& position, float height, float inverseMass) {
+	GameObject* d8 = new GameObject();
+	D8Volume* volume = new D8Volume(height);
+
+	Vector3 d8Size = Vector3(height, height, height);
+	d8->SetBoundingVolume((CollisionVolume*)volume);
+
+	d8->GetTransform()
+		.SetScale(d8Size)
+		.SetPosition(position);
+
+	d8->SetPhysicsObject(new PhysicsObject(&d8->GetTransform(), d8->GetBoundingVolume()));
+	d8->GetPhysicsObject()->SetInverseMass(inverseMass);
+	d8->GetPhysicsObject()->InitSphereInertia();
+	world.AddGameObject(d8);
+	return d8;
+}
+
+GameObject* DiceSimulator::AddD10(GameWorld& world, const Vector3& position, float height, float inverseMass) {
+	GameObject* d10 = new GameObject();
+	D10Volume* volume = new D10Volume(height);
+
+	Vector3 d10Size = Vector3(height, height, height);
+	d10->SetBoundingVolume((CollisionVolume*)volume);
+
+	d10->GetTransform()
+		.SetScale(d10Size)
+		.SetPosition(position);
+
+	d10->SetPhysicsObject(new PhysicsObject(&d10->GetTransform(), d10->GetBoundingVolume()));
+	d10->GetPhysicsObject()->SetInverseMass(inverseMass);
+	d10->GetPhysicsObject()->InitSphereInertia();
+	world.AddGameObject(d10);
+	return d10;
+}
+
+GameObject* DiceSimulator::AddD12(GameWorld& world, const Vector3& position, float edgeLength, float inverseMass) {
+	GameObject* d12 = new GameObject();
+	D12Volume* volume = new D12Volume(edgeLength);
+
+	Vector3 d12Size = Vector3(edgeLength, edgeLength, edgeLength);
+	d12->SetBoundingVolume((CollisionVolume*)volume);
+
+	d12->GetTransform()
+		.SetScale(d12Size)
+		.SetPosition(position);
+
+	d12->SetPhysicsObject(new PhysicsObject(&d12->GetTransform(), d12->GetBoundingVolume()));
+	d12->GetPhysicsObject()->SetInverseMass(inverseMass);
+	d12->GetPhysicsObject()->InitSphereInertia();
+	world.AddGameObject(d12);
+	return d12;
+}
+
+GameObject* DiceSimulator::AddD20(GameWorld& world, const Vector3& position, float height, float inverseMass) {
+	GameObject* d20 = new GameObject();
+	D20Volume* volume = new D20Volume(height);
+
+	Vector3 d20Size = Vector3(height, height, height);
+	d20->SetBoundingVolume((CollisionVolume*)volume);
+
+	d20->GetTransform()
+		.SetScale(d20Size)
+		.SetPosition(position);
+
+	d20->SetPhysicsObject(new PhysicsObject(&d20->GetTransform(), d20->GetBoundingVolume()));
+	d20->GetPhysicsObject()->SetInverseMass(inverseMass);
+	d20->GetPhysicsObject()->InitSphereInertia();
+	world.AddGameObject(d20);
+	return d20;
+}
+
+GameObject* DiceSimulator::AddCube(GameWorld& world, const Vector3& position, Vector3 dimensions, float inverseMass) {
+	GameObject* cube = new GameObject();
+
+	AABBVolume* volume = new AABBVolume(dimensions);
+	cube->SetBoundingVolume((CollisionVolume*)volume);
+
+	cube->GetTransform()
+		.SetPosition(position)
+		.SetScale(dimensions * 2);
+
+	cube->SetPhysicsObject(new PhysicsObject(&cube->GetTransform(), cube->GetBoundingVolume()));
+	cube->GetPhysicsObject()->SetInverseMass(inverseMass);
+	cube->GetPhysicsObject()->InitCubeInertia();
+	world.AddGameObject(cube);
+	return cube;
+}
+
+GameObject* DiceSimulator::AddFloor(GameWorld& world, const Vector3& position, const Vector3& dimensions) {
+	GameObject* floor = new GameObject();
+
+	AABBVolume* volume = new AABBVolume(dimensions);
+	floor->SetBoundingVolume((CollisionVolume*)volume);
+	floor->GetTransform()
+		.SetScale(dimensions * 2)
+		.SetPosition(position);
+
+	floor->SetPhysicsObject(new PhysicsObject(&floor->GetTransform(), floor->GetBoundingVolume()));
+	floor->SetCollisionLayer(staticObj);
+
+	floor->GetPhysicsObject()->SetInverseMass(0);
+	floor->GetPhysicsObject()->InitCubeInertia();
+	world.AddGameObject(floor);
+	return floor;
+}
+
+/*
+The tray is a floor with four walls around it. The pieces are handed back so
+that anything drawing the tray can hang its render objects off them.
+
+The walls run from the bottom of the floor up to trayWallTop, which is high
+enough that a die bouncing off one goes back into the tray rather than over
+the top - a lid would stop them too, but it would also hide the dice from
+the DiceRoller's camera.
+*/
+std::vector<GameObject*> DiceSimulator::InitDiceTray(GameWorld& world) {
+	std::vector<GameObject*> tray;
+	Vector3 dimensions	= trayDimensions;
+	float	wallHeight	= (trayWallTop + dimensions.y) * 0.5f;
+	float	wallMiddle	= trayWallTop - wallHeight;
+	tray.push_back(AddFloor(world, { 0,0,0 }, dimensions));
+	tray.push_back(AddCube(world, { 0,wallMiddle,dimensions.z - 1.0f }, { dimensions.x,wallHeight,1 }, 0));
+	tray.push_back(AddCube(world, { 0,wallMiddle,-dimensions.z + 1.0f }, { dimensions.x,wallHeight,1 }, 0));
+	tray.push_back(AddCube(world, { dimensions.x - 1.0f,wallMiddle,0 }, { 1,wallHeight,dimensions.z }, 0));
+	tray.push_back(AddCube(world, { -dimensions.x + 1.0f,wallMiddle,0 }, { 1,wallHeight,dimensions.z }, 0));
+	return tray;
+}
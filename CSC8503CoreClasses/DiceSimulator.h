@@ -0,0 +1,98 @@
+#pragma once
+#include "GameWorld.h"
+#include "PhysicsSystem.h"
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		A headless version of the DiceRoller: it builds the same dice tray and
+		rolling dice, but without a window, renderer or any input, and steps
+		the physics at a fixed rate. This lets us roll dice as fast as the CPU
+		can manage, on machines that don't even have a display.
+		*/
+		class DiceSimulator {
+		public:
+			enum DiceType
+			{
+				d4,
+				d6,
+				d8,
+				d10,
+				d12,
+				d20,
+				MAX
+			};
+
+			struct RollResult
+			{
+				short	faces[MAX];	//0 for any dice that weren't part of the roll
+				float	simTime;
+				bool	settled;	//false if we gave up at maxTime with something still moving
+				bool	inTray[MAX];	//false for any dice that have ended up outside of the tray
+				uint64_t	stateHash;	//the physics step hash at the end of the roll - the same seed always gives the same hash
+			};
+
+			DiceSimulator(float frameDT = 1.0f / 60.0f, int substeps = 2, BroadPhaseType broadPhase = BroadPhaseType::Tree);
+			~DiceSimulator();
+
+			void SetDiceInRoll(DiceType dice, bool state) {
+				diceInRoll[dice] = state;
+			}
+
+			bool IsDiceInRoll(DiceType dice) const {
+				return diceInRoll[dice];
+			}
+
+			void Seed(unsigned int seed) {
+				world->Seed(seed);
+			}
+
+			RollResult Roll(float maxTime = 5.0f);
+
+			GameWorld& GetWorld() {
+				return *world;
+			}
+
+			PhysicsSystem& GetPhysics() {
+				return *physics;
+			}
+
+			//the factories are shared with the DiceRoller, which adds its render objects on top
+			static GameObject* AddFloor(GameWorld& world, const Vector3& position, const Vector3& dimensions);
+			static GameObject* AddCube(GameWorld& world, const Vector3& position, Vector3 dimensions, float inverseMass = 10.0f);
+			static GameObject* AddD4(GameWorld& world, const Vector3& position, float height, float inverseMass = 10.0f);
+			static GameObject* AddD6(GameWorld& world, const Vector3& position, Vector3 dimensions, float inverseMass = 10.0f);
+			static GameObject* AddD8(GameWorld& world, const Vector3& position, float height, float inverseMass = 10.0f);
+			static GameObject* AddD10(GameWorld& world, const Vector3& position, float height, float inverseMass = 10.0f);
+			static GameObject* AddD12(GameWorld& world, const Vector3& position, float edgeLength, float inverseMass = 10.0f);
+			static GameObject* AddD20(GameWorld& world, const Vector3& position, float height, float inverseMass = 10.0f);
+
+			static std::vector<GameObject*> InitDiceTray(GameWorld& world);
+
+			//the bounce, damping and sleep settings that let a roll settle in a few seconds
+			static void InitRollingDice(GameObject* dice);
+			static void InitRestThresholds(PhysicsSystem& physics);
+
+			static bool IsInTray(const Vector3& position);
+
+			static short GetResult(DiceType type, GameObject* dice);
+			static int GetFaceCount(DiceType type);
+
+		protected:
+			void InitWorld();
+			void ResetDice();
+			void ThrowDice();
+			bool DiceSettled() const;
+
+			GameWorld*		world;
+			PhysicsSystem*	physics;
+
+			float	frameDT;
+			int		substeps;
+
+			bool		diceInRoll[MAX];
+			GameObject* rollingDice[MAX];
+			Vector3		diceStart[MAX];
+		};
+	}
+}
@@ -0,0 +1,373 @@
+#pragma once
+#include "Vector3.h"
+#include <cassert>
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		/*
+		A bounding volume hierarchy that is kept around between physics updates,
+		rather than being built from scratch every time like the QuadTree is.
+
+		Every object gets a 'proxy' leaf, holding a box that's a little bigger
+		than the object really is (and stretched out in the direction it's
+		moving). As long as the object stays inside that fattened box, the tree
+		doesn't have to change at all - only when something moves out of its box
+		is its leaf pulled out and put back in again. Internal nodes always have
+		exactly 2 children, and the tree is kept balanced using AVL-style
+		rotations as leaves are added and removed.
+
+		All of the nodes live in a single array, with freed nodes chained
+		together for reuse, so once the tree has reached the size of the scene,
+		moving things around in it doesn't allocate any memory.
+		*/
+		template<class T>
+		class DynamicAABBTree {
+		public:
+			DynamicAABBTree(float margin = 0.1f, float velocityScale = 2.0f) {
+				this->margin		= margin;
+				this->velocityScale	= velocityScale;
+				Clear();
+			}
+			~DynamicAABBTree() {
+			}
+
+			void Clear() {
+				nodes.clear();
+				root		= NullNode;
+				freeList	= NullNode;
+				leafCount	= 0;
+			}
+
+			//returns the proxy for the new leaf, which is used to move or remove it later
+			int Insert(T object, const Vector3& pos, const Vector3& halfSize) {
+				int leaf = AllocateNode();
+				nodes[leaf].object	= object;
+				nodes[leaf].min		= pos - halfSize - Vector3(margin, margin, margin);
+				nodes[leaf].max		= pos + halfSize + Vector3(margin, margin, margin);
+				nodes[leaf].height	= 0;
+				InsertLeaf(leaf);
+				leafCount++;
+				return leaf;
+			}
+
+			void Remove(int proxy) {
+				RemoveLeaf(proxy);
+				FreeNode(proxy);
+				leafCount--;
+			}
+
+			/*
+			Returns false if the object is still inside its fattened box, and so
+			the tree didn't need to change. Otherwise, a new box is made for it,
+			extended along its displacement so that it'll hopefully fit inside it
+			for a few more updates, and the leaf is reinserted.
+			*/
+			bool Move(int proxy, const Vector3& pos, const Vector3& halfSize, const Vector3& displacement) {
+				Vector3 min = pos - halfSize;
+				Vector3 max = pos + halfSize;
+
+				Node& n = nodes[proxy];
+				if (n.min.x <= min.x && n.min.y <= min.y && n.min.z <= min.z &&
+					n.max.x >= max.x && n.max.y >= max.y && n.max.z >= max.z) {
+					return false;
+				}
+				RemoveLeaf(proxy);
+
+				Vector3 fatMin = min - Vector3(margin, margin, margin);
+				Vector3 fatMax = max + Vector3(margin, margin, margin);
+				Vector3 d = displacement * velocityScale;
+				for (int i = 0; i < 3; ++i) {
+					if (d[i] < 0.0f) {
+						fatMin[i] += d[i];
+					}
+					else {
+						fatMax[i] += d[i];
+					}
+				}
+				nodes[proxy].min = fatMin;
+				nodes[proxy].max = fatMax;
+				InsertLeaf(proxy);
+				return true;
+			}
+
+			//calls func(object, proxy) on every leaf whose fattened box overlaps the given box
+			template<class F>
+			void Query(const Vector3& min, const Vector3& max, F func) const {
+				if (root == NullNode) {
+					return;
+				}
+				/*
+				The stack never holds more than one node per level of the tree,
+				plus one, so it only has to come off the heap for a tree far
+				deeper than a balanced one over any real scene would ever be.
+				*/
+				int					fixedStack[64];
+				std::vector<int>	heapStack;
+				int*				stack		= fixedStack;
+				int					stackLimit	= nodes[root].height + 2;
+				if (stackLimit > 64) {
+					heapStack.resize(stackLimit);
+					stack = heapStack.data();
+				}
+				int stackSize = 0;
+				stack[stackSize++] = root;
+				while (stackSize > 0) {
+					const Node& n = nodes[stack[--stackSize]];
+					if (!Overlaps(n.min, n.max, min, max)) {
+						continue;
+					}
+					if (n.IsLeaf()) {
+						func(n.object, (int)(&n - nodes.data()));
+					}
+					else {
+						assert(stackSize + 2 <= stackLimit);
+						stack[stackSize++] = n.children[0];
+						stack[stackSize++] = n.children[1];
+					}
+				}
+			}
+
+			void GetFatAABB(int proxy, Vector3& min, Vector3& max) const {
+				min = nodes[proxy].min;
+				max = nodes[proxy].max;
+			}
+
+			T GetObject(int proxy) const {
+				return nodes[proxy].object;
+			}
+
+			int GetLeafCount() const {
+				return leafCount;
+			}
+
+			int GetHeight() const {
+				return root == NullNode ? 0 : nodes[root].height;
+			}
+
+		protected:
+			static const int NullNode = -1;
+
+			struct Node {
+				Vector3 min;
+				Vector3 max;
+				T		object;
+				int		parent;			//doubles as the next link while a node is on the free list
+				int		children[2];
+				int		height;			//0 for leaves, -1 for free nodes
+
+				bool IsLeaf() const {
+					return children[0] == NullNode;
+				}
+			};
+
+			static bool Overlaps(const Vector3& minA, const Vector3& maxA, const Vector3& minB, const Vector3& maxB) {
+				return	minA.x <= maxB.x && maxA.x >= minB.x &&
+						minA.y <= maxB.y && maxA.y >= minB.y &&
+						minA.z <= maxB.z && maxA.z >= minB.z;
+			}
+
+			static Vector3 Min(const Vector3& a, const Vector3& b) {
+				return Vector3(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+			}
+
+			static Vector3 Max(const Vector3& a, const Vector3& b) {
+				return Vector3(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+			}
+
+			//half the surface area, which is all the insertion cost heuristic needs
+			static float Area(const Vector3& min, const Vector3& max) {
+				Vector3 d = max - min;
+				return d.x * d.y + d.y * d.z + d.z * d.x;
+			}
+
+			int AllocateNode() {
+				int id;
+				if (freeList != NullNode) {
+					id = freeList;
+					freeList = nodes[id].parent;
+				}
+				else {
+					id = (int)nodes.size();
+					nodes.emplace_back();
+				}
+				Node& n = nodes[id];
+				n.parent		= NullNode;
+				n.children[0]	= NullNode;
+				n.children[1]	= NullNode;
+				n.height		= 0;
+				return id;
+			}
+
+			void FreeNode(int id) {
+				nodes[id].parent = freeList;
+				nodes[id].height = -1;
+				freeList = id;
+			}
+
+			void Refit(int id) {
+				Node& n = nodes[id];
+				const Node& a = nodes[n.children[0]];
+				const Node& b = nodes[n.children[1]];
+				n.min		= Min(a.min, b.min);
+				n.max		= Max(a.max, b.max);
+				n.height	= 1 + std::max(a.height, b.height);
+			}
+
+			/*
+			Walks down from the root, at each step picking whichever child would
+			grow the least (by surface area) to take the new leaf, stopping early
+			if making a brand new parent for the leaf and the current node would
+			be cheaper still.
+			*/
+			void InsertLeaf(int leaf) {
+				if (root == NullNode) {
+					root = leaf;
+					nodes[root].parent = NullNode;
+					return;
+				}
+				Vector3 leafMin = nodes[leaf].min;
+				Vector3 leafMax = nodes[leaf].max;
+
+				int index = root;
+				while (!nodes[index].IsLeaf()) {
+					const Node& n = nodes[index];
+					float area			= Area(n.min, n.max);
+					float combinedArea	= Area(Min(n.min, leafMin), Max(n.max, leafMax));
+
+					float cost			= 2.0f * combinedArea;
+					float inheritance	= 2.0f * (combinedArea - area);
+
+					float childCost[2];
+					for (int i = 0; i < 2; ++i) {
+						const Node& c = nodes[n.children[i]];
+						float grownArea = Area(Min(c.min, leafMin), Max(c.max, leafMax));
+						childCost[i] = c.IsLeaf() ? grownArea + inheritance : (grownArea - Area(c.min, c.max)) + inheritance;
+					}
+					if (cost < childCost[0] && cost < childCost[1]) {
+						break;
+					}
+					index = childCost[0] < childCost[1] ? n.children[0] : n.children[1];
+				}
+
+				int sibling		= index;
+				int oldParent	= nodes[sibling].parent;
+				int newParent	= AllocateNode();
+				nodes[newParent].parent			= oldParent;
+				nodes[newParent].children[0]	= sibling;
+				nodes[newParent].children[1]	= leaf;
+				nodes[sibling].parent	= newParent;
+				nodes[leaf].parent		= newParent;
+
+				if (oldParent == NullNode) {
+					root = newParent;
+				}
+				else if (nodes[oldParent].children[0] == sibling) {
+					nodes[oldParent].children[0] = newParent;
+				}
+				else {
+					nodes[oldParent].children[1] = newParent;
+				}
+				FixUpwards(newParent);
+			}
+
+			void RemoveLeaf(int leaf) {
+				if (leaf == root) {
+					root = NullNode;
+					return;
+				}
+				int parent		= nodes[leaf].parent;
+				int grandParent	= nodes[parent].parent;
+				int sibling		= nodes[parent].children[0] == leaf ? nodes[parent].children[1] : nodes[parent].children[0];
+
+				//the sibling takes the parent's place, and the parent goes back on the free list
+				if (grandParent == NullNode) {
+					root = sibling;
+					nodes[sibling].parent = NullNode;
+				}
+				else {
+					if (nodes[grandParent].children[0] == parent) {
+						nodes[grandParent].children[0] = sibling;
+					}
+					else {
+						nodes[grandParent].children[1] = sibling;
+					}
+					nodes[sibling].parent = grandParent;
+					FixUpwards(grandParent);
+				}
+				FreeNode(parent);
+			}
+
+			void FixUpwards(int index) {
+				while (index != NullNode) {
+					index = Balance(index);
+					Refit(index);
+					index = nodes[index].parent;
+				}
+			}
+
+			/*
+			If one side of node 'a' is more than a level taller than the other, the
+			taller child is rotated up into a's place, and the taller of its own
+			children is handed down to a. Returns whichever node ends up where a was.
+			*/
+			int Balance(int a) {
+				Node& A = nodes[a];
+				if (A.IsLeaf() || A.height < 2) {
+					return a;
+				}
+				int b = A.children[0];
+				int c = A.children[1];
+				int balance = nodes[c].height - nodes[b].height;
+
+				if (balance > 1) {
+					return Rotate(a, 1);
+				}
+				if (balance < -1) {
+					return Rotate(a, 0);
+				}
+				return a;
+			}
+
+			int Rotate(int a, int tallSide) {
+				int up		= nodes[a].children[tallSide];
+				int f		= nodes[up].children[0];
+				int g		= nodes[up].children[1];
+
+				//'up' takes a's place in the tree
+				nodes[up].children[0]	= a;
+				nodes[up].parent		= nodes[a].parent;
+				nodes[a].parent			= up;
+
+				if (nodes[up].parent == NullNode) {
+					root = up;
+				}
+				else if (nodes[nodes[up].parent].children[0] == a) {
+					nodes[nodes[up].parent].children[0] = up;
+				}
+				else {
+					nodes[nodes[up].parent].children[1] = up;
+				}
+
+				//the taller grandchild stays with 'up', the shorter one goes to a
+				int keep = nodes[f].height > nodes[g].height ? f : g;
+				int give = keep == f ? g : f;
+				nodes[up].children[1]		= keep;
+				nodes[a].children[tallSide]	= give;
+				nodes[give].parent			= a;
+
+				Refit(a);
+				Refit(up);
+				return up;
+			}
+
+			std::vector<Node>	nodes;
+			int					root;
+			int					freeList;
+			int					leafCount;
+
+			float margin;			//how much bigger than the object its leaf box is
+			float velocityScale;	//how far ahead of a moving object its leaf box reaches
+		};
+	}
+}
@@ -0,0 +1,158 @@
+#pragma once
+#include "Vector3.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+
+namespace NCL {
+	/*
+	Works out which face of a die points the most in a given direction,
+	without trying every face. The sphere of directions is split up like a
+	cube map - 6 sides of RES x RES cells - and each cell knows the few faces
+	that win anywhere inside it. Finding the face is then a matter of working
+	out the cell, and comparing that cell's handful of candidates, however
+	many faces the die has.
+
+	Candidates are found by sampling each cell, and keeping any face that
+	comes within a margin of the best one at any sample. The margin covers
+	the furthest any direction in the cell can be from a sample, so no face
+	that could win is left out. Cells with more than MAX_CANDIDATES (which
+	shouldn't happen with a sensible RES) fall back to trying every face.
+
+	FACES is the most faces the lookup can hold. Shapes that only find out
+	how many faces they have at runtime, like the ConvexHullVolume, can
+	pass a smaller count to Build.
+	*/
+	template<int FACES>
+	class FaceLookup {
+	public:
+		static const int RES			= 16;
+		static const int MAX_CANDIDATES	= 6;
+
+		void Build(const Maths::Vector3* faceNormals, int count = FACES) {
+			const int	samples = 4;
+			const float margin	= 0.05f;	//a cell's samples are at most ~0.022 apart, and dots between unit normals can differ by at most double that
+
+			faceCount = std::min(count, FACES);
+			for (int i = 0; i < faceCount; ++i) {
+				normals[i] = faceNormals[i].Normalised();
+			}
+			for (int cell = 0; cell < 6 * RES * RES; ++cell) {
+				int side	= cell / (RES * RES);
+				int v		= (cell / RES) % RES;
+				int u		= cell % RES;
+
+				uint8_t count = 0;
+				bool	full = false;
+				for (int sv = 0; sv <= samples && !full; ++sv) {
+					for (int su = 0; su <= samples && !full; ++su) {
+						float fu = -1.0f + 2.0f * (u + (float)su / samples) / RES;
+						float fv = -1.0f + 2.0f * (v + (float)sv / samples) / RES;
+						Maths::Vector3 dir = CellDirection(side, fu, fv);
+
+						float best = -FLT_MAX;
+						for (int f = 0; f < faceCount; ++f) {
+							best = std::max(best, Maths::Vector3::Dot(dir, normals[f]));
+						}
+						for (int f = 0; f < faceCount && !full; ++f) {
+							if (Maths::Vector3::Dot(dir, normals[f]) < best - margin) {
+								continue;
+							}
+							bool known = false;
+							for (int c = 0; c < count; ++c) {
+								known |= (candidates[cell][c] == f);
+							}
+							if (known) {
+								continue;
+							}
+							if (count == MAX_CANDIDATES) {
+								full = true;
+								continue;
+							}
+							candidates[cell][count++] = (uint8_t)f;
+						}
+					}
+				}
+				candidateCount[cell] = full ? 0 : count;
+			}
+		}
+
+		//dir doesn't need to be normalised
+		int Find(const Maths::Vector3& dir) const {
+			int cell = CellIndex(dir);
+			int count = candidateCount[cell];
+			int best = 0;
+			float bestDot = -FLT_MAX;
+			if (count == 0) {
+				for (int f = 0; f < faceCount; ++f) {
+					float dot = Maths::Vector3::Dot(dir, normals[f]);
+					if (dot > bestDot) {
+						bestDot = dot;
+						best	= f;
+					}
+				}
+				return best;
+			}
+			for (int c = 0; c < count; ++c) {
+				int f = candidates[cell][c];
+				float dot = Maths::Vector3::Dot(dir, normals[f]);
+				//ties go to the lowest face, like the plain loop
+				if (dot > bestDot || (dot == bestDot && f < best)) {
+					bestDot = dot;
+					best	= f;
+				}
+			}
+			return best;
+		}
+
+	protected:
+		//side is the axis that's biggest in dir * 2, plus 1 if it's negative
+		static Maths::Vector3 CellDirection(int side, float u, float v) {
+			int		axis = side / 2;
+			float	sign = (side & 1) ? -1.0f : 1.0f;
+			Maths::Vector3 dir;
+			dir[axis]			= sign;
+			dir[(axis + 1) % 3] = u;
+			dir[(axis + 2) % 3] = v;
+			return dir.Normalised();
+		}
+
+		static int CellCoord(float f) {
+			int c = (int)((f + 1.0f) * 0.5f * RES);
+			return std::min(std::max(c, 0), RES - 1);
+		}
+
+		static int CellIndex(const Maths::Vector3& dir) {
+			float ax = std::abs(dir.x), ay = std::abs(dir.y), az = std::abs(dir.z);
+			int axis = (ax >= ay && ax >= az) ? 0 : (ay >= az ? 1 : 2);
+			float major = dir[axis];
+			if (major == 0.0f) {
+				return 0;
+			}
+			int side = axis * 2 + (major < 0.0f ? 1 : 0);
+			float scale = 1.0f / std::abs(major);
+			int u = CellCoord(dir[(axis + 1) % 3] * scale);
+			int v = CellCoord(dir[(axis + 2) % 3] * scale);
+			return (side * RES + v) * RES + u;
+		}
+
+		Maths::Vector3	normals[FACES];
+		int				faceCount;
+		uint8_t			candidates[6 * RES * RES][MAX_CANDIDATES];
+		uint8_t			candidateCount[6 * RES * RES];
+	};
+
+	//Newell's method, which copes with faces whose corners aren't quite in a plane
+	inline Maths::Vector3 PolygonNormal(const Maths::Vector3* verts, const int* indices, int count) {
+		Maths::Vector3 normal;
+		for (int i = 0; i < count; ++i) {
+			const Maths::Vector3& cur	= verts[indices[i]];
+			const Maths::Vector3& next	= verts[indices[(i + 1) % count]];
+			normal.x += (cur.y - next.y) * (cur.z + next.z);
+			normal.y += (cur.z - next.z) * (cur.x + next.x);
+			normal.z += (cur.x - next.x) * (cur.y + next.y);
+		}
+		return normal.Normalised();
+	}
+}
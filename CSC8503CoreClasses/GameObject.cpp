@@ -5,7 +5,10 @@
 #include "NetworkObject.h"
 #include "D4Volume.h"
 #include "D8Volume.h"
+#include "D10Volume.h"
+#include "D12Volume.h"
 #include "D20Volume.h"
+#include "ConvexHullVolume.h"
 
 using namespace NCL::CSC8503;
 
@@ -67,6 +70,17 @@ void GameObject::UpdateBroadphaseAABB() {
 		float sizes = ((D8Volume&)*boundingVolume).GetHeight();
 		broadphaseAABB = mat * Vector3(sizes, sizes, sizes);
 	}
+	else if (boundingVolume->type == VolumeType::D10_Dice)
+	{
+		//a sphere round every corner fits whichever way up the die is
+		float r = ((D10Volume&)*boundingVolume).GetRadius();
+		broadphaseAABB = Vector3(r, r, r);
+	}
+	else if (boundingVolume->type == VolumeType::D12_Dice)
+	{
+		float r = ((D12Volume&)*boundingVolume).GetRadius();
+		broadphaseAABB = Vector3(r, r, r);
+	}
 	else if (boundingVolume->type == VolumeType::D20_Dice)
 	{
 		Matrix3 mat = Matrix3(transform.GetOrientation());
@@ -74,4 +88,9 @@ void GameObject::UpdateBroadphaseAABB() {
 		float sizes = ((D20Volume&)*boundingVolume).GetEdgeLength() * 2;
 		broadphaseAABB = mat * Vector3(sizes, sizes, sizes);
 	}
+	else if (boundingVolume->type == VolumeType::Mesh)
+	{
+		float r = ((ConvexHullVolume&)*boundingVolume).GetRadius();
+		broadphaseAABB = Vector3(r, r, r);
+	}
 }
\ No newline at end of file
@@ -23,7 +23,7 @@ namespace NCL::CSC8503 {
 	class GameObject	{
 	public:
 		GameObject(const std::string& name = "", CollisionLayer layer = standard, bool useGravity = true);
-		~GameObject();
+		virtual ~GameObject();
 
 		void SetBoundingVolume(CollisionVolume* vol) {
 			boundingVolume = vol;
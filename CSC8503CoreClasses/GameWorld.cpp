@@ -63,21 +63,52 @@ void GameWorld::OperateOnContents(GameObjectFunc f) {
 	}
 }
 
-void GameWorld::UpdateWorld(float dt) {
-	auto rng = std::default_random_engine{};
-
-	unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-	std::default_random_engine e(seed);
+void GameWorld::UpdateTransforms() {
+	for (GameObject* g : gameObjects) {
+		const Transform& t = g->GetTransform();
+		if (t.IsMatrixOutOfDate()) {
+			t.UpdateMatrix();
+		}
+	}
+}
 
+/*
+Shuffling the objects and constraints stops the solver always favouring
+whichever was added first, but it's done with the world's own random
+source, so a seeded world shuffles the same way every time. std::shuffle
+is free to draw from the source however it likes, and MSVC and libstdc++
+don't agree, so the shuffle is done by hand with RandomIndex instead.
+*/
+void GameWorld::UpdateWorld(float dt) {
 	if (shuffleObjects) {
-		std::shuffle(gameObjects.begin(), gameObjects.end(), e);
+		for (size_t i = gameObjects.size(); i > 1; --i) {
+			std::swap(gameObjects[i - 1], gameObjects[RandomIndex(i)]);
+		}
 	}
 
 	if (shuffleConstraints) {
-		std::shuffle(constraints.begin(), constraints.end(), e);
+		for (size_t i = constraints.size(); i > 1; --i) {
+			std::swap(constraints[i - 1], constraints[RandomIndex(i)]);
+		}
 	}
 }
 
+/*
+The standard distributions are another thing each library implements its
+own way, so a seed that rolls a 6 on one compiler could roll a 3 on another.
+mt19937 itself is fully specified though, so both of these are built
+straight from its 32 bit outputs: the top 24 bits make a float in [0, 1),
+which is exact, as a float has 24 bits of precision.
+*/
+float GameWorld::RandomValue(float min, float max) {
+	float unit = (rng() >> 8) * 0x1p-24f;
+	return min + unit * (max - min);
+}
+
+size_t GameWorld::RandomIndex(size_t count) {
+	return (size_t)(((uint64_t)rng() * count) >> 32);
+}
+
 bool GameWorld::Raycast(Ray& r, RayCollision& closestCollision, bool closestObject, GameObject* ignoreThis) const {
 	//The simplest raycast just goes through each object and sees if there's a collision
 	RayCollision collision;
@@ -17,7 +17,7 @@ namespace NCL {
 		class GameWorld	{
 		public:
 			GameWorld();
-			~GameWorld();
+			virtual ~GameWorld();
 
 			void Clear();
 			void ClearAndErase();
@@ -40,12 +40,27 @@ namespace NCL {
 				shuffleObjects = state;
 			}
 
+			//everything random in a world comes from here, so seeding it is enough to make a run repeatable
+			void Seed(unsigned int seed) {
+				rng.seed(seed);
+			}
+
+			float RandomValue(float min, float max);
+			size_t RandomIndex(size_t count);	//in [0, count)
+
+			std::mt19937& GetRandomSource() {
+				return rng;
+			}
+
 			bool Raycast(Ray& r, RayCollision& closestCollision, bool closestObject = false, GameObject* ignore = nullptr) const;
 
 			virtual void UpdateWorld(float dt);
 
 			void OperateOnContents(GameObjectFunc f);
 
+			//rebuilds every transform matrix that has changed since it was last read, ready for rendering
+			void UpdateTransforms();
+
 			void GetObjectIterators(
 				GameObjectIterator& first,
 				GameObjectIterator& last) const;
@@ -66,6 +81,7 @@ namespace NCL {
 
 			bool shuffleConstraints;
 			bool shuffleObjects;
+			std::mt19937 rng;
 			int		worldIDCounter;
 			int		worldStateCounter;
 		};
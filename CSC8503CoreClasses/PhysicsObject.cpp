@@ -13,6 +13,8 @@ PhysicsObject::PhysicsObject(Transform* parentTransform, const CollisionVolume*
 	friction	= 0.8f;
 	useGravity = true;
 	frameAngularDampingCoeff = frameLinearDampingCoeff = 0.4f;
+	asleep = false;
+	ResetRestState();
 }
 
 PhysicsObject::~PhysicsObject()	{
@@ -29,6 +31,7 @@ void PhysicsObject::ApplyLinearImpulse(const Vector3& force) {
 
 void PhysicsObject::AddForce(const Vector3& addedForce) {
 	force += addedForce;
+	Wake();
 }
 
 void PhysicsObject::AddForceAtPosition(const Vector3& addedForce, const Vector3& position) {
@@ -36,10 +39,12 @@ void PhysicsObject::AddForceAtPosition(const Vector3& addedForce, const Vector3&
 
 	force  += addedForce;
 	torque += Vector3::Cross(localPos, addedForce);
+	Wake();
 }
 
 void PhysicsObject::AddTorque(const Vector3& addedTorque) {
 	torque += addedTorque;
+	Wake();
 }
 
 void PhysicsObject::ClearForces() {
@@ -47,6 +52,33 @@ void PhysicsObject::ClearForces() {
 	torque				= Vector3();
 }
 
+/*
+A single slow substep isn't enough to call an object settled - a die at the top
+of a bounce, or rocking over onto a new face, will briefly pass through zero
+velocity. Instead, it has to stay slow for a run of consecutive substeps.
+*/
+void PhysicsObject::UpdateRestState(float linearThreshold, float angularThreshold, int substepsNeeded) {
+	if (linearVelocity.LengthSquared() < linearThreshold * linearThreshold &&
+		angularVelocity.LengthSquared() < angularThreshold * angularThreshold) {
+		restSubsteps++;
+	}
+	else {
+		restSubsteps = 0;
+	}
+	settled = restSubsteps >= substepsNeeded;
+}
+
+void PhysicsObject::Sleep() {
+	asleep			= true;
+	linearVelocity	= Vector3();
+	angularVelocity	= Vector3();
+}
+
+void PhysicsObject::Wake() {
+	asleep = false;
+	ResetRestState();
+}
+
 void PhysicsObject::InitCubeInertia() {
 	Vector3 dimensions	= transform->GetScale();
 
@@ -36,6 +36,24 @@ namespace NCL {
 				return inverseMass;
 			}
 
+			//how much of its speed a contact gives back - the two objects' values are multiplied together
+			void SetElasticity(float e) {
+				elasticity = e;
+			}
+
+			float GetElasticity() const {
+				return elasticity;
+			}
+
+			//the two objects' values are combined as the square root of their product
+			void SetFriction(float f) {
+				friction = f;
+			}
+
+			float GetFriction() const {
+				return friction;
+			}
+
 			void ApplyAngularImpulse(const Vector3& force);
 			void ApplyLinearImpulse(const Vector3& force);
 			
@@ -71,6 +89,35 @@ namespace NCL {
 				return inverseInertiaTensor;
 			}
 
+			//for integrators that work out the world space tensor themselves, rather than through UpdateInertiaTensor
+			void SetInertiaTensor(const Matrix3& tensor) {
+				inverseInertiaTensor = tensor;
+			}
+
+			Vector3 GetInverseInertia() const {
+				return inverseInertia;
+			}
+
+			//an object is settled once it has been below the rest thresholds for enough consecutive substeps
+			void UpdateRestState(float linearThreshold, float angularThreshold, int substepsNeeded);
+
+			void ResetRestState() {
+				restSubsteps	= 0;
+				settled			= false;
+			}
+
+			bool IsSettled() const {
+				return settled;
+			}
+
+			//sleeping objects are skipped by integration and collision detection until something wakes them
+			void Sleep();
+			void Wake();
+
+			bool IsAsleep() const {
+				return asleep;
+			}
+
 			bool useGravity;
 			
 
@@ -94,6 +141,11 @@ namespace NCL {
 			Vector3 torque;
 			Vector3 inverseInertia;
 			Matrix3 inverseInertiaTensor;
+
+			//rest detection
+			int		restSubsteps;
+			bool	settled;
+			bool	asleep;
 		};
 	}
 }
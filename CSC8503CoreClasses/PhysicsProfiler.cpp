@@ -0,0 +1,234 @@
+#include "PhysicsProfiler.h"
+#include <cstring>
+
+using namespace NCL;
+using namespace CSC8503;
+
+PhysicsProfiler::PhysicsProfiler(int capacity) : ring(capacity), written(0) {
+	enabled		= false;
+	epoch		= std::chrono::high_resolution_clock::now();
+	frame		= 0;
+	substep		= 0;
+	inSubstep	= false;
+	phaseBegin	= 0.0;
+	StartRecord(frameRecord, -1);
+	StartRecord(substepRecord, 0);
+}
+
+double PhysicsProfiler::Now() const {
+	return std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - epoch).count();
+}
+
+void PhysicsProfiler::StartRecord(Record& r, int substepIndex) {
+	r			= Record();
+	r.frame		= frame;
+	r.substep	= substepIndex;
+	r.start		= enabled ? Now() : 0.0;
+}
+
+void PhysicsProfiler::BeginFrame() {
+	if (!enabled) {
+		return;
+	}
+	substep = 0;
+	StartRecord(frameRecord, -1);
+}
+
+void PhysicsProfiler::EndFrame() {
+	if (!enabled) {
+		return;
+	}
+	frameRecord.duration = (float)(Now() - frameRecord.start);
+	Push(frameRecord);
+	frame++;
+}
+
+void PhysicsProfiler::BeginSubstep() {
+	if (!enabled) {
+		return;
+	}
+	StartRecord(substepRecord, substep);
+	inSubstep = true;
+}
+
+void PhysicsProfiler::EndSubstep() {
+	if (!enabled) {
+		return;
+	}
+	substepRecord.duration = (float)(Now() - substepRecord.start);
+	Push(substepRecord);
+	inSubstep = false;
+	substep++;
+}
+
+void PhysicsProfiler::BeginPhase(PhysicsPhase phase) {
+	if (!enabled) {
+		return;
+	}
+	phaseBegin = Now();
+	Record& r = OpenRecord();
+	if (r.phaseTime[(int)phase] == 0.0f) {
+		r.phaseStart[(int)phase] = (float)(phaseBegin - r.start);
+	}
+}
+
+void PhysicsProfiler::EndPhase(PhysicsPhase phase) {
+	if (!enabled) {
+		return;
+	}
+	OpenRecord().phaseTime[(int)phase] += (float)(Now() - phaseBegin);
+}
+
+/*
+The slot's sequence is made odd before any of the record is written, and
+only moved on to the record's own number once all of it has been, so a
+reader can tell if the slot changed at any point while it was copying.
+*/
+void PhysicsProfiler::Push(Record& r) {
+	uint64_t index	= written.load(std::memory_order_relaxed);
+	Slot& slot		= ring[index % ring.size()];
+
+	slot.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	uint32_t words[RecordWords];
+	memcpy(words, &r, sizeof(Record));
+	for (int i = 0; i < RecordWords; ++i) {
+		slot.words[i].store(words[i], std::memory_order_relaxed);
+	}
+	slot.sequence.store(index * 2 + 2, std::memory_order_release);
+	written.store(index + 1, std::memory_order_release);
+}
+
+/*
+While the records are being copied, the physics thread might carry on
+and go all the way round the ring, writing over the oldest ones. A record
+is only kept if its slot's sequence says it was there both before and
+after it was copied.
+*/
+std::vector<PhysicsProfiler::Record> PhysicsProfiler::GetRecords() const {
+	uint64_t capacity	= ring.size();
+	uint64_t last		= written.load(std::memory_order_acquire);
+	uint64_t first		= last > capacity ? last - capacity : 0;
+
+	std::vector<Record> records;
+	records.reserve(last - first);
+	for (uint64_t i = first; i < last; ++i) {
+		const Slot& slot	= ring[i % capacity];
+		uint64_t sequence	= slot.sequence.load(std::memory_order_acquire);
+		if (sequence != i * 2 + 2) {
+			continue; //already being written over
+		}
+		uint32_t words[RecordWords];
+		for (int w = 0; w < RecordWords; ++w) {
+			words[w] = slot.words[w].load(std::memory_order_relaxed);
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+			continue;
+		}
+		Record& r = records.emplace_back();
+		memcpy(&r, words, sizeof(Record));
+	}
+	return records;
+}
+
+void PhysicsProfiler::Clear() {
+	for (Slot& slot : ring) {
+		slot.sequence.store(0, std::memory_order_relaxed);
+	}
+	written.store(0, std::memory_order_release);
+	frame	= 0;
+	substep	= 0;
+}
+
+const char* PhysicsProfiler::PhaseName(PhysicsPhase phase) {
+	switch (phase) {
+		case PhysicsPhase::UpdateAABBs:		return "UpdateAABBs";
+		case PhysicsPhase::IntegrateAccel:	return "IntegrateAccel";
+		case PhysicsPhase::BroadPhase:		return "BroadPhase";
+		case PhysicsPhase::NarrowPhase:		return "NarrowPhase";
+		case PhysicsPhase::ContactSolve:	return "ContactSolve";
+		case PhysicsPhase::Constraints:		return "Constraints";
+		case PhysicsPhase::IntegrateVelocity:	return "IntegrateVelocity";
+		case PhysicsPhase::Islands:			return "Islands";
+		case PhysicsPhase::CollisionList:	return "CollisionList";
+		default:							return "Unknown";
+	}
+}
+
+const char* PhysicsProfiler::CounterName(PhysicsCounter counter) {
+	switch (counter) {
+		case PhysicsCounter::CandidatePairs:	return "CandidatePairs";
+		case PhysicsCounter::GJKIterations:		return "GJKIterations";
+		case PhysicsCounter::EPAIterations:		return "EPAIterations";
+		case PhysicsCounter::Contacts:			return "Contacts";
+		default:								return "Unknown";
+	}
+}
+
+//one row per record, with every time in microseconds
+void PhysicsProfiler::WriteCSV(std::ostream& o) const {
+	o << "frame,substep,start,duration";
+	for (int p = 0; p < PhaseCount; ++p) {
+		o << "," << PhaseName((PhysicsPhase)p);
+	}
+	for (int c = 0; c < CounterCount; ++c) {
+		o << "," << CounterName((PhysicsCounter)c);
+	}
+	o << "\n";
+
+	std::ios_base::fmtflags oldFlags	= o.setf(std::ios_base::fixed, std::ios_base::floatfield);
+	std::streamsize oldPrecision		= o.precision(3);	//to the nanosecond
+	for (const Record& r : GetRecords()) {
+		o << r.frame << "," << r.substep << "," << r.start << "," << r.duration;
+		for (int p = 0; p < PhaseCount; ++p) {
+			o << "," << r.phaseTime[p];
+		}
+		for (int c = 0; c < CounterCount; ++c) {
+			o << "," << r.counters[c];
+		}
+		o << "\n";
+	}
+	o.flags(oldFlags);
+	o.precision(oldPrecision);
+}
+
+/*
+The Trace Event Format: every record and every phase in it becomes a
+complete ("X") event, so the phases sit underneath their substep on the
+timeline (the two integration passes are phases of their own, so each
+gets an event that covers just that pass, rather than the gap between), and the counters become a counter ("C") event at the start of
+each substep.
+*/
+void PhysicsProfiler::WriteChromeTrace(std::ostream& o) const {
+	o << "{\"traceEvents\":[";
+	bool first = true;
+	auto event = [&](const char* name, double start, double duration, const Record& r) {
+		o << (first ? "\n" : ",\n");
+		o << "{\"name\":\"" << name << "\",\"cat\":\"physics\",\"ph\":\"X\",\"pid\":0,\"tid\":0"
+			<< ",\"ts\":" << start << ",\"dur\":" << duration
+			<< ",\"args\":{\"frame\":" << r.frame << ",\"substep\":" << r.substep << "}}";
+		first = false;
+	};
+	std::ios_base::fmtflags oldFlags	= o.setf(std::ios_base::fixed, std::ios_base::floatfield);
+	std::streamsize oldPrecision		= o.precision(3);
+	for (const Record& r : GetRecords()) {
+		event(r.substep < 0 ? "Frame" : "Substep", r.start, r.duration, r);
+		for (int p = 0; p < PhaseCount; ++p) {
+			if (r.phaseTime[p] > 0.0f) {
+				event(PhaseName((PhysicsPhase)p), r.start + r.phaseStart[p], r.phaseTime[p], r);
+			}
+		}
+		if (r.substep >= 0) {
+			o << ",\n{\"name\":\"Counters\",\"cat\":\"physics\",\"ph\":\"C\",\"pid\":0,\"tid\":0,\"ts\":" << r.start << ",\"args\":{";
+			for (int c = 0; c < CounterCount; ++c) {
+				o << (c ? "," : "") << "\"" << CounterName((PhysicsCounter)c) << "\":" << r.counters[c];
+			}
+			o << "}}";
+		}
+	}
+	o.flags(oldFlags);
+	o.precision(oldPrecision);
+	o << "\n]}\n";
+}
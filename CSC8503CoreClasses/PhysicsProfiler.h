@@ -0,0 +1,142 @@
+#pragma once
+#include <atomic>
+
+namespace NCL {
+	namespace CSC8503 {
+		enum class PhysicsPhase {
+			UpdateAABBs,	//once a frame, before the substeps
+			IntegrateAccel,
+			BroadPhase,
+			NarrowPhase,
+			ContactSolve,
+			Constraints,
+			IntegrateVelocity,
+			Islands,
+			CollisionList,	//once a frame, after the substeps
+			MAX
+		};
+
+		enum class PhysicsCounter {
+			CandidatePairs,	//pairs the broadphase handed to the narrowphase
+			GJKIterations,
+			EPAIterations,
+			Contacts,		//contact points given to the contact solver
+			MAX
+		};
+
+		/*
+		Records how long each part of every physics substep took, along
+		with a few counters for how much work it had to do, so there's
+		something to measure any optimisation against. The work done once
+		a frame (keeping the broadphase boxes up to date, and clearing out
+		old collisions) goes in a record of its own, with a substep of -1.
+
+		Records go into a ring buffer, which only ever holds the most
+		recent ones, so the profiler can be left on indefinitely. Only the
+		physics thread writes to it, and it never waits for anything, so
+		another thread can copy the records out (or write them out as CSV,
+		or as a Chrome trace to load into chrome://tracing or Perfetto)
+		while the physics carries on. Each slot in the ring has its own
+		sequence number, which the physics thread changes before and after
+		writing a record into it, so any record that was written over while
+		it was being copied can be spotted, and is left out.
+
+		It's off by default, and costs next to nothing until it's turned on.
+		*/
+		class PhysicsProfiler {
+		public:
+			static const int PhaseCount		= (int)PhysicsPhase::MAX;
+			static const int CounterCount	= (int)PhysicsCounter::MAX;
+
+			struct Record {
+				uint64_t	frame;
+				int			substep;					//-1 for the once a frame work
+				double		start;						//microseconds since the profiler was made
+				float		duration;					//microseconds
+				float		phaseStart[PhaseCount];		//microseconds after the record's start
+				float		phaseTime[PhaseCount];		//microseconds, 0 if the phase didn't run
+				uint32_t	counters[CounterCount];
+			};
+
+			PhysicsProfiler(int capacity = 4096);
+			~PhysicsProfiler() {}
+
+			void SetEnabled(bool state) {
+				enabled = state;
+			}
+
+			bool IsEnabled() const {
+				return enabled;
+			}
+
+			void BeginFrame();
+			void EndFrame();
+
+			void BeginSubstep();
+			void EndSubstep();
+
+			//each phase runs at most once a record; if one is begun again, its times are added together
+			void BeginPhase(PhysicsPhase phase);
+			void EndPhase(PhysicsPhase phase);
+
+			void Count(PhysicsCounter counter, uint32_t amount) {
+				if (enabled) {
+					OpenRecord().counters[(int)counter] += amount;
+				}
+			}
+
+			//the records still in the buffer, oldest first
+			std::vector<Record> GetRecords() const;
+
+			//how many records have been written since the profiler was made (or cleared), including those since overwritten
+			uint64_t GetRecordsWritten() const {
+				return written.load(std::memory_order_acquire);
+			}
+
+			//only safe while the physics isn't running
+			void Clear();
+
+			void WriteCSV(std::ostream& o) const;
+			void WriteChromeTrace(std::ostream& o) const;
+
+			static const char* PhaseName(PhysicsPhase phase);
+			static const char* CounterName(PhysicsCounter counter);
+
+		protected:
+			static const int RecordWords = sizeof(Record) / sizeof(uint32_t);
+
+			/*
+			The record is kept as atomic words, so that copying one out while
+			it's being written over is only ever a stale read, rather than a
+			data race. The sequence is odd while a record is being written,
+			and 2 * (n + 1) once the nth record written is in the slot.
+			*/
+			struct Slot {
+				std::atomic<uint64_t> sequence;
+				std::atomic<uint32_t> words[RecordWords];
+			};
+
+			Record& OpenRecord() {
+				return inSubstep ? substepRecord : frameRecord;
+			}
+
+			void	StartRecord(Record& r, int substep);
+			void	Push(Record& r);
+			double	Now() const;
+
+			bool enabled;
+
+			std::vector<Slot>		ring;
+			std::atomic<uint64_t>	written;
+
+			Timepoint	epoch;
+			uint64_t	frame;
+			int			substep;
+			bool		inSubstep;
+			double		phaseBegin;
+
+			Record frameRecord;
+			Record substepRecord;
+		};
+	}
+}
@@ -7,26 +7,37 @@
 #include "Constraint.h"
 
 #include "Debug.h"
-#include "Window.h"
 #include <functional>
 using namespace NCL;
 using namespace CSC8503;
 
-PhysicsSystem::PhysicsSystem(GameWorld& g) : gameWorld(g)	{
+PhysicsSystem::PhysicsSystem(GameWorld& g, BroadPhaseType broadPhase) : gameWorld(g)	{
 	applyGravity	= false;
-	useBroadPhase	= true;	
-	dTOffset		= 0.0f;
+	broadPhaseType	= broadPhase;
 	globalDamping	= 0.995f;
 	SetGravity(Vector3(0.0f, -9.8f, 0.0f));
+	ResetStepHash();
 }
 
 PhysicsSystem::~PhysicsSystem()	{
+	delete narrowPhaseWorkers;
 }
 
 void PhysicsSystem::SetGravity(const Vector3& g) {
 	gravity = g;
 }
 
+void PhysicsSystem::SetNarrowPhaseThreadCount(int count) {
+	if (count <= 0) {
+		count = std::max(1, (int)std::thread::hardware_concurrency());
+	}
+	if (count == GetNarrowPhaseThreadCount()) {
+		return;
+	}
+	delete narrowPhaseWorkers;
+	narrowPhaseWorkers = count > 1 ? new WorkerPool(count) : nullptr;
+}
+
 /*
 
 If the 'game' is ever reset, the PhysicsSystem must be
@@ -38,113 +49,251 @@ any collisions they are in.
 
 */
 void PhysicsSystem::Clear() {
-	allCollisions.clear();
+	allCollisions.Clear();
+	ClearBroadPhase();
 }
 
 /*
 
-This is the core of the physics engine update
+This is the core of the physics engine update. How many substeps it runs,
+and how long each one is, is left to the StepController.
 
 */
+void PhysicsSystem::Update(float dt) {
+	GameTimer t;
+	t.GetTimeDeltaSeconds();
+	profiler.BeginFrame();
+
+	if (broadPhaseType != BroadPhaseType::BruteForce) {
+		profiler.BeginPhase(PhysicsPhase::UpdateAABBs);
+		UpdateObjectAABBs();
+		profiler.EndPhase(PhysicsPhase::UpdateAABBs);
+	}
+	int substeps	= stepController.BeginFrame(dt);
+	float stepDT	= stepController.GetStepDT();
+	for (int i = 0; i < substeps; ++i) {
+		Substep(stepDT);
+	}
 
-bool useSimpleContainer = false;
+	ClearForces();	//Once we've finished with the forces, reset them to zero
 
-int constraintIterationCount = 10;
+	profiler.BeginPhase(PhysicsPhase::CollisionList);
+	UpdateCollisionList(); //Remove any old collisions
+	profiler.EndPhase(PhysicsPhase::CollisionList);
 
-//This is the fixed timestep we'd LIKE to have
-const int   idealHZ = 120;
-const float idealDT = 1.0f / idealHZ;
+	profiler.EndFrame();
+	t.Tick();
+	stepController.EndFrame(t.GetTimeDeltaSeconds());
+}
 
 /*
-This is the fixed update we actually have...
-If physics takes too long it starts to kill the framerate, it'll drop the 
-iteration count down until the FPS stabilises, even if that ends up
-being at a low rate. 
+Headless callers (such as the DiceSimulator) don't have a wall-clock frame
+time to feed into Update, and don't want the iteration rate to change
+underneath them, so this steps the world by a fixed frame time, split
+into a fixed number of substeps.
 */
-int realHZ		= idealHZ;
-float realDT	= idealDT;
+void PhysicsSystem::FixedUpdate(float frameDT, int substeps) {
+	GameTimer t;
+	t.GetTimeDeltaSeconds();
+	profiler.BeginFrame();
 
-void PhysicsSystem::Update(float dt) {	
-	if (Window::GetKeyboard()->KeyPressed(KeyCodes::B)) {
-		useBroadPhase = !useBroadPhase;
-		std::cout << "Setting broadphase to " << useBroadPhase << std::endl;
+	if (broadPhaseType != BroadPhaseType::BruteForce) {
+		profiler.BeginPhase(PhysicsPhase::UpdateAABBs);
+		UpdateObjectAABBs();
+		profiler.EndPhase(PhysicsPhase::UpdateAABBs);
 	}
-	if (Window::GetKeyboard()->KeyPressed(KeyCodes::N)) {
-		useSimpleContainer = !useSimpleContainer;
-		std::cout << "Setting broad container to " << useSimpleContainer << std::endl;
+	float subDT = frameDT / (float)substeps;
+	for (int i = 0; i < substeps; ++i) {
+		Substep(subDT);
+	}
+	ClearForces();
+
+	profiler.BeginPhase(PhysicsPhase::CollisionList);
+	UpdateCollisionList();
+	profiler.EndPhase(PhysicsPhase::CollisionList);
+
+	profiler.EndFrame();
+	t.Tick();
+	stepController.RecordFrame(substeps, t.GetTimeDeltaSeconds());
+}
+
+void PhysicsSystem::Substep(float dt) {
+	profiler.BeginSubstep();
+	islandContacts.clear();
+	contactManifolds.clear();
+
+	profiler.BeginPhase(PhysicsPhase::IntegrateAccel);
+	IntegrateAccel(dt); //Update accelerations from external forces
+	profiler.EndPhase(PhysicsPhase::IntegrateAccel);
+
+	if (broadPhaseType == BroadPhaseType::BruteForce) {
+		profiler.BeginPhase(PhysicsPhase::NarrowPhase);
+		BasicCollisionDetection();
+		profiler.EndPhase(PhysicsPhase::NarrowPhase);
 	}
-	if (Window::GetKeyboard()->KeyPressed(KeyCodes::I)) {
-		constraintIterationCount--;
-		std::cout << "Setting constraint iterations to " << constraintIterationCount << std::endl;
+	else {
+		profiler.BeginPhase(PhysicsPhase::BroadPhase);
+		BroadPhase(dt);
+		profiler.EndPhase(PhysicsPhase::BroadPhase);
+
+		profiler.BeginPhase(PhysicsPhase::NarrowPhase);
+		NarrowPhase();
+		profiler.EndPhase(PhysicsPhase::NarrowPhase);
 	}
-	if (Window::GetKeyboard()->KeyPressed(KeyCodes::O)) {
-		constraintIterationCount++;
-		std::cout << "Setting constraint iterations to " << constraintIterationCount << std::endl;
+	profiler.BeginPhase(PhysicsPhase::ContactSolve);
+	SolveContacts(dt);
+	profiler.EndPhase(PhysicsPhase::ContactSolve);
+
+	//This is our simple iterative solver - 
+	//we just run things multiple times, slowly moving things forward
+	//and then rechecking that the constraints have been met		
+	profiler.BeginPhase(PhysicsPhase::Constraints);
+	float constraintDt = dt / (float)constraintIterationCount;
+	for (int i = 0; i < constraintIterationCount; ++i) {
+		UpdateConstraints(constraintDt);
 	}
+	profiler.EndPhase(PhysicsPhase::Constraints);
 
-	dTOffset += dt; //We accumulate time delta here - there might be remainders from previous frame!
+	profiler.BeginPhase(PhysicsPhase::IntegrateVelocity);
+	IntegrateVelocity(dt); //update positions from new velocity changes
+	profiler.EndPhase(PhysicsPhase::IntegrateVelocity);
 
-	GameTimer t;
-	t.GetTimeDeltaSeconds();
+	profiler.BeginPhase(PhysicsPhase::Islands);
+	UpdateIslands();
+	profiler.EndPhase(PhysicsPhase::Islands);
 
-	if (useBroadPhase) {
-		UpdateObjectAABBs();
+	if (deterministic) {
+		stepHash = (stepHash ^ HashState()) * 1099511628211ull;
 	}
-	int iteratorCount = 0;
-	while(dTOffset > realDT) {
-		IntegrateAccel(realDT); //Update accelerations from external forces
-		if (useBroadPhase) {
-			BroadPhase();
-			NarrowPhase();
-		}
-		else {
-			BasicCollisionDetection();
-		}
+	profiler.EndSubstep();
+}
 
-		//This is our simple iterative solver - 
-		//we just run things multiple times, slowly moving things forward
-		//and then rechecking that the constraints have been met		
-		float constraintDt = realDT /  (float)constraintIterationCount;
-		for (int i = 0; i < constraintIterationCount; ++i) {
-			UpdateConstraints(constraintDt);	
+/*
+A 64 bit FNV-1a hash over the exact bits of every object's state, in
+world order. Any difference at all - even in the last bit of a velocity -
+gives a different hash.
+*/
+uint64_t PhysicsSystem::HashState() const {
+	uint64_t hash = 14695981039346656037ull;
+	auto add = [&](float f) {
+		uint32_t bits;
+		memcpy(&bits, &f, sizeof(bits));
+		for (int i = 0; i < 4; ++i) {
+			hash = (hash ^ ((bits >> (i * 8)) & 0xFF)) * 1099511628211ull;
 		}
-		IntegrateVelocity(realDT); //update positions from new velocity changes
+	};
+	std::vector<GameObject*>::const_iterator first;
+	std::vector<GameObject*>::const_iterator last;
+	gameWorld.GetObjectIterators(first, last);
 
-		dTOffset -= realDT;
-		iteratorCount++;
+	for (auto i = first; i != last; i++) {
+		const PhysicsObject* object = (*i)->GetPhysicsObject();
+		if (object == nullptr) {
+			continue;
+		}
+		const Transform& transform = (*i)->GetTransform();
+		Vector3		position		= transform.GetPosition();
+		Quaternion	orientation		= transform.GetOrientation();
+		Vector3		linearVel		= object->GetLinearVelocity();
+		Vector3		angularVel		= object->GetAngularVelocity();
+
+		add(position.x);	add(position.y);	add(position.z);
+		add(orientation.x);	add(orientation.y);	add(orientation.z);	add(orientation.w);
+		add(linearVel.x);	add(linearVel.y);	add(linearVel.z);
+		add(angularVel.x);	add(angularVel.y);	add(angularVel.z);
+		hash = (hash ^ (object->IsAsleep() ? 1 : 0)) * 1099511628211ull;
 	}
+	return hash;
+}
 
-	ClearForces();	//Once we've finished with the forces, reset them to zero
+void PhysicsSystem::ResetStepHash() {
+	stepHash = 14695981039346656037ull;
+}
 
-	UpdateCollisionList(); //Remove any old collisions
+/*
+Objects that have come to rest are put to sleep, so that we don't spend time
+integrating and colliding things that aren't going anywhere. We can't just
+send each object to sleep on its own though - a die resting on top of another
+die has to wake up if the one underneath is knocked. So, every dynamic object
+touching another this substep is joined into an 'island' (using a simple
+union-find), and islands sleep and wake as one: if everything in the island
+has settled, it all goes to sleep, and if anything in it is still moving,
+anything asleep in it is woken back up. 
+
+Immovable objects never join islands, otherwise every die on the tray would
+be part of the same island as the floor!
+*/
+void PhysicsSystem::UpdateIslands() {
+	std::vector<GameObject*>::const_iterator first;
+	std::vector<GameObject*>::const_iterator last;
+	gameWorld.GetObjectIterators(first, last);
 
-	t.Tick();
-	float updateTime = t.GetTimeDeltaSeconds();
+	int maxID = -1;
+	for (auto i = first; i != last; i++) {
+		maxID = std::max(maxID, (*i)->GetWorldID());
+	}
+	if (maxID < 0) {
+		return;
+	}
+	islandParents.resize(maxID + 1);
+	islandRestless.resize(maxID + 1);
+	for (auto i = first; i != last; i++) {
+		int id = (*i)->GetWorldID();
+		islandParents[id]	= id;
+		islandRestless[id]	= false;
+	}
 
-	//Uh oh, physics is taking too long...
-	if (updateTime > realDT) {
-		realHZ /= 2;
-		realDT *= 2;
-		std::cout << "Dropping iteration count due to long physics time...(now " << realHZ << ")\n";
+	for (const auto& c : islandContacts) {
+		int rootA = FindIslandRoot(c.first->GetWorldID());
+		int rootB = FindIslandRoot(c.second->GetWorldID());
+		if (rootA != rootB) {
+			islandParents[rootB] = rootA;
+		}
 	}
-	else if(dt*2 < realDT) { //we have plenty of room to increase iteration count!
-		int temp = realHZ;
-		realHZ *= 2;
-		realDT /= 2;
 
-		if (realHZ > idealHZ) {
-			realHZ = idealHZ;
-			realDT = idealDT;
+	for (auto i = first; i != last; i++) {
+		PhysicsObject* object = (*i)->GetPhysicsObject();
+		if (object == nullptr || object->IsAsleep()) {
+			continue;
+		}
+		if (!object->IsSettled()) {
+			islandRestless[FindIslandRoot((*i)->GetWorldID())] = true;
+		}
+	}
+
+	for (auto i = first; i != last; i++) {
+		PhysicsObject* object = (*i)->GetPhysicsObject();
+		if (object == nullptr) {
+			continue;
 		}
-		if (temp != realHZ) {
-			std::cout << "Raising iteration count due to short physics time...(now " << realHZ << ")\n";
+		bool restless = islandRestless[FindIslandRoot((*i)->GetWorldID())];
+		if (restless && object->IsAsleep()) {
+			object->Wake();
 		}
+		else if (!restless && !object->IsAsleep()) {
+			object->Sleep();
+		}
+	}
+}
+
+int PhysicsSystem::FindIslandRoot(int id) {
+	while (islandParents[id] != id) {
+		islandParents[id] = islandParents[islandParents[id]]; //path halving keeps the trees flat
+		id = islandParents[id];
+	}
+	return id;
+}
+
+void PhysicsSystem::AddIslandContact(GameObject* a, GameObject* b) {
+	if (a->GetPhysicsObject()->GetInverseMass() == 0 || b->GetPhysicsObject()->GetInverseMass() == 0) {
+		return;
 	}
+	islandContacts.emplace_back(a, b);
 }
 
 /*
 Later on we're going to need to keep track of collisions
-across multiple frames, so we store them in a set.
+across multiple frames, so we store them in a pair cache.
 
 The first time they are added, we tell the objects they are colliding.
 The frame they are to be removed, we tell them they're no longer colliding.
@@ -154,19 +303,19 @@ OnCollisionBegin / OnCollisionEnd functions (removing health when hit by a
 rocket launcher, gaining a point when the player hits the gold coin, and so on).
 */
 void PhysicsSystem::UpdateCollisionList() {
-	for (std::set<CollisionDetection::CollisionInfo>::iterator i = allCollisions.begin(); i != allCollisions.end(); ) {
-		if ((*i).framesLeft == numCollisionFrames) {
-			i->a->OnCollisionBegin(i->b);
-			i->b->OnCollisionBegin(i->a);
+	for (int i = 0; i < allCollisions.Size(); ) {
+		CollisionDetection::CollisionInfo& in = allCollisions[i];
+		if (in.framesLeft == numCollisionFrames) {
+			in.a->OnCollisionBegin(in.b);
+			in.b->OnCollisionBegin(in.a);
 		}
 
-		CollisionDetection::CollisionInfo& in = const_cast<CollisionDetection::CollisionInfo&>(*i);
 		in.framesLeft--;
 
-		if ((*i).framesLeft < 0) {
-			i->a->OnCollisionEnd(i->b);
-			i->b->OnCollisionEnd(i->a);
-			i = allCollisions.erase(i);
+		if (in.framesLeft < 0) {
+			in.a->OnCollisionEnd(in.b);
+			in.b->OnCollisionEnd(in.a);
+			allCollisions.RemoveAt(i); //the last pair is swapped into i, so don't step past it
 		}
 		else {
 			++i;
@@ -177,6 +326,9 @@ void PhysicsSystem::UpdateCollisionList() {
 void PhysicsSystem::UpdateObjectAABBs() {
 	gameWorld.OperateOnContents(
 		[](GameObject* g) {
+			if (g->GetPhysicsObject() && g->GetPhysicsObject()->IsAsleep()) {
+				return; //it hasn't moved, so neither has its box
+			}
 			g->UpdateBroadphaseAABB();
 		}
 	);
@@ -187,11 +339,20 @@ void PhysicsSystem::UpdateObjectAABBs() {
 This is how we'll be doing collision detection in tutorial 4.
 We step thorugh every pair of objects once (the inner for loop offset 
 ensures this), and determine whether they collide, and if so, add them
-to the collision set for later processing. The set will guarantee that
+to the collision cache for later processing. The cache will guarantee that
 a particular pair will only be added once, so objects colliding for
-multiple frames won't flood the set with duplicates.
+multiple frames won't flood the cache with duplicates.
+
+The pairs are kept in broadphaseCollisions, just like the ones a real
+broadphase finds, so that the same pair keeps its GJK cache and contact
+points from one substep to the next.
 */
 void PhysicsSystem::BasicCollisionDetection() {
+	if (gameWorld.GetWorldStateID() != broadphaseWorldState) {
+		ClearBroadPhase();
+		broadphaseWorldState = gameWorld.GetWorldStateID();
+	}
+	broadphaseStamp++;
 
 	std::vector<GameObject*>::const_iterator first;
 	std::vector<GameObject*>::const_iterator last;
@@ -199,24 +360,20 @@ void PhysicsSystem::BasicCollisionDetection() {
 
 	for (auto i = first; i != last; i++)
 	{
-		if ((*i)->GetPhysicsObject() == nullptr)
+		if ((*i)->GetPhysicsObject() == nullptr || !(*i)->IsActive())
 			continue;
 
 		for (auto j = i + 1; j != last; j++)
 		{
-			if ((*j)->GetPhysicsObject() == nullptr)
+			if ((*j)->GetPhysicsObject() == nullptr || !(*j)->IsActive())
 				continue;
-			CollisionDetection::CollisionInfo info;
-			if (CollisionDetection::ObjectIntersection(*i, *j, info))
-			{
-				ImpulseResolveCollision(*info.a, *info.b, info.point);
-				std::cout << "Collision between " << (*i)->GetName()
-					<< " and " << (*j)->GetName() << std::endl;
-				info.framesLeft = numCollisionFrames;
-				allCollisions.insert(info);
-			}
+			AddBroadphasePair(*i, *j);
 		}
 	}
+	broadphaseCollisions.RemoveUntouched(broadphaseStamp);
+
+	//every pair goes through the same narrowphase as the broadphases use, so their contact points are matched up and warm started too
+	NarrowPhase();
 }
 
 /*
@@ -224,95 +381,219 @@ void PhysicsSystem::BasicCollisionDetection() {
 In tutorial 5, we start determining the correct response to a collision,
 so that objects separate back out. 
 
-*/
-void PhysicsSystem::ImpulseResolveCollision(GameObject& a, GameObject& b, CollisionDetection::ContactPoint& p) const {
-	PhysicsObject* physA = a.GetPhysicsObject();
-	PhysicsObject* physB = b.GetPhysicsObject();
-
-	Transform& transformA = a.GetTransform();
-	Transform& transformB = b.GetTransform();
+Collisions aren't resolved as they're found any more - a die resting on
+another die, which is resting on the tray, needs both contacts worked out
+together, or fixing one just breaks the other. So every contact that
+should be resolved is gathered up here, and the ContactSolver does them
+all at once once the narrowphase is finished.
 
-	float totalMass = physA->GetInverseMass() + physB->GetInverseMass();
-
-	if (totalMass == 0)
+*/
+void PhysicsSystem::AddContactManifold(const CollisionDetection::CollisionInfo& info) {
+	//we want to detect collectable and zone collisions, but not resolve them
+	char noCollides = collectable | zone;
+	if (info.a->GetCollisionLayer() & noCollides || info.b->GetCollisionLayer() & noCollides)
+	{
 		return;
+	}
+	contactManifolds.emplace_back(info);
+}
 
-	//project the objects away from each other immediately, so as to stop triggering collision
-	transformA.SetPosition(transformA.GetPosition() - (p.normal * p.penetration * (physA->GetInverseMass() / totalMass)));
-	transformB.SetPosition(transformB.GetPosition() + (p.normal * p.penetration * (physB->GetInverseMass() / totalMass)));
+void PhysicsSystem::SolveContacts(float dt) {
+	if (profiler.IsEnabled()) {
+		uint32_t points = 0;
+		for (const CollisionDetection::CollisionInfo& info : contactManifolds) {
+			points += info.pointCount;
+		}
+		profiler.Count(PhysicsCounter::Contacts, points);
+	}
+	contactSolver.Solve(contactManifolds, dt);
 
-	Vector3 relativeA = p.localA;
-	Vector3 relativeB = p.localB;
+	//the pair's copy of its points is what the next substep matches against, so it needs the impulses too
+	for (const CollisionDetection::CollisionInfo& info : contactManifolds) {
+		CollisionDetection::CollisionInfo* stored = broadphaseCollisions.Find(info.a, info.b);
+		if (stored) {
+			std::copy(info.points, info.points + info.pointCount, stored->points);
+		}
+	}
+}
 
-	Vector3 angVelocityA = Vector3::Cross(physA->GetAngularVelocity(), relativeA);
-	Vector3 angVelocityB = Vector3::Cross(physB->GetAngularVelocity(), relativeB);
-	Vector3 fullVelocityA = physA->GetLinearVelocity() + angVelocityA;
-	Vector3 fullVelocityB = physB->GetLinearVelocity() + angVelocityB;
-	
-	Vector3 contactVelocity = fullVelocityB - fullVelocityA;
+/*
 
-	float impulseForce = Vector3::Dot(contactVelocity, p.normal);
+Later, we replace the BasicCollisionDetection method with a broadphase
+and a narrowphase collision detection method. In the broad phase, we
+split the world up using an acceleration structure, so that we can only
+compare the collisions that we absolutely need to. 
 
-	//inertial effects
-	Vector3 inertiaA = Vector3::Cross(physA->GetInertiaTensor() * Vector3::Cross(relativeA, p.normal), relativeA);
-	Vector3 inertiaB = Vector3::Cross(physB->GetInertiaTensor() * Vector3::Cross(relativeB, p.normal), relativeB);
+Which acceleration structure we use is picked when the PhysicsSystem is made,
+as they each suit different scenes - see TreeBroadPhase, SweepAndPruneBroadPhase,
+SpatialHashBroadPhase and QuadTreeBroadPhase.
+Either way, every pair of objects they think might be touching ends up in the
+broadphaseCollisions cache, ready for the narrowphase.
 
-	float angularEffect = Vector3::Dot(inertiaA + inertiaB, p.normal);
-	float cRestituation = 0.66f;	//represents some energy dispersing to another form (heat, sound, whatever)
+The cache isn't emptied between substeps - pairs the broadphase finds again
+are just stamped as still being there, so they keep what GJK cached about
+them last time, and only the pairs it doesn't find are thrown away.
 
-	float j = (-(1.0f + cRestituation) * impulseForce) / (totalMass + angularEffect);
+*/
+void PhysicsSystem::BroadPhase(float dt) {
+	broadphaseStamp++;
+	if (broadPhaseType == BroadPhaseType::SweepAndPrune) {
+		SweepAndPruneBroadPhase();
+	}
+	else if (broadPhaseType == BroadPhaseType::SpatialHash) {
+		SpatialHashBroadPhase();
+	}
+	else if (broadPhaseType == BroadPhaseType::QuadTree) {
+		QuadTreeBroadPhase();
+	}
+	else {
+		TreeBroadPhase(dt);
+	}
+	broadphaseCollisions.RemoveUntouched(broadphaseStamp);
+}
+
+void PhysicsSystem::AddBroadphasePair(GameObject* a, GameObject* b) {
+	CollisionDetection::CollisionInfo info;
+	//order the pair by world ID rather than address, so the same scene always tests the same way round
+	bool aFirst = a->GetWorldID() < b->GetWorldID();
+	info.a = aFirst ? a : b;
+	info.b = aFirst ? b : a;
+	//cut out static pairs at broadphase with a bit of bit-masking
+	char statics = tempStatic | staticObj;
+	if (info.a->GetCollisionLayer() & statics && info.b->GetCollisionLayer() & statics)
+		return;
+	//two sleeping objects can't have moved into each other
+	if (info.a->GetPhysicsObject()->IsAsleep() && info.b->GetPhysicsObject()->IsAsleep())
+		return;
+	broadphaseCollisions.Touch(info, broadphaseStamp);
+}
 
-	Vector3 fullImpulse = p.normal * j;
+/*
+Rather than building a new QuadTree every substep, we keep a DynamicAABBTree
+around, which only changes when something moves outside of its fattened box.
+Each awake, non-static object then asks the tree for whatever overlaps its box -
+anything asleep or static will still be found by whatever is moving into it.
+*/
+void PhysicsSystem::TreeBroadPhase(float dt) {
+	UpdateBroadphaseTree(dt);
 
-	physA->ApplyLinearImpulse(-fullImpulse);
-	physB->ApplyLinearImpulse(fullImpulse);
+	std::vector<GameObject*>::const_iterator first;
+	std::vector<GameObject*>::const_iterator last;
+	gameWorld.GetObjectIterators(first, last);
 
-	physA->ApplyAngularImpulse(Vector3::Cross(relativeA, -fullImpulse));
-	physB->ApplyAngularImpulse(Vector3::Cross(relativeB, fullImpulse));
+	char statics = tempStatic | staticObj;
+	for (auto i = first; i != last; i++)
+	{
+		int proxy = broadphaseProxies[(*i)->GetWorldID()];
+		if (proxy < 0) {
+			continue;
+		}
+		if ((*i)->GetCollisionLayer() & statics || (*i)->GetPhysicsObject()->IsAsleep()) {
+			continue;
+		}
+		Vector3 fatMin;
+		Vector3 fatMax;
+		broadphaseTree.GetFatAABB(proxy, fatMin, fatMax);
+		broadphaseTree.Query(fatMin, fatMax,
+			[&](GameObject* other, int otherProxy)
+			{
+				if (otherProxy != proxy) {
+					AddBroadphasePair(*i, other); //both objects will find each other, but the cache only keeps one
+				}
+			}
+		);
+	}
 }
 
 /*
+The sweep wants every box every substep (although the order they end up in
+barely changes from one substep to the next), so there's no fattening here -
+each object's box is just its broadphase AABB, wherever it is right now.
+*/
+void PhysicsSystem::SweepAndPruneBroadPhase() {
+	if (gameWorld.GetWorldStateID() != broadphaseWorldState) {
+		ClearBroadPhase();
+		broadphaseWorldState = gameWorld.GetWorldStateID();
+	}
 
-Later, we replace the BasicCollisionDetection method with a broadphase
-and a narrowphase collision detection method. In the broad phase, we
-split the world up using an acceleration structure, so that we can only
-compare the collisions that we absolutely need to. 
+	std::vector<GameObject*>::const_iterator first;
+	std::vector<GameObject*>::const_iterator last;
+	gameWorld.GetObjectIterators(first, last);
+
+	for (auto i = first; i != last; i++)
+	{
+		Vector3 halfSizes;
+		if (!(*i)->GetBroadphaseAABB(halfSizes) || !(*i)->IsActive()) {
+			broadphaseSweep.RemoveBox((*i)->GetWorldID());
+			continue;
+		}
+		Vector3 pos = (*i)->GetTransform().GetPosition();
+		broadphaseSweep.SetBox((*i)->GetWorldID(), *i, pos - halfSizes, pos + halfSizes);
+	}
+
+	broadphaseSweep.FindPairs(broadphasePairs);
+	for (const auto& p : broadphasePairs) {
+		AddBroadphasePair(p.first, p.second);
+	}
+}
 
+/*
+The grid is cheap enough to build from nothing every substep - it's just a
+list of cell entries to sort - and it keeps all of its memory between builds.
+Unlike the QuadTree, it splits space up vertically too, so a tower of dice
+doesn't all end up being tested against each other.
 */
-void PhysicsSystem::BroadPhase() {
-	broadphaseCollisions.clear();
-	QuadTree<GameObject*> tree(Vector2(64, 64), 7, 6);
+void PhysicsSystem::SpatialHashBroadPhase() {
+	broadphaseGrid.Clear();
 
 	std::vector<GameObject*>::const_iterator first;
 	std::vector<GameObject*>::const_iterator last;
 	gameWorld.GetObjectIterators(first, last);
+
 	for (auto i = first; i != last; i++)
 	{
 		Vector3 halfSizes;
-		if (!(*i)->GetBroadphaseAABB(halfSizes))
+		if (!(*i)->GetBroadphaseAABB(halfSizes) || !(*i)->IsActive()) {
 			continue;
+		}
+		Vector3 pos = (*i)->GetTransform().GetPosition();
+		broadphaseGrid.Insert(*i, pos - halfSizes, pos + halfSizes);
+	}
+
+	broadphaseGrid.FindPairs(broadphasePairs);
+	for (const auto& p : broadphasePairs) {
+		AddBroadphasePair(p.first, p.second);
+	}
+}
+
+/*
+The original broadphase: every active object goes into a QuadTree that's
+built from scratch, and every pair of objects that ends up in the same leaf
+is a candidate. The tree holds onto its node and entry arrays when it's
+cleared, so rebuilding it every substep doesn't allocate once it's grown.
+*/
+void PhysicsSystem::QuadTreeBroadPhase() {
+	broadphaseQuadTree.Clear();
 
-		if (!((*i)->IsActive())) {
+	std::vector<GameObject*>::const_iterator first;
+	std::vector<GameObject*>::const_iterator last;
+	gameWorld.GetObjectIterators(first, last);
+
+	for (auto i = first; i != last; i++)
+	{
+		Vector3 halfSizes;
+		if (!(*i)->GetBroadphaseAABB(halfSizes) || !(*i)->IsActive()) {
 			continue;
 		}
-		Vector3 pos = (*i)->GetTransform().GetPosition();
-		tree.Insert(*i, pos, halfSizes);
+		broadphaseQuadTree.Insert(*i, (*i)->GetTransform().GetPosition(), halfSizes);
 	}
-	tree.OperateOnContents(
-		[&](std::list<QuadTreeEntry<GameObject*>>& data)
+
+	broadphaseQuadTree.OperateOnContents(
+		[&](std::span<QuadTreeEntry<GameObject*>> entries)
 		{
-			CollisionDetection::CollisionInfo info;
-			for (auto i = data.begin(); i != data.end(); i++)
-			{
-				for (auto j = std::next(i); j != data.end(); j++)
-				{
-					info.a = std::min((*i).object, (*j).object);
-					info.b = std::max((*i).object, (*j).object);
-					//cut out static pairs at broadphase with a bit of bit-masking
-					char statics = tempStatic | staticObj;
-					if (info.a->GetCollisionLayer() & statics && info.b->GetCollisionLayer() & statics)
-						continue;
-					broadphaseCollisions.insert(info);
+			for (size_t i = 0; i < entries.size(); ++i) {
+				for (size_t j = i + 1; j < entries.size(); ++j) {
+					AddBroadphasePair(entries[i].object, entries[j].object);
 				}
 			}
 		}
@@ -320,82 +601,147 @@ void PhysicsSystem::BroadPhase() {
 }
 
 /*
-
-The broadphase will now only give us likely collisions, so we can now go through them,
-and work out if they are truly colliding, and if so, add them into the main collision list
+Objects that have moved outside of their fattened box get moved in the tree,
+and anything that has only just become collidable gets a leaf for the first
+time. If objects have been removed from the world, the tree could be holding
+leaves for objects that no longer exist, so it's just built again from
+scratch - that's rare enough not to be worth anything cleverer.
 */
-void PhysicsSystem::NarrowPhase() {
-	for (std::set<CollisionDetection::CollisionInfo>::iterator i = broadphaseCollisions.begin();
-		i != broadphaseCollisions.end(); i++)
+void PhysicsSystem::UpdateBroadphaseTree(float dt) {
+	if (gameWorld.GetWorldStateID() != broadphaseWorldState) {
+		ClearBroadPhase();
+		broadphaseWorldState = gameWorld.GetWorldStateID();
+	}
+
+	std::vector<GameObject*>::const_iterator first;
+	std::vector<GameObject*>::const_iterator last;
+	gameWorld.GetObjectIterators(first, last);
+
+	for (auto i = first; i != last; i++)
 	{
-		CollisionDetection::CollisionInfo info = *i;
-		if (CollisionDetection::ObjectIntersection(info.a, info.b, info))
-		{
+		int id = (*i)->GetWorldID();
+		if (id >= (int)broadphaseProxies.size()) {
+			broadphaseProxies.resize(id + 1, -1);
+		}
+		int& proxy = broadphaseProxies[id];
 
-			info.framesLeft = numCollisionFrames;
-			allCollisions.insert(info);
-			//we want to detect collectable and zone collisions, but not resolve them
-			char noCollides = collectable | zone;
-			if (info.a->GetCollisionLayer() & noCollides || info.b->GetCollisionLayer() & noCollides)
-			{
-				continue;
+		Vector3 halfSizes;
+		if (!(*i)->GetBroadphaseAABB(halfSizes) || !(*i)->IsActive()) {
+			if (proxy >= 0) {
+				broadphaseTree.Remove(proxy);
+				proxy = -1;
 			}
-			ImpulseResolveCollision(*info.a, *info.b, info.point);
-			
+			continue;
 		}
+		Vector3 pos = (*i)->GetTransform().GetPosition();
+		if (proxy < 0) {
+			proxy = broadphaseTree.Insert(*i, pos, halfSizes);
+			continue;
+		}
+		PhysicsObject* object = (*i)->GetPhysicsObject();
+		if (object->IsAsleep()) {
+			continue;
+		}
+		broadphaseTree.Move(proxy, pos, halfSizes, object->GetLinearVelocity() * dt);
 	}
 }
 
+void PhysicsSystem::ClearBroadPhase() {
+	broadphaseTree.Clear();
+	broadphaseSweep.Clear();
+	broadphaseProxies.clear();
+	broadphaseCollisions.Clear();
+	broadphaseWorldState = -1;
+}
+
 /*
-Integration of acceleration and velocity is split up, so that we can
-move objects multiple times during the course of a PhysicsUpdate,
-without worrying about repeated forces accumulating etc. 
 
-This function will update both linear and angular acceleration,
-based on any forces that have been accumulated in the objects during
-the course of the previous game frame.
+The broadphase will now only give us likely collisions, so we can now go through them,
+and work out if they are truly colliding, and if so, add them into the main collision list
+
+Testing a pair doesn't change anything, so the pairs can be split up between
+the narrowphase workers, each of which writes the contacts it finds into its
+own list. The workers get contiguous runs of pairs, in order, so reading the
+lists back in worker order gives the contacts in the same order no matter how
+many threads found them. Resolving them moves objects around, so that's left
+until afterwards, and done on this thread by SolveContacts.
 */
-void PhysicsSystem::IntegrateAccel(float dt) {
-	std::vector<GameObject*>::const_iterator first;
-	std::vector<GameObject*>::const_iterator last;
-	gameWorld.GetObjectIterators(first, last);
+void PhysicsSystem::NarrowPhase() {
+	int pairCount	= broadphaseCollisions.Size();
+	bool parallel	= narrowPhaseWorkers && pairCount >= parallelNarrowPhaseMinPairs;
 
-	for (auto i = first; i != last; i++)
-	{
+	narrowPhaseResults.resize(GetNarrowPhaseThreadCount());
+	for (auto& results : narrowPhaseResults) {
+		results.clear();
+	}
+	narrowPhaseCounts.assign(GetNarrowPhaseThreadCount(), CollisionDetection::IterationCounts());
+	profiler.Count(PhysicsCounter::CandidatePairs, pairCount);
 
-		if (!((*i)->IsActive())) {
-			continue;
+	if (parallel) {
+		narrowPhaseWorkers->ParallelFor(pairCount,
+			[&](int worker, int begin, int end) {
+				NarrowPhaseRange(worker, begin, end);
+			}
+		);
+	}
+	else {
+		NarrowPhaseRange(0, 0, pairCount);
+	}
+
+	for (const CollisionDetection::IterationCounts& counts : narrowPhaseCounts) {
+		profiler.Count(PhysicsCounter::GJKIterations, counts.gjk);
+		profiler.Count(PhysicsCounter::EPAIterations, counts.epa);
+	}
+	for (auto& results : narrowPhaseResults) {
+		for (CollisionDetection::CollisionInfo& info : results) {
+			info.framesLeft = numCollisionFrames;
+			allCollisions.Insert(info);
+			AddIslandContact(info.a, info.b);
+			AddContactManifold(info);
 		}
+	}
+}
 
-		PhysicsObject* object = (*i)->GetPhysicsObject();
-		if (object == nullptr)
+void PhysicsSystem::NarrowPhaseRange(int worker, int begin, int end) {
+	std::vector<CollisionDetection::CollisionInfo>& results = narrowPhaseResults[worker];
+	for (int i = begin; i < end; ++i)
+	{
+		CollisionDetection::CollisionInfo info = broadphaseCollisions[i];
+		if (info.a->GetPhysicsObject()->IsAsleep() && info.b->GetPhysicsObject()->IsAsleep())
 		{
-			continue; 
+			continue;
 		}
-		float inverseMass = object->GetInverseMass();
-
-		Vector3 linearVel = object->GetLinearVelocity();
-		Vector3 force = object->GetForce();
-		Vector3 accel = force * inverseMass;
-
-		if (applyGravity && inverseMass > 0 && object->useGravity)
+		//each worker has its own run of pairs, so it's the only one touching their GJK caches and contact points
+		CollisionDetection::CollisionInfo& stored = broadphaseCollisions[i];
+		if (CollisionDetection::ObjectIntersection(info.a, info.b, info, &broadphaseCollisions.GetGJKCache(i)))
 		{
-			accel += gravity;
+			info.MatchContactPoints(stored);
+			results.emplace_back(info);
 		}
+		std::copy(info.points, info.points + info.pointCount, stored.points);
+		stored.pointCount = info.pointCount;
+	}
+	CollisionDetection::IterationCounts counts = CollisionDetection::TakeIterationCounts();
+	narrowPhaseCounts[worker].gjk += counts.gjk;
+	narrowPhaseCounts[worker].epa += counts.epa;
+}
 
-		linearVel += accel * dt;
-		object->SetLinearVelocity(linearVel);
-
-		//angular component
-		Vector3 torque = object->GetTorque();
-		Vector3 angVel = object->GetAngularVelocity();
-		object->UpdateInertiaTensor();
+/*
+Integration of acceleration and velocity is split up, so that we can
+move objects multiple times during the course of a PhysicsUpdate,
+without worrying about repeated forces accumulating etc. 
 
-		Vector3 angAccel = object->GetInertiaTensor() * torque;
-		angVel += angAccel * dt;
-		object->SetAngularVelocity(angVel);
-	}
+This function will update both linear and angular acceleration,
+based on any forces that have been accumulated in the objects during
+the course of the previous game frame.
 
+The sums themselves are done by the RigidBodyStore, which the moving
+objects are copied into at the start of every substep.
+*/
+void PhysicsSystem::IntegrateAccel(float dt) {
+	bodies.Gather(gameWorld, applyGravity);
+	bodies.IntegrateAccel(dt, gravity);
+	bodies.WriteAccel();
 }
 
 /*
@@ -405,40 +751,82 @@ throughout a physics update, to slowly move the objects through
 the world, looking for collisions.
 */
 void PhysicsSystem::IntegrateVelocity(float dt) {
-	std::vector<GameObject*>::const_iterator first;
-	std::vector<GameObject*>::const_iterator last;
-	gameWorld.GetObjectIterators(first, last);
-	
+	bodies.ReadVelocities();
+	SweepFastBodies(dt);
+	bodies.IntegrateVelocity(dt);
+	bodies.WriteVelocity();
 
-	for (auto i = first; i != last; i++)
-	{
-		PhysicsObject* object = (*i)->GetPhysicsObject();
-		if (object == nullptr)
-		{
+	for (int i = 0; i < bodies.Size(); ++i) {
+		bodies.GetObject(i)->GetPhysicsObject()->UpdateRestState(restLinearThreshold, restAngularThreshold, restSubstepCount);
+	}
+}
+
+/*
+Anything moving fast enough to be at risk of going straight through the
+tray is checked against the immovable objects whose boxes its path
+crosses, and if it would hit one, it's only moved as far as the hit this
+substep - see ContinuousCollision. The path is padded out by the
+object's radius, so that spinning can't take it outside either.
+*/
+void PhysicsSystem::SweepFastBodies(float dt) {
+	float threshold = continuousCollision.GetVelocityThreshold();
+	char noCollides = collectable | zone;
+
+	bool targetsFound = false;
+	for (int i = 0; i < bodies.Size(); ++i) {
+		GameObject*		o		= bodies.GetObject(i);
+		PhysicsObject*	object	= o->GetPhysicsObject();
+		Vector3			linearVel = object->GetLinearVelocity();
+
+		if (object->GetInverseMass() == 0.0f || linearVel.LengthSquared() < threshold * threshold ||
+			o->GetCollisionLayer() & noCollides || !ContinuousCollision::CanSweep(o)) {
 			continue;
 		}
-		float frameLinearDamping = 1.0f - (object->GetFrameLinearDampingCoeff() * dt);
-		Transform& transform = (*i)->GetTransform();
-		Vector3 position = transform.GetPosition();
-		Vector3 linearVel = object->GetLinearVelocity();
-		position += linearVel * dt;
-		transform.SetPosition(position);
-
-		linearVel = linearVel * frameLinearDamping;
-		object->SetLinearVelocity(linearVel);
-
-		//orientation component
-		Quaternion orientation = transform.GetOrientation();
-		Vector3 angVel = object->GetAngularVelocity();
-		orientation = orientation + (Quaternion(angVel * dt * 0.5f, 0.05) * orientation);
-		orientation.Normalise();
-		transform.SetOrientation(orientation);
-
-		float frameAngularDamping = 1.0f - (object->GetFrameAngularDampingCoeff() * dt);
-		angVel = angVel * frameAngularDamping;
-		object->SetAngularVelocity(angVel);
+		//most substeps have nothing fast in them, so the targets are only found when they're needed
+		if (!targetsFound) {
+			sweepTargets.clear();
+			gameWorld.OperateOnContents(
+				[&](GameObject* target) {
+					PhysicsObject* targetObject = target->GetPhysicsObject();
+					if (targetObject && targetObject->GetInverseMass() == 0.0f &&
+						!(target->GetCollisionLayer() & noCollides) && ContinuousCollision::CanSweep(target)) {
+						SweepTarget t;
+						t.object = target;
+						ContinuousCollision::GetBounds(target, t.boundsMin, t.boundsMax);
+						sweepTargets.emplace_back(t);
+					}
+				}
+			);
+			targetsFound = true;
+		}
+		Vector3 boundsMin;
+		Vector3 boundsMax;
+		ContinuousCollision::GetBounds(o, boundsMin, boundsMax);
+
+		Vector3 start	= o->GetTransform().GetPosition();
+		Vector3 end		= start + linearVel * dt;
+		Vector3 reach;
+		reach.x = std::max(start.x - boundsMin.x, boundsMax.x - start.x);
+		reach.y = std::max(start.y - boundsMin.y, boundsMax.y - start.y);
+		reach.z = std::max(start.z - boundsMin.z, boundsMax.z - start.z);
+		float radius = reach.Length();
+
+		Vector3 pathMin(std::min(start.x, end.x) - radius, std::min(start.y, end.y) - radius, std::min(start.z, end.z) - radius);
+		Vector3 pathMax(std::max(start.x, end.x) + radius, std::max(start.y, end.y) + radius, std::max(start.z, end.z) + radius);
+
+		float fraction = 1.0f;
+		for (const SweepTarget& t : sweepTargets) {
+			if (pathMax.x < t.boundsMin.x || pathMin.x > t.boundsMax.x ||
+				pathMax.y < t.boundsMin.y || pathMin.y > t.boundsMax.y ||
+				pathMax.z < t.boundsMin.z || pathMin.z > t.boundsMax.z) {
+				continue;
+			}
+			fraction = std::min(fraction, continuousCollision.TimeOfImpact(o, radius, t.object, dt));
+		}
+		if (fraction < 1.0f) {
+			bodies.SetStepFraction(i, fraction);
+		}
 	}
-
 }
 
 /*
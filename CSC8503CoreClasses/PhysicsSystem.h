@@ -1,16 +1,35 @@
 #pragma once
 #include "GameWorld.h"
+#include "CollisionPairCache.h"
+#include "DynamicAABBTree.h"
+#include "SweepAndPrune.h"
+#include "SpatialHashGrid.h"
+#include "WorkerPool.h"
+#include "ContactSolver.h"
+#include "RigidBodyStore.h"
+#include "StepController.h"
+#include "ContinuousCollision.h"
+#include "PhysicsProfiler.h"
 
 namespace NCL {
 	namespace CSC8503 {
+		enum class BroadPhaseType {
+			Tree,			//a persistent DynamicAABBTree
+			SweepAndPrune,	//sort and sweep along the most spread out axis
+			SpatialHash,	//a uniform 3D grid, for scenes with lots of objects stacked up
+			QuadTree,		//a QuadTree over the ground plane, built again every substep
+			BruteForce		//no broadphase, every pair goes straight to the narrowphase
+		};
+
 		class PhysicsSystem	{
 		public:
-			PhysicsSystem(GameWorld& g);
+			PhysicsSystem(GameWorld& g, BroadPhaseType broadPhase = BroadPhaseType::Tree);
 			~PhysicsSystem();
 
 			void Clear();
 
 			void Update(float dt);
+			void FixedUpdate(float frameDT, int substeps = 1);
 
 			void UseGravity(bool state) {
 				applyGravity = state;
@@ -21,35 +40,183 @@ namespace NCL {
 			}
 
 			void SetGravity(const Vector3& g);
+
+			BroadPhaseType GetBroadPhaseType() const {
+				return broadPhaseType;
+			}
+
+			//1 runs the narrowphase on the calling thread, 0 uses every core
+			void SetNarrowPhaseThreadCount(int count);
+
+			int GetNarrowPhaseThreadCount() const {
+				return narrowPhaseWorkers ? narrowPhaseWorkers->GetWorkerCount() : 1;
+			}
+
+			//smaller narrowphases than this aren't worth waking the workers up for
+			void SetParallelNarrowPhaseMinPairs(int count) {
+				parallelNarrowPhaseMinPairs = count;
+			}
+
+			void SetConstraintIterationCount(int count) {
+				constraintIterationCount = count;
+			}
+
+			int GetConstraintIterationCount() const {
+				return constraintIterationCount;
+			}
+
+			//the most passes the contact solver makes over the contacts each substep
+			void SetContactIterationCount(int count) {
+				contactSolver.SetIterationCount(count);
+			}
+
+			int GetContactIterationCount() const {
+				return contactSolver.GetIterationCount();
+			}
+
+			void SetContactConvergenceTolerance(float tolerance) {
+				contactSolver.SetConvergenceTolerance(tolerance);
+			}
+
+			ContactSolver& GetContactSolver() {
+				return contactSolver;
+			}
+
+			//objects moving faster than this are swept against immovable objects, so they can't pass through them
+			void SetContinuousCollisionThreshold(float speed) {
+				continuousCollision.SetVelocityThreshold(speed);
+			}
+
+			ContinuousCollision& GetContinuousCollision() {
+				return continuousCollision;
+			}
+
+			/*
+			In deterministic mode, Update always steps at the step controller's
+			ideal rate, rather than dropping the rate when a step takes too long,
+			and the world's state is hashed after every substep. Given the same
+			starting world (seeded the same way) and the same calls, two runs
+			end with the same step hash only if they matched bit for bit all
+			the way through.
+			*/
+			void SetDeterministic(bool state) {
+				deterministic = state;
+				stepController.SetAdaptive(!state);
+			}
+
+			bool IsDeterministic() const {
+				return deterministic;
+			}
+
+			//every object's position, orientation and velocities, exactly as they are now
+			uint64_t HashState() const;
+
+			uint64_t GetStepHash() const {
+				return stepHash;
+			}
+
+			void ResetStepHash();
+
+			//the substep rate, budget and max substeps used by Update, along with how the last frame went
+			StepController& GetStepController() {
+				return stepController;
+			}
+
+			//per phase timings and counters for every substep, once it's enabled
+			PhysicsProfiler& GetProfiler() {
+				return profiler;
+			}
+
+			void SetRestThresholds(float linear, float angular, int substeps) {
+				restLinearThreshold		= linear;
+				restAngularThreshold	= angular;
+				restSubstepCount		= substeps;
+			}
 		protected:
+			void Substep(float dt);
+
 			void BasicCollisionDetection();
-			void BroadPhase();
+			void BroadPhase(float dt);
+			void TreeBroadPhase(float dt);
+			void SweepAndPruneBroadPhase();
+			void SpatialHashBroadPhase();
+			void QuadTreeBroadPhase();
+			void AddBroadphasePair(GameObject* a, GameObject* b);
+			void UpdateBroadphaseTree(float dt);
+			void ClearBroadPhase();
 			void NarrowPhase();
+			void NarrowPhaseRange(int worker, int begin, int end);
 
 			void ClearForces();
 
 			void IntegrateAccel(float dt);
 			void IntegrateVelocity(float dt);
+			void SweepFastBodies(float dt);
 
 			void UpdateConstraints(float dt);
 
 			void UpdateCollisionList();
 			void UpdateObjectAABBs();
 
-			void ImpulseResolveCollision(GameObject& a , GameObject&b, CollisionDetection::ContactPoint& p) const;
+			void UpdateIslands();
+			int  FindIslandRoot(int id);
+			void AddIslandContact(GameObject* a, GameObject* b);
+
+			void AddContactManifold(const CollisionDetection::CollisionInfo& info);
+			void SolveContacts(float dt);
 
 			GameWorld& gameWorld;
 
 			bool	applyGravity;
 			Vector3 gravity;
-			float	dTOffset;
+			StepController stepController;
+			PhysicsProfiler	profiler;
 			float	globalDamping;
 
-			std::set<CollisionDetection::CollisionInfo> allCollisions;
-			std::set<CollisionDetection::CollisionInfo> broadphaseCollisions;
-			std::vector<CollisionDetection::CollisionInfo> broadphaseCollisionsVec;
-			bool useBroadPhase		= true;
+			CollisionPairCache allCollisions;
+			CollisionPairCache broadphaseCollisions;
+			int broadphaseStamp = 0;
+			BroadPhaseType broadPhaseType;
+
+			DynamicAABBTree<GameObject*>	broadphaseTree;
+			std::vector<int>				broadphaseProxies;	//tree leaf for each world ID, or -1
+			int								broadphaseWorldState = -1;
+
+			SweepAndPrune		broadphaseSweep;
+			SpatialHashGrid		broadphaseGrid;
+			QuadTree<GameObject*>	broadphaseQuadTree{ Vector2(64, 64), 7, 6 };
+			std::vector<std::pair<GameObject*, GameObject*>> broadphasePairs;
+
+			WorkerPool*	narrowPhaseWorkers = nullptr;
+			int			parallelNarrowPhaseMinPairs = 16;
+			std::vector<std::vector<CollisionDetection::CollisionInfo>> narrowPhaseResults;	//one list of contacts per worker
+			std::vector<CollisionDetection::IterationCounts> narrowPhaseCounts;	//and how many GJK and EPA iterations it took to find them
+			int constraintIterationCount = 10;
+
+			RigidBodyStore	bodies;	//what integration works on, refilled every substep
+
+			struct SweepTarget {
+				GameObject* object;
+				Vector3		boundsMin;
+				Vector3		boundsMax;
+			};
+			ContinuousCollision			continuousCollision;
+			std::vector<SweepTarget>	sweepTargets;	//the immovable objects fast ones are swept against
+
+			ContactSolver	contactSolver;
+			std::vector<CollisionDetection::CollisionInfo> contactManifolds;	//everything found this substep that needs resolving
 			int numCollisionFrames	= 5;
+
+			std::vector<std::pair<GameObject*, GameObject*>> islandContacts;
+			std::vector<int>	islandParents;
+			std::vector<bool>	islandRestless;
+
+			float	restLinearThreshold		= 0.1f;
+			float	restAngularThreshold	= 0.2f;
+			int		restSubstepCount		= 30;
+
+			bool		deterministic = false;
+			uint64_t	stepHash;
 		};
 	}
 }
@@ -1,4 +1,6 @@
 #pragma once
+#include <span>
+
 #include "Vector2.h"
 #include "CollisionDetection.h"
 #include "Debug.h"
@@ -22,131 +24,153 @@ namespace NCL {
 			}
 		};
 
+		/*
+		Nodes don't own their children any more - every node in a tree lives in
+		the tree's node array, and a node that has been split just knows where
+		its 4 children start in that array.
+		*/
 		template<class T>
-		class QuadTreeNode	{
-		public:
-			typedef std::function<void(std::list<QuadTreeEntry<T>>&)> QuadTreeFunc;
-		protected:
-			friend class QuadTree<T>;
-
-			QuadTreeNode() {}
+		struct QuadTreeNode	{
+			typedef std::function<void(std::span<QuadTreeEntry<T>>)> QuadTreeFunc;
 
 			QuadTreeNode(Vector2 pos, Vector2 size) {
-				children		= nullptr;
-				this->position	= pos;
+				position	= pos;
+				this->size	= size;
+				firstChild	= -1;
+			}
+
+			bool IsLeaf() const {
+				return firstChild < 0;
+			}
+
+			Vector2 position;
+			Vector2 size;
+			int		firstChild;
+		};
+	}
+}
+
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		/*
+		The tree's nodes are kept in one array, and each node's contents in a
+		matching array of entry lists. Clearing the tree just resets these
+		arrays back to a single empty root, without giving any of their memory
+		back, so a tree that gets rebuilt every frame only allocates while it is
+		growing to its biggest size.
+		*/
+		template<class T>
+		class QuadTree
+		{
+		public:
+			QuadTree(Vector2 size, int maxDepth = 6, int maxSize = 5){
 				this->size		= size;
+				this->maxDepth	= maxDepth;
+				this->maxSize	= maxSize;
+				Clear();
+			}
+			~QuadTree() {
+			}
+
+			void Clear() {
+				for (size_t i = 0; i < nodes.size(); ++i) {
+					contents[i].clear();
+				}
+				nodes.clear();
+				nodes.emplace_back(Vector2(), size);
+				if (contents.empty()) {
+					contents.emplace_back();
+				}
+			}
+
+			void Insert(T object, const Vector3& pos, const Vector3& size) {
+				Insert(0, object, pos, size, maxDepth);
+			}
+
+			void DebugDraw() {
 			}
 
-			~QuadTreeNode() {
-				delete[] children;
+			void OperateOnContents(typename QuadTreeNode<T>::QuadTreeFunc func) {
+				OperateOnContents(0, func);
 			}
 
-			void Insert(T& object, const Vector3& objectPos, const Vector3& objectSize, int depthLeft, int maxSize) {
-				if (!CollisionDetection::AABBTest(objectPos, Vector3(position.x, 0, position.y), objectSize, Vector3(size.x, 1000.0f, size.y)))
+		protected:
+			//nodes can move around as the array grows, so they're always referred to by index here
+			void Insert(int node, T& object, const Vector3& objectPos, const Vector3& objectSize, int depthLeft) {
+				Vector2 nodePos		= nodes[node].position;
+				Vector2 nodeSize	= nodes[node].size;
+				if (!CollisionDetection::AABBTest(objectPos, Vector3(nodePos.x, 0, nodePos.y), objectSize, Vector3(nodeSize.x, 1000.0f, nodeSize.y)))
 					return;
 
-				if (children)
+				if (!nodes[node].IsLeaf())
 				{
+					int firstChild = nodes[node].firstChild;
 					for (int i = 0; i < 4; i++)
 					{
-						children[i].Insert(object, objectPos, objectSize, depthLeft - 1, maxSize);
+						Insert(firstChild + i, object, objectPos, objectSize, depthLeft - 1);
 					}
 				}
 				else
 				{
-					contents.push_back(QuadTreeEntry<T>(object, objectPos, objectSize));
-					if ((int)contents.size() > maxSize && depthLeft > 0)
+					contents[node].emplace_back(object, objectPos, objectSize);
+					if ((int)contents[node].size() > maxSize && depthLeft > 0)
 					{
-						if (!children)
+						Split(node);
+						//reinsert contents so far
+						int firstChild = nodes[node].firstChild;
+						for (size_t i = 0; i < contents[node].size(); i++)
 						{
-							Split();
-							//reinsert contents so far
-							for (const auto& i : contents)
+							QuadTreeEntry<T> entry = contents[node][i];
+							for (int j = 0; j < 4; j++)
 							{
-								for (int j = 0; j < 4; j++)
-								{
-									auto entry = i;
-									children[j].Insert(entry.object, entry.pos, entry.size, depthLeft - 1, maxSize);
-								}
+								Insert(firstChild + j, entry.object, entry.pos, entry.size, depthLeft - 1);
 							}
-							contents.clear();	//contents now distributed!
 						}
+						contents[node].clear();	//contents now distributed!
 					}
 				}
 			}
 
-			void Split() {
-				Vector2 halfSize = size / 2.0f;
-				children = new QuadTreeNode<T>[4];
-				children[0] = QuadTreeNode<T>(position + Vector2(-halfSize.x, halfSize.y), halfSize);
-				children[1] = QuadTreeNode<T>(position + Vector2(halfSize.x, halfSize.y), halfSize);
-				children[2] = QuadTreeNode<T>(position + Vector2(-halfSize.x, -halfSize.y), halfSize);
-				children[3] = QuadTreeNode<T>(position + Vector2(halfSize.x, -halfSize.y), halfSize);
-			}
+			void Split(int node) {
+				Vector2 pos			= nodes[node].position;
+				Vector2 halfSize	= nodes[node].size / 2.0f;
 
-			void DebugDraw() {
+				nodes[node].firstChild = (int)nodes.size();
+				nodes.emplace_back(pos + Vector2(-halfSize.x, halfSize.y), halfSize);
+				nodes.emplace_back(pos + Vector2(halfSize.x, halfSize.y), halfSize);
+				nodes.emplace_back(pos + Vector2(-halfSize.x, -halfSize.y), halfSize);
+				nodes.emplace_back(pos + Vector2(halfSize.x, -halfSize.y), halfSize);
+
+				if (contents.size() < nodes.size()) {
+					contents.resize(nodes.size());
+				}
 			}
 
-			void OperateOnContents(QuadTreeFunc& func) {
-				if (children)
+			void OperateOnContents(int node, typename QuadTreeNode<T>::QuadTreeFunc& func) {
+				if (!nodes[node].IsLeaf())
 				{
 					for (int i = 0; i < 4; i++)
 					{
-						children[i].OperateOnContents(func);
+						OperateOnContents(nodes[node].firstChild + i, func);
 					}
 				}
 				else
 				{
-					if (!contents.empty())
+					if (!contents[node].empty())
 					{
-						func(contents);
+						func(std::span<QuadTreeEntry<T>>(contents[node]));
 					}
 				}
 			}
 
-		protected:
-			std::list< QuadTreeEntry<T> >	contents;
+			std::vector<QuadTreeNode<T>>				nodes;
+			std::vector<std::vector<QuadTreeEntry<T>>>	contents;	//one entry list per node, only used by leaves
 
-			Vector2 position;
 			Vector2 size;
-
-			QuadTreeNode<T>* children;
-		};
-	}
-}
-
-
-namespace NCL {
-	using namespace NCL::Maths;
-	namespace CSC8503 {
-		template<class T>
-		class QuadTree
-		{
-		public:
-			QuadTree(Vector2 size, int maxDepth = 6, int maxSize = 5){
-				root = QuadTreeNode<T>(Vector2(), size);
-				this->maxDepth	= maxDepth;
-				this->maxSize	= maxSize;
-			}
-			~QuadTree() {
-			}
-
-			void Insert(T object, const Vector3& pos, const Vector3& size) {
-				root.Insert(object, pos, size, maxDepth, maxSize);
-			}
-
-			void DebugDraw() {
-				root.DebugDraw();
-			}
-
-			void OperateOnContents(typename QuadTreeNode<T>::QuadTreeFunc  func) {
-				root.OperateOnContents(func);
-			}
-
-		protected:
-			QuadTreeNode<T> root;
 			int maxDepth;
 			int maxSize;
 		};
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,277 @@
+#include "RigidBodyStore.h"
+#include "GameWorld.h"
+#include "GameObject.h"
+#include "PhysicsObject.h"
+
+#if defined(__AVX__) || defined(_M_X64) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	/*
+	Just enough of a SIMD type for the integration kernels to be written
+	once - a block of LANE_COUNT floats, taken from the widest instruction
+	set the build was given.
+	*/
+#if defined(__AVX__)
+	const int LANE_COUNT = 8;
+	struct Lanes {
+		__m256 v;
+	};
+	inline Lanes Load(const float* p)				{ return { _mm256_loadu_ps(p) }; }
+	inline void  Store(float* p, Lanes a)			{ _mm256_storeu_ps(p, a.v); }
+	inline Lanes Set(float f)						{ return { _mm256_set1_ps(f) }; }
+	inline Lanes operator+(Lanes a, Lanes b)		{ return { _mm256_add_ps(a.v, b.v) }; }
+	inline Lanes operator-(Lanes a, Lanes b)		{ return { _mm256_sub_ps(a.v, b.v) }; }
+	inline Lanes operator*(Lanes a, Lanes b)		{ return { _mm256_mul_ps(a.v, b.v) }; }
+	inline Lanes operator/(Lanes a, Lanes b)		{ return { _mm256_div_ps(a.v, b.v) }; }
+	inline Lanes Sqrt(Lanes a)						{ return { _mm256_sqrt_ps(a.v) }; }
+#elif defined(_M_X64) || defined(__SSE2__)
+	const int LANE_COUNT = 4;
+	struct Lanes {
+		__m128 v;
+	};
+	inline Lanes Load(const float* p)				{ return { _mm_loadu_ps(p) }; }
+	inline void  Store(float* p, Lanes a)			{ _mm_storeu_ps(p, a.v); }
+	inline Lanes Set(float f)						{ return { _mm_set1_ps(f) }; }
+	inline Lanes operator+(Lanes a, Lanes b)		{ return { _mm_add_ps(a.v, b.v) }; }
+	inline Lanes operator-(Lanes a, Lanes b)		{ return { _mm_sub_ps(a.v, b.v) }; }
+	inline Lanes operator*(Lanes a, Lanes b)		{ return { _mm_mul_ps(a.v, b.v) }; }
+	inline Lanes operator/(Lanes a, Lanes b)		{ return { _mm_div_ps(a.v, b.v) }; }
+	inline Lanes Sqrt(Lanes a)						{ return { _mm_sqrt_ps(a.v) }; }
+#else
+	const int LANE_COUNT = 1;
+	struct Lanes {
+		float v;
+	};
+	inline Lanes Load(const float* p)				{ return { *p }; }
+	inline void  Store(float* p, Lanes a)			{ *p = a.v; }
+	inline Lanes Set(float f)						{ return { f }; }
+	inline Lanes operator+(Lanes a, Lanes b)		{ return { a.v + b.v }; }
+	inline Lanes operator-(Lanes a, Lanes b)		{ return { a.v - b.v }; }
+	inline Lanes operator*(Lanes a, Lanes b)		{ return { a.v * b.v }; }
+	inline Lanes operator/(Lanes a, Lanes b)		{ return { a.v / b.v }; }
+	inline Lanes Sqrt(Lanes a)						{ return { sqrt(a.v) }; }
+#endif
+}
+
+void RigidBodyStore::Resize(int count) {
+	int padded = ((count + LANE_COUNT - 1) / LANE_COUNT) * LANE_COUNT;
+
+	for (std::vector<float>* a : { &px, &py, &pz, &qx, &qy, &qz, &vx, &vy, &vz, &wx, &wy, &wz,
+		&fx, &fy, &fz, &tx, &ty, &tz, &inverseMass, &gravityScale, &linearDamping, &angularDamping,
+		&ix, &iy, &iz, &i00, &i01, &i02, &i11, &i12, &i22 }) {
+		a->assign(padded, 0.0f);
+	}
+	qw.assign(padded, 1.0f);
+	stepFraction.assign(padded, 1.0f);
+}
+
+void RigidBodyStore::Gather(GameWorld& world, bool applyGravity) {
+	objects.clear();
+	world.OperateOnContents(
+		[&](GameObject* o) {
+			PhysicsObject* object = o->GetPhysicsObject();
+			if (object && !object->IsAsleep()) {
+				objects.emplace_back(o);
+			}
+		}
+	);
+	bodyCount = (int)objects.size();
+	Resize(bodyCount);
+
+	for (int i = 0; i < bodyCount; ++i) {
+		GameObject*		o		= objects[i];
+		PhysicsObject*	object	= o->GetPhysicsObject();
+		const Transform& transform = o->GetTransform();
+
+		Vector3		position	= transform.GetPosition();
+		Quaternion	orientation	= transform.GetOrientation();
+		Vector3		linearVel	= object->GetLinearVelocity();
+		Vector3		angVel		= object->GetAngularVelocity();
+		Vector3		inertia		= object->GetInverseInertia();
+
+		px[i] = position.x;		py[i] = position.y;		pz[i] = position.z;
+		qx[i] = orientation.x;	qy[i] = orientation.y;	qz[i] = orientation.z;	qw[i] = orientation.w;
+		vx[i] = linearVel.x;	vy[i] = linearVel.y;	vz[i] = linearVel.z;
+		wx[i] = angVel.x;		wy[i] = angVel.y;		wz[i] = angVel.z;
+		ix[i] = inertia.x;		iy[i] = inertia.y;		iz[i] = inertia.z;
+
+		inverseMass[i]		= object->GetInverseMass();
+		linearDamping[i]	= object->GetFrameLinearDampingCoeff();
+		angularDamping[i]	= object->GetFrameAngularDampingCoeff();
+
+		//inactive objects still move, but nothing pushes them
+		if (o->IsActive()) {
+			Vector3 force	= object->GetForce();
+			Vector3 torque	= object->GetTorque();
+			fx[i] = force.x;	fy[i] = force.y;	fz[i] = force.z;
+			tx[i] = torque.x;	ty[i] = torque.y;	tz[i] = torque.z;
+			gravityScale[i] = (applyGravity && object->useGravity && inverseMass[i] > 0) ? 1.0f : 0.0f;
+		}
+	}
+}
+
+/*
+The world space inverse inertia tensor is R * I^-1 * R^T, where R is the
+object's orientation as a matrix, and I^-1 is its (diagonal) local inverse
+inertia. Written out in full, only six of its entries are different.
+*/
+void RigidBodyStore::IntegrateAccel(float dt, const Vector3& gravity) {
+	int paddedCount = (int)px.size();
+
+	Lanes t		= Set(dt);
+	Lanes gx	= Set(gravity.x);
+	Lanes gy	= Set(gravity.y);
+	Lanes gz	= Set(gravity.z);
+	Lanes one	= Set(1.0f);
+	Lanes two	= Set(2.0f);
+
+	for (int i = 0; i < paddedCount; i += LANE_COUNT) {
+		Lanes im = Load(&inverseMass[i]);
+		Lanes gs = Load(&gravityScale[i]);
+
+		Store(&vx[i], Load(&vx[i]) + (Load(&fx[i]) * im + gx * gs) * t);
+		Store(&vy[i], Load(&vy[i]) + (Load(&fy[i]) * im + gy * gs) * t);
+		Store(&vz[i], Load(&vz[i]) + (Load(&fz[i]) * im + gz * gs) * t);
+
+		Lanes x = Load(&qx[i]);
+		Lanes y = Load(&qy[i]);
+		Lanes z = Load(&qz[i]);
+		Lanes w = Load(&qw[i]);
+
+		//the rows of R
+		Lanes r00 = one - two * y * y - two * z * z;
+		Lanes r01 = two * x * y - two * z * w;
+		Lanes r02 = two * x * z + two * y * w;
+		Lanes r10 = two * x * y + two * z * w;
+		Lanes r11 = one - two * x * x - two * z * z;
+		Lanes r12 = two * y * z - two * x * w;
+		Lanes r20 = two * x * z - two * y * w;
+		Lanes r21 = two * y * z + two * x * w;
+		Lanes r22 = one - two * x * x - two * y * y;
+
+		Lanes dx = Load(&ix[i]);
+		Lanes dy = Load(&iy[i]);
+		Lanes dz = Load(&iz[i]);
+
+		Lanes m00 = r00 * dx * r00 + r01 * dy * r01 + r02 * dz * r02;
+		Lanes m01 = r00 * dx * r10 + r01 * dy * r11 + r02 * dz * r12;
+		Lanes m02 = r00 * dx * r20 + r01 * dy * r21 + r02 * dz * r22;
+		Lanes m11 = r10 * dx * r10 + r11 * dy * r11 + r12 * dz * r12;
+		Lanes m12 = r10 * dx * r20 + r11 * dy * r21 + r12 * dz * r22;
+		Lanes m22 = r20 * dx * r20 + r21 * dy * r21 + r22 * dz * r22;
+
+		Store(&i00[i], m00);	Store(&i01[i], m01);	Store(&i02[i], m02);
+		Store(&i11[i], m11);	Store(&i12[i], m12);	Store(&i22[i], m22);
+
+		Lanes ax = Load(&tx[i]);
+		Lanes ay = Load(&ty[i]);
+		Lanes az = Load(&tz[i]);
+
+		Store(&wx[i], Load(&wx[i]) + (m00 * ax + m01 * ay + m02 * az) * t);
+		Store(&wy[i], Load(&wy[i]) + (m01 * ax + m11 * ay + m12 * az) * t);
+		Store(&wz[i], Load(&wz[i]) + (m02 * ax + m12 * ay + m22 * az) * t);
+	}
+}
+
+void RigidBodyStore::WriteAccel() {
+	for (int i = 0; i < bodyCount; ++i) {
+		PhysicsObject* object = objects[i]->GetPhysicsObject();
+		object->SetLinearVelocity(Vector3(vx[i], vy[i], vz[i]));
+		object->SetAngularVelocity(Vector3(wx[i], wy[i], wz[i]));
+
+		Matrix3 tensor;
+		tensor.array[0][0] = i00[i];	tensor.array[0][1] = i01[i];	tensor.array[0][2] = i02[i];
+		tensor.array[1][0] = i01[i];	tensor.array[1][1] = i11[i];	tensor.array[1][2] = i12[i];
+		tensor.array[2][0] = i02[i];	tensor.array[2][1] = i12[i];	tensor.array[2][2] = i22[i];
+		object->SetInertiaTensor(tensor);
+	}
+}
+
+void RigidBodyStore::ReadVelocities() {
+	for (int i = 0; i < bodyCount; ++i) {
+		PhysicsObject* object = objects[i]->GetPhysicsObject();
+		Vector3 linearVel	= object->GetLinearVelocity();
+		Vector3 angVel		= object->GetAngularVelocity();
+		vx[i] = linearVel.x;	vy[i] = linearVel.y;	vz[i] = linearVel.z;
+		wx[i] = angVel.x;		wy[i] = angVel.y;		wz[i] = angVel.z;
+	}
+}
+
+/*
+Orientation is stepped on in the same way as it always has been here, by
+adding (w * dt / 2, 0.05) * q to q and normalising the result.
+*/
+void RigidBodyStore::IntegrateVelocity(float dt) {
+	int paddedCount = (int)px.size();
+
+	Lanes t		= Set(dt);
+	Lanes half	= Set(dt * 0.5f);
+	Lanes one	= Set(1.0f);
+	Lanes aw	= Set(0.05f);
+
+	for (int i = 0; i < paddedCount; i += LANE_COUNT) {
+		Lanes fraction	= Load(&stepFraction[i]);
+		Lanes move		= t * fraction;
+
+		Lanes lx = Load(&vx[i]);
+		Lanes ly = Load(&vy[i]);
+		Lanes lz = Load(&vz[i]);
+
+		Store(&px[i], Load(&px[i]) + lx * move);
+		Store(&py[i], Load(&py[i]) + ly * move);
+		Store(&pz[i], Load(&pz[i]) + lz * move);
+
+		Lanes linearScale = one - Load(&linearDamping[i]) * t;
+		Store(&vx[i], lx * linearScale);
+		Store(&vy[i], ly * linearScale);
+		Store(&vz[i], lz * linearScale);
+
+		Lanes ax = Load(&wx[i]);
+		Lanes ay = Load(&wy[i]);
+		Lanes az = Load(&wz[i]);
+
+		Lanes turn = half * fraction;
+		Lanes sx = ax * turn;
+		Lanes sy = ay * turn;
+		Lanes sz = az * turn;
+
+		Lanes x = Load(&qx[i]);
+		Lanes y = Load(&qy[i]);
+		Lanes z = Load(&qz[i]);
+		Lanes w = Load(&qw[i]);
+
+		Lanes nx = x + ((sx * w) + (aw * x) + (sy * z) - (sz * y));
+		Lanes ny = y + ((sy * w) + (aw * y) + (sz * x) - (sx * z));
+		Lanes nz = z + ((sz * w) + (aw * z) + (sx * y) - (sy * x));
+		Lanes nw = w + ((aw * w) - (sx * x) - (sy * y) - (sz * z));
+
+		Lanes scale = one / Sqrt(nx * nx + ny * ny + nz * nz + nw * nw);
+		Store(&qx[i], nx * scale);
+		Store(&qy[i], ny * scale);
+		Store(&qz[i], nz * scale);
+		Store(&qw[i], nw * scale);
+
+		Lanes angularScale = one - Load(&angularDamping[i]) * t;
+		Store(&wx[i], ax * angularScale);
+		Store(&wy[i], ay * angularScale);
+		Store(&wz[i], az * angularScale);
+	}
+}
+
+void RigidBodyStore::WriteVelocity() {
+	for (int i = 0; i < bodyCount; ++i) {
+		GameObject*		o		= objects[i];
+		PhysicsObject*	object	= o->GetPhysicsObject();
+
+		o->GetTransform()
+			.SetPosition(Vector3(px[i], py[i], pz[i]))
+			.SetOrientation(Quaternion(qx[i], qy[i], qz[i], qw[i]));
+		object->SetLinearVelocity(Vector3(vx[i], vy[i], vz[i]));
+		object->SetAngularVelocity(Vector3(wx[i], wy[i], wz[i]));
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "Vector3.h"
+#include <vector>
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		class GameObject;
+		class GameWorld;
+
+		/*
+		Integration does the same small sums for every moving object, but
+		going through each GameObject to its PhysicsObject and Transform to
+		get at them means a pointer chase and a handful of Vector3 copies per
+		object, and nothing for the compiler to vectorise. So the physics
+		system copies what integration needs out into this store first, one
+		array per component (every object's x position together, then every
+		y, and so on), and runs the sums over whole blocks of objects at once
+		with SIMD instructions - 8 objects at a time with AVX (when built
+		with the USE_AVX2 CMake option), 4 with SSE, or one at a time where
+		neither is available. The results are copied back once a step is
+		done.
+
+		The arrays are padded out to a whole number of blocks, and the
+		padding is given harmless values (a zero mass, an identity
+		orientation) so the last block needs no special treatment. Only
+		adds, multiplies, divides and square roots are used, which give the
+		same answer whatever the block size, so results don't change between
+		machines with and without AVX.
+		*/
+		class RigidBodyStore {
+		public:
+			RigidBodyStore() {}
+			~RigidBodyStore() {}
+
+			//copies out every awake object with physics - gravity is only applied to those that want it
+			void Gather(GameWorld& world, bool applyGravity);
+
+			//v += a * dt and w += I^-1 * torque * dt, along with each object's world space inverse inertia tensor
+			void IntegrateAccel(float dt, const Vector3& gravity);
+			void WriteAccel();
+
+			//picks up velocity changes made since IntegrateAccel, by the contact solver and constraints
+			void ReadVelocities();
+
+			//moves and rotates by the velocities, then damps them
+			void IntegrateVelocity(float dt);
+
+			//only moves the object for part of the next IntegrateVelocity - reset to all of it by Gather
+			void SetStepFraction(int i, float fraction) {
+				stepFraction[i] = fraction;
+			}
+			void WriteVelocity();
+
+			int Size() const {
+				return bodyCount;
+			}
+
+			GameObject* GetObject(int i) const {
+				return objects[i];
+			}
+
+		protected:
+			void Resize(int count);
+
+			std::vector<GameObject*> objects;
+			int bodyCount = 0;
+
+			std::vector<float> px, py, pz;
+			std::vector<float> qx, qy, qz, qw;
+			std::vector<float> vx, vy, vz;
+			std::vector<float> wx, wy, wz;
+			std::vector<float> fx, fy, fz;
+			std::vector<float> tx, ty, tz;
+			std::vector<float> stepFraction;	//how much of the substep each object moves for
+
+			std::vector<float> inverseMass;
+			std::vector<float> gravityScale;	//1 for objects affected by gravity, otherwise 0
+			std::vector<float> linearDamping;
+			std::vector<float> angularDamping;
+
+			std::vector<float> ix, iy, iz;	//local inverse inertia
+			std::vector<float> i00, i01, i02, i11, i12, i22;	//world inverse inertia tensor, which is symmetric
+		};
+	}
+}
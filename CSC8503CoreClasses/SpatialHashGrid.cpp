@@ -0,0 +1,100 @@
+#include "SpatialHashGrid.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+SpatialHashGrid::SpatialHashGrid(float cellSize, int maxCells) {
+	this->cellSize	= cellSize;
+	this->maxCells	= maxCells;
+}
+
+void SpatialHashGrid::Clear() {
+	boxes.clear();
+	entries.clear();
+	oversized.clear();
+}
+
+int SpatialHashGrid::CellCoord(float f) const {
+	return (int)std::floor(f / cellSize);
+}
+
+//21 bits per axis gives each axis a million cells either side of the origin
+uint64_t SpatialHashGrid::CellKey(int x, int y, int z) const {
+	const uint64_t mask = (1ull << 21) - 1;
+	const int bias		= 1 << 20;
+	return	(((uint64_t)(x + bias) & mask) << 42) |
+			(((uint64_t)(y + bias) & mask) << 21) |
+			((uint64_t)(z + bias) & mask);
+}
+
+bool SpatialHashGrid::Overlaps(const Box& a, const Box& b) {
+	return	a.min.x <= b.max.x && a.max.x >= b.min.x &&
+			a.min.y <= b.max.y && a.max.y >= b.min.y &&
+			a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+void SpatialHashGrid::Insert(GameObject* object, const Vector3& min, const Vector3& max) {
+	int id = (int)boxes.size();
+	boxes.push_back({ min, max, object });
+
+	int minX = CellCoord(min.x), maxX = CellCoord(max.x);
+	int minY = CellCoord(min.y), maxY = CellCoord(max.y);
+	int minZ = CellCoord(min.z), maxZ = CellCoord(max.z);
+
+	int64_t cellCount = (int64_t)(maxX - minX + 1) * (maxY - minY + 1) * (maxZ - minZ + 1);
+	if (cellCount > maxCells) {
+		oversized.push_back(id);
+		return;
+	}
+	for (int x = minX; x <= maxX; ++x) {
+		for (int y = minY; y <= maxY; ++y) {
+			for (int z = minZ; z <= maxZ; ++z) {
+				entries.push_back({ CellKey(x, y, z), id });
+			}
+		}
+	}
+}
+
+void SpatialHashGrid::FindPairs(std::vector<Pair>& pairs) {
+	pairs.clear();
+
+	std::sort(entries.begin(), entries.end());
+
+	size_t runStart = 0;
+	while (runStart < entries.size()) {
+		size_t runEnd = runStart + 1;
+		while (runEnd < entries.size() && entries[runEnd].cell == entries[runStart].cell) {
+			++runEnd;
+		}
+		uint64_t cell = entries[runStart].cell;
+		for (size_t i = runStart; i < runEnd; ++i) {
+			const Box& a = boxes[entries[i].box];
+			for (size_t j = i + 1; j < runEnd; ++j) {
+				const Box& b = boxes[entries[j].box];
+				if (!Overlaps(a, b)) {
+					continue;
+				}
+				//only the cell holding the corner the overlap starts at gets to report it
+				Vector3 overlapStart(std::max(a.min.x, b.min.x), std::max(a.min.y, b.min.y), std::max(a.min.z, b.min.z));
+				if (CellKey(CellCoord(overlapStart.x), CellCoord(overlapStart.y), CellCoord(overlapStart.z)) != cell) {
+					continue;
+				}
+				pairs.emplace_back(a.object, b.object);
+			}
+		}
+		runStart = runEnd;
+	}
+
+	for (size_t i = 0; i < oversized.size(); ++i) {
+		const Box& a = boxes[oversized[i]];
+		for (int j = 0; j < (int)boxes.size(); ++j) {
+			//pairs of oversized boxes are only tested the once
+			if (j == oversized[i] || (j < oversized[i] && std::find(oversized.begin(), oversized.end(), j) != oversized.end())) {
+				continue;
+			}
+			if (Overlaps(a, boxes[j])) {
+				pairs.emplace_back(a.object, boxes[j].object);
+			}
+		}
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "Vector3.h"
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		class GameObject;
+
+		/*
+		A uniform grid of cubic cells covering all 3 axes, so unlike the
+		QuadTree, objects stacked on top of each other end up in different
+		cells. The grid is never stored as a grid - every box just adds an
+		entry for each cell it touches, keyed on that cell's coordinates, and
+		sorting the entries by key brings everything in the same cell together.
+
+		A pair of boxes sharing more than one cell is only reported by the cell
+		their overlap starts in, so no pair comes out twice. Boxes touching more
+		than maxCells cells (like the floor) would swamp the entry list, so
+		they're kept to one side and tested against every other box instead.
+		*/
+		class SpatialHashGrid {
+		public:
+			typedef std::pair<GameObject*, GameObject*> Pair;
+
+			SpatialHashGrid(float cellSize = 2.0f, int maxCells = 64);
+			~SpatialHashGrid() {}
+
+			void Clear();
+
+			void Insert(GameObject* object, const Vector3& min, const Vector3& max);
+
+			//fills pairs with every pair of overlapping boxes
+			void FindPairs(std::vector<Pair>& pairs);
+
+			void SetCellSize(float size) {
+				cellSize = size;
+			}
+
+			float GetCellSize() const {
+				return cellSize;
+			}
+
+		protected:
+			struct Box {
+				Vector3		min;
+				Vector3		max;
+				GameObject* object;
+			};
+
+			struct Entry {
+				uint64_t	cell;
+				int			box;
+
+				bool operator<(const Entry& other) const {
+					return cell < other.cell || (cell == other.cell && box < other.box);
+				}
+			};
+
+			int			CellCoord(float f) const;
+			uint64_t	CellKey(int x, int y, int z) const;
+
+			static bool Overlaps(const Box& a, const Box& b);
+
+			std::vector<Box>	boxes;
+			std::vector<Entry>	entries;
+			std::vector<int>	oversized;	//boxes too big to be put in cells
+
+			float	cellSize;
+			int		maxCells;
+		};
+	}
+}
@@ -0,0 +1,67 @@
+#include "StepController.h"
+#include <algorithm>
+
+using namespace NCL;
+using namespace CSC8503;
+
+StepController::StepController(int idealHZ) {
+	adaptive		= true;
+	maxSubsteps		= 8;
+	accumulator		= 0.0f;
+	lastSubsteps	= 0;
+	lastTimeMS		= 0.0f;
+	droppedTime		= 0.0f;
+	budgetMS		= 0.0f;
+	SetIdealRate(idealHZ);
+}
+
+void StepController::SetIdealRate(int hz) {
+	idealHZ		= hz;
+	currentHZ	= hz;
+}
+
+void StepController::SetAdaptive(bool state) {
+	adaptive = state;
+	if (!adaptive) {
+		currentHZ = idealHZ;
+	}
+}
+
+int StepController::BeginFrame(float dt) {
+	accumulator += dt; //We accumulate time delta here - there might be remainders from previous frame!
+
+	float stepDT	= GetStepDT();
+	int substeps	= 0;
+	while (accumulator > stepDT) {
+		accumulator -= stepDT;
+		substeps++;
+	}
+	if (substeps > maxSubsteps) {
+		droppedTime	+= (substeps - maxSubsteps) * stepDT;
+		substeps	= maxSubsteps;
+	}
+	lastSubsteps = substeps;
+	return substeps;
+}
+
+void StepController::EndFrame(float secondsTaken) {
+	lastTimeMS = secondsTaken * 1000.0f;
+
+	if (!adaptive) {
+		return;
+	}
+	//Uh oh, physics is taking too long...
+	if (lastTimeMS > GetBudget()) {
+		currentHZ = std::max(currentHZ / 2, 1);
+	}
+	//doubling the rate doubles the substeps and (usually) halves the budget, so
+	//it needs to be well under a quarter of it to not just drop straight back
+	else if (lastTimeMS * 5 < GetBudget()) { //we have plenty of room to increase iteration count!
+		currentHZ = std::min(currentHZ * 2, idealHZ);
+	}
+}
+
+void StepController::RecordFrame(int substeps, float secondsTaken) {
+	lastSubsteps	= substeps;
+	lastTimeMS		= secondsTaken * 1000.0f;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		Decides how many fixed substeps each PhysicsSystem::Update should
+		run, and how long each one is. Frame time builds up until there's
+		enough for a whole substep, and any remainder carries over to the
+		next frame.
+
+		If a frame's physics takes longer than the budget, the substep rate
+		is halved (so each frame needs fewer, longer substeps), and once
+		frames leave plenty of room, it's doubled back up towards the
+		ideal rate. Unless a fixed budget is set, the budget is the length
+		of a substep at the current rate, so it grows as the rate drops,
+		and the rate settles wherever the physics can keep up.
+		However slow things get, a frame never runs more than the max
+		substeps - otherwise a slow frame means more time to catch up on
+		next frame, which makes that frame slower still, and so on. Any
+		time that can't be caught up on is dropped instead.
+
+		Each PhysicsSystem has its own, so separate worlds can run side by
+		side without changing each other's rates.
+		*/
+		class StepController {
+		public:
+			StepController(int idealHZ = 120);
+			~StepController() {}
+
+			//returns how many substeps of GetStepDT seconds to run for a frame dt seconds long
+			int BeginFrame(float dt);
+			//adapts the rate to how long that frame's substeps took
+			void EndFrame(float secondsTaken);
+
+			//for steppers that pick their own substeps, so the telemetry still covers them
+			void RecordFrame(int substeps, float secondsTaken);
+
+			void SetIdealRate(int hz);
+
+			int GetIdealHZ() const {
+				return idealHZ;
+			}
+
+			//a fixed controller always steps at the ideal rate
+			void SetAdaptive(bool state);
+
+			bool IsAdaptive() const {
+				return adaptive;
+			}
+
+			//0 goes back to using the length of a substep at the current rate
+			void SetBudget(float milliseconds) {
+				budgetMS = milliseconds;
+			}
+
+			float GetBudget() const {
+				return budgetMS > 0.0f ? budgetMS : 1000.0f / currentHZ;
+			}
+
+			void SetMaxSubsteps(int count) {
+				maxSubsteps = count;
+			}
+
+			int GetMaxSubsteps() const {
+				return maxSubsteps;
+			}
+
+			float GetStepDT() const {
+				return 1.0f / currentHZ;
+			}
+
+			int GetCurrentHZ() const {
+				return currentHZ;
+			}
+
+			//telemetry for the most recent frame
+			int GetSubstepsTaken() const {
+				return lastSubsteps;
+			}
+
+			float GetTimeSpent() const {
+				return lastTimeMS;
+			}
+
+			//seconds of frame time thrown away by the max substeps limit, since the controller was made
+			float GetDroppedTime() const {
+				return droppedTime;
+			}
+
+		protected:
+			int		idealHZ;
+			int		currentHZ;
+			bool	adaptive;
+			float	budgetMS;		//0 for one substep at the current rate
+			int		maxSubsteps;
+
+			float	accumulator;	//frame time not yet stepped
+			int		lastSubsteps;
+			float	lastTimeMS;
+			float	droppedTime;
+		};
+	}
+}
@@ -0,0 +1,146 @@
+#pragma once
+#include "Vector3.h"
+#include <cfloat>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SUPPORT_TABLE_USE_SSE
+#endif
+
+namespace NCL {
+	/*
+	The dice find their support points by picking the corner that points the
+	most in the search direction. Rather than normalising every corner on
+	every call, the directions to each corner are worked out once, and kept
+	as separate x, y and z arrays, so 4 corners can be tested at once. The
+	arrays are padded out to a multiple of 4 with copies of the first corner,
+	which can never win over the real one, as ties always go to the lowest
+	index - the same corner the plain loop would have picked.
+
+	Dice with lots of corners can also have the corners next to each other
+	stored. HillClimb then starts at the corner that's best for the search
+	direction's octant, and keeps stepping to whichever neighbour is better,
+	until none are. As the shape is convex, wherever it stops is the best
+	corner, and it gets there without looking at most of them.
+	*/
+	template<int N>
+	class SupportTable {
+	public:
+		static const int PADDED			= (N + 3) & ~3;
+		static const int MAX_NEIGHBOURS	= 6;
+
+		SupportTable() {
+			for (int i = 0; i < N; ++i) {
+				neighbourCount[i] = 0;
+			}
+		}
+
+		//normalise picks corners by their direction alone, as the older dice do. Dice whose corners aren't all the same distance from the centre need the corners as they are
+		void Build(const Maths::Vector3* verts, bool normalise = true) {
+			for (int i = 0; i < PADDED; ++i) {
+				Maths::Vector3 d = normalise ? verts[i < N ? i : 0].Normalised() : verts[i < N ? i : 0];
+				x[i] = d.x;
+				y[i] = d.y;
+				z[i] = d.z;
+			}
+		}
+
+		//corners are neighbours if they're joined by an edge of (roughly) the given length
+		void BuildNeighbours(const Maths::Vector3* verts, float edgeLength) {
+			for (int i = 0; i < N; ++i) {
+				neighbourCount[i] = 0;
+				for (int j = 0; j < N; ++j) {
+					if (i != j && neighbourCount[i] < MAX_NEIGHBOURS && (verts[i] - verts[j]).Length() < edgeLength * 1.1f) {
+						neighbours[i][neighbourCount[i]++] = j;
+					}
+				}
+			}
+			for (int i = 0; i < 8; ++i) {
+				octantStart[i] = ArgMax(Maths::Vector3(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f));
+			}
+		}
+
+		//the corner furthest along dir (or for a normalised table, the one whose direction is closest to it) - dir doesn't need to be normalised
+		int ArgMax(const Maths::Vector3& dir) const {
+#ifdef SUPPORT_TABLE_USE_SSE
+			__m128 dx = _mm_set1_ps(dir.x);
+			__m128 dy = _mm_set1_ps(dir.y);
+			__m128 dz = _mm_set1_ps(dir.z);
+
+			__m128	bestDot		= _mm_set1_ps(-FLT_MAX);
+			__m128i	bestIndex	= _mm_setzero_si128();
+			__m128i	index		= _mm_setr_epi32(0, 1, 2, 3);
+			const __m128i four	= _mm_set1_epi32(4);
+
+			for (int i = 0; i < PADDED; i += 4) {
+				__m128 dot = _mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(dx, _mm_load_ps(x + i)),
+					_mm_mul_ps(dy, _mm_load_ps(y + i))),
+					_mm_mul_ps(dz, _mm_load_ps(z + i)));
+				__m128 better = _mm_cmpgt_ps(dot, bestDot);
+				bestDot		= _mm_or_ps(_mm_and_ps(better, dot), _mm_andnot_ps(better, bestDot));
+				bestIndex	= _mm_or_si128(_mm_and_si128(_mm_castps_si128(better), index), _mm_andnot_si128(_mm_castps_si128(better), bestIndex));
+				index		= _mm_add_epi32(index, four);
+			}
+
+			alignas(16) float	laneDot[4];
+			alignas(16) int		laneIndex[4];
+			_mm_store_ps(laneDot, bestDot);
+			_mm_store_si128((__m128i*)laneIndex, bestIndex);
+
+			int best = 0;
+			for (int i = 1; i < 4; ++i) {
+				if (laneDot[i] > laneDot[best] || (laneDot[i] == laneDot[best] && laneIndex[i] < laneIndex[best])) {
+					best = i;
+				}
+			}
+			return laneIndex[best];
+#else
+			float	bestDot		= -FLT_MAX;
+			int		bestIndex	= 0;
+			for (int i = 0; i < N; ++i) {
+				float dot = dir.x * x[i] + dir.y * y[i] + dir.z * z[i];
+				if (dot > bestDot) {
+					bestDot		= dot;
+					bestIndex	= i;
+				}
+			}
+			return bestIndex;
+#endif
+		}
+
+		//needs BuildNeighbours to have been called first
+		int HillClimb(const Maths::Vector3& dir) const {
+			int current = octantStart[(dir.x > 0 ? 1 : 0) | (dir.y > 0 ? 2 : 0) | (dir.z > 0 ? 4 : 0)];
+			float currentDot = Dot(dir, current);
+			while (true) {
+				int next = current;
+				for (int i = 0; i < neighbourCount[current]; ++i) {
+					int n = neighbours[current][i];
+					float dot = Dot(dir, n);
+					if (dot > currentDot) {
+						currentDot	= dot;
+						next		= n;
+					}
+				}
+				if (next == current) {
+					return current;
+				}
+				current = next;
+			}
+		}
+
+	protected:
+		float Dot(const Maths::Vector3& dir, int i) const {
+			return dir.x * x[i] + dir.y * y[i] + dir.z * z[i];
+		}
+
+		alignas(16) float x[PADDED];
+		alignas(16) float y[PADDED];
+		alignas(16) float z[PADDED];
+
+		int neighbours[N][MAX_NEIGHBOURS];
+		int neighbourCount[N];
+		int octantStart[8];
+	};
+}
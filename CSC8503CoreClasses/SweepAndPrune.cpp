@@ -0,0 +1,179 @@
+#include "SweepAndPrune.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SWEEP_USE_SSE
+#endif
+
+using namespace NCL;
+using namespace CSC8503;
+
+SweepAndPrune::SweepAndPrune() {
+	sortAxis = 0;
+}
+
+void SweepAndPrune::Clear() {
+	boxes.clear();
+	sortedIDs.clear();
+}
+
+void SweepAndPrune::SetBox(int id, GameObject* object, const Vector3& min, const Vector3& max) {
+	if (id >= (int)boxes.size()) {
+		boxes.resize(id + 1, Box{ Vector3(), Vector3(), nullptr, false });
+	}
+	Box& b = boxes[id];
+	b.min		= min;
+	b.max		= max;
+	b.object	= object;
+	if (!b.inList) {
+		b.inList = true;
+		sortedIDs.emplace_back(id); //the next sort will move it to where it belongs
+	}
+}
+
+void SweepAndPrune::RemoveBox(int id) {
+	if (id >= (int)boxes.size() || !boxes[id].inList) {
+		return;
+	}
+	boxes[id].inList = false;
+	sortedIDs.erase(std::find(sortedIDs.begin(), sortedIDs.end(), id));
+}
+
+/*
+The axis the box centres vary along the most will separate the most boxes out,
+and so leave the fewest boxes to check on the other axes. On the dice tray this
+will be one of the horizontal axes, rather than up, where everything is sat on
+the floor!
+*/
+void SweepAndPrune::ChooseSortAxis() {
+	if (sortedIDs.size() < 2) {
+		return;
+	}
+	Vector3 sum;
+	Vector3 sumSq;
+	for (int id : sortedIDs) {
+		Vector3 c = (boxes[id].min + boxes[id].max) * 0.5f;
+		sum		+= c;
+		sumSq	+= c * c;
+	}
+	float n = (float)sortedIDs.size();
+	Vector3 variance = (sumSq / n) - ((sum / n) * (sum / n));
+
+	sortAxis = 0;
+	if (variance.y > variance[sortAxis]) {
+		sortAxis = 1;
+	}
+	if (variance.z > variance[sortAxis]) {
+		sortAxis = 2;
+	}
+}
+
+void SweepAndPrune::SortList() {
+	for (size_t i = 1; i < sortedIDs.size(); ++i) {
+		int		id	= sortedIDs[i];
+		float	key = boxes[id].min[sortAxis];
+		size_t	j	= i;
+		while (j > 0 && boxes[sortedIDs[j - 1]].min[sortAxis] > key) {
+			sortedIDs[j] = sortedIDs[j - 1];
+			--j;
+		}
+		sortedIDs[j] = id;
+	}
+}
+
+/*
+Copies the sorted boxes out into flat arrays. These are padded out with 4
+boxes that start at infinity along the sort axis, so the sweep can always read
+4 boxes at a time, and knows to stop when it hits them.
+*/
+void SweepAndPrune::GatherSorted() {
+	int axisA = (sortAxis + 1) % 3;
+	int axisB = (sortAxis + 2) % 3;
+
+	size_t count	= sortedIDs.size();
+	size_t padded	= count + 4;
+
+	sortMin.resize(padded);
+	axisMin[0].resize(padded);
+	axisMax[0].resize(padded);
+	axisMin[1].resize(padded);
+	axisMax[1].resize(padded);
+	sortedObjects.resize(padded);
+
+	for (size_t i = 0; i < count; ++i) {
+		const Box& b = boxes[sortedIDs[i]];
+		sortMin[i]			= b.min[sortAxis];
+		axisMin[0][i]		= b.min[axisA];
+		axisMax[0][i]		= b.max[axisA];
+		axisMin[1][i]		= b.min[axisB];
+		axisMax[1][i]		= b.max[axisB];
+		sortedObjects[i]	= b.object;
+	}
+	for (size_t i = count; i < padded; ++i) {
+		sortMin[i]			= FLT_MAX;
+		axisMin[0][i]		= FLT_MAX;
+		axisMax[0][i]		= -FLT_MAX;
+		axisMin[1][i]		= FLT_MAX;
+		axisMax[1][i]		= -FLT_MAX;
+		sortedObjects[i]	= nullptr;
+	}
+}
+
+void SweepAndPrune::FindPairs(std::vector<Pair>& pairs) {
+	pairs.clear();
+
+	ChooseSortAxis();
+	SortList();
+	GatherSorted();
+
+	int count = (int)sortedIDs.size();
+	int axisA = (sortAxis + 1) % 3;
+	int axisB = (sortAxis + 2) % 3;
+
+	for (int i = 0; i < count; ++i) {
+		const Box& b = boxes[sortedIDs[i]];
+		float sortMax = b.max[sortAxis];
+
+#ifdef SWEEP_USE_SSE
+		__m128 maxS	= _mm_set1_ps(sortMax);
+		__m128 minA	= _mm_set1_ps(b.min[axisA]);
+		__m128 maxA	= _mm_set1_ps(b.max[axisA]);
+		__m128 minB	= _mm_set1_ps(b.min[axisB]);
+		__m128 maxB	= _mm_set1_ps(b.max[axisB]);
+
+		for (int j = i + 1; j < count; j += 4) {
+			__m128 otherMinS = _mm_loadu_ps(&sortMin[j]);
+
+			//anything starting after this box ends along the sort axis, and everything after that, can't overlap it
+			__m128 inRange = _mm_cmple_ps(otherMinS, maxS);
+
+			__m128 overlap = _mm_and_ps(inRange,
+				_mm_and_ps(
+					_mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&axisMin[0][j]), maxA), _mm_cmpge_ps(_mm_loadu_ps(&axisMax[0][j]), minA)),
+					_mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&axisMin[1][j]), maxB), _mm_cmpge_ps(_mm_loadu_ps(&axisMax[1][j]), minB))
+				)
+			);
+
+			int hits = _mm_movemask_ps(overlap);
+			while (hits) {
+				int k = 0;
+				while (!(hits & (1 << k))) {
+					++k;
+				}
+				hits &= ~(1 << k);
+				pairs.emplace_back(sortedObjects[i], sortedObjects[j + k]);
+			}
+			if (_mm_movemask_ps(inRange) != 0xF) {
+				break;
+			}
+		}
+#else
+		for (int j = i + 1; j < count && sortMin[j] <= sortMax; ++j) {
+			if (axisMin[0][j] <= b.max[axisA] && axisMax[0][j] >= b.min[axisA] &&
+				axisMin[1][j] <= b.max[axisB] && axisMax[1][j] >= b.min[axisB]) {
+				pairs.emplace_back(sortedObjects[i], sortedObjects[j]);
+			}
+		}
+#endif
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "Vector3.h"
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		class GameObject;
+
+		/*
+		A sort and sweep broadphase. Every box is kept in a list sorted by its
+		minimum along one axis - whichever axis the objects are most spread out
+		along. Sweeping down that list, each box only has to be checked against
+		the boxes that start before it ends, and those only need their other 2
+		axes checked, which is done 4 boxes at a time with SSE.
+
+		Objects don't move far between physics updates, so the list from the
+		last update is almost sorted already, and an insertion sort puts it
+		back in order in close to linear time.
+
+		Boxes are identified by an ID picked by the caller (the PhysicsSystem
+		uses the world ID), so the same box can be updated every frame.
+		*/
+		class SweepAndPrune {
+		public:
+			typedef std::pair<GameObject*, GameObject*> Pair;
+
+			SweepAndPrune();
+			~SweepAndPrune() {}
+
+			void Clear();
+
+			void SetBox(int id, GameObject* object, const Vector3& min, const Vector3& max);
+			void RemoveBox(int id);
+
+			//fills pairs with every pair of overlapping boxes
+			void FindPairs(std::vector<Pair>& pairs);
+
+			int GetSortAxis() const {
+				return sortAxis;
+			}
+
+		protected:
+			struct Box {
+				Vector3		min;
+				Vector3		max;
+				GameObject* object;
+				bool		inList;
+			};
+
+			void ChooseSortAxis();
+			void SortList();
+			void GatherSorted();
+
+			std::vector<Box>	boxes;		//indexed by ID
+			std::vector<int>	sortedIDs;	//IDs of every box in the list, sorted by min along sortAxis
+
+			//the sorted boxes, split out into one array per bound, so they can be loaded 4 at a time
+			std::vector<float>			sortMin;
+			std::vector<float>			axisMin[2];
+			std::vector<float>			axisMax[2];
+			std::vector<GameObject*>	sortedObjects;
+
+			int sortAxis;
+		};
+	}
+}
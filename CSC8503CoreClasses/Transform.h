@@ -28,12 +28,30 @@ namespace NCL {
 				return orientation;
 			}
 
+			/*
+			The physics system can move an object many times a frame, and only
+			the renderer ever needs its matrix, so the setters just mark the
+			matrix as out of date, and it's rebuilt the next time it's asked for.
+			Rebuilding it here changes the transform, so two threads mustn't ask
+			the same out of date transform for its matrix at once - which is why
+			the renderers call GameWorld::UpdateTransforms first, on one thread.
+			*/
 			Matrix4 GetMatrix() const {
+				if (matrixOutOfDate) {
+					UpdateMatrix();
+				}
 				return matrix;
 			}
-			void UpdateMatrix();
+
+			bool IsMatrixOutOfDate() const {
+				return matrixOutOfDate;
+			}
+
+			void UpdateMatrix() const;
 		protected:
-			Matrix4		matrix;
+			mutable Matrix4	matrix;
+			mutable bool	matrixOutOfDate;
+
 			Quaternion	orientation;
 			Vector3		position;
 
@@ -0,0 +1,86 @@
+#include "WorkerPool.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+WorkerPool::WorkerPool(int workerCount) {
+	this->workerCount	= std::max(1, workerCount);
+	job					= nullptr;
+	jobCount			= 0;
+	jobGeneration		= 0;
+	workersBusy			= 0;
+	shuttingDown		= false;
+
+	//the calling thread is worker 0, so it only needs helpers for the rest
+	for (int i = 1; i < this->workerCount; ++i) {
+		threads.emplace_back(&WorkerPool::WorkerThread, this, i);
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		shuttingDown = true;
+	}
+	workReady.notify_all();
+	for (std::thread& t : threads) {
+		t.join();
+	}
+}
+
+void WorkerPool::ParallelFor(int count, const RangeFunc& func) {
+	if (count <= 0) {
+		return;
+	}
+	if (workerCount == 1) {
+		func(0, 0, count);
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		job			= &func;
+		jobCount	= count;
+		workersBusy = workerCount - 1;
+		jobGeneration++;
+	}
+	workReady.notify_all();
+
+	RunBlock(0);
+
+	std::unique_lock<std::mutex> guard(lock);
+	workDone.wait(guard, [&] { return workersBusy == 0; });
+	job = nullptr;
+}
+
+void WorkerPool::RunBlock(int worker) {
+	int begin	= (int)(((int64_t)jobCount * worker) / workerCount);
+	int end		= (int)(((int64_t)jobCount * (worker + 1)) / workerCount);
+	if (begin < end) {
+		(*job)(worker, begin, end);
+	}
+}
+
+void WorkerPool::WorkerThread(int worker) {
+	int lastGeneration = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			workReady.wait(guard, [&] { return shuttingDown || jobGeneration != lastGeneration; });
+			if (shuttingDown) {
+				return;
+			}
+			lastGeneration = jobGeneration;
+		}
+
+		RunBlock(worker);
+
+		bool last = false;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			last = (--workersBusy == 0);
+		}
+		if (last) {
+			workDone.notify_one();
+		}
+	}
+}
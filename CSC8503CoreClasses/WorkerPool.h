@@ -0,0 +1,51 @@
+#pragma once
+#include <mutex>
+#include <condition_variable>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		A handful of threads that are started once and then sleep until they're
+		given something to do, so that work that happens many times a second
+		(like the narrowphase) doesn't pay for starting threads every time.
+
+		ParallelFor splits a range of indices into one contiguous block per
+		worker, in order - worker 0 always gets the first block, and so on - and
+		the calling thread works on block 0 itself rather than waiting idle.
+		Anything each worker writes out in its own block can then be stitched
+		back together in worker order, and comes out in the same order as if a
+		single thread had run the whole range.
+		*/
+		class WorkerPool {
+		public:
+			typedef std::function<void(int worker, int begin, int end)> RangeFunc;
+
+			WorkerPool(int workerCount);
+			~WorkerPool();
+
+			int GetWorkerCount() const {
+				return workerCount;
+			}
+
+			//blocks until every index in [0, count) has been processed
+			void ParallelFor(int count, const RangeFunc& func);
+
+		protected:
+			void WorkerThread(int worker);
+			void RunBlock(int worker);
+
+			std::vector<std::thread>	threads;
+			int							workerCount;
+
+			std::mutex				lock;
+			std::condition_variable	workReady;
+			std::condition_variable	workDone;
+
+			const RangeFunc*	job;
+			int					jobCount;
+			int					jobGeneration;	//bumped every time there's a new job, so sleeping threads know it isn't one they've done
+			int					workersBusy;
+			bool				shuttingDown;
+		};
+	}
+}
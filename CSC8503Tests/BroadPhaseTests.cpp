@@ -0,0 +1,200 @@
+#include "Tests.h"
+#include "DynamicAABBTree.h"
+#include "SweepAndPrune.h"
+#include "SpatialHashGrid.h"
+#include "GameObject.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <set>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	const unsigned int	TEST_SEED		= 8503;
+	const int			FRAMES			= 8;
+	const int			SCATTERED_BOXES	= 300;
+	const int			STACKS			= 4;
+	const int			STACK_HEIGHT	= 30;
+
+	typedef std::set<std::pair<int, int>> PairSet;	//world IDs, lowest first
+
+	enum class BroadPhaseKind {
+		Tree,
+		SweepAndPrune,
+		SpatialHashGrid
+	};
+
+	struct Box {
+		Vector3 pos;
+		Vector3 halfSize;
+		Vector3 displacement;	//how far it moved in the last frame
+	};
+
+	/*
+	A floor far bigger than any grid cell, boxes scattered above it (some
+	overlapping, some not), and a few tall stacks of boxes resting exactly on
+	top of one another, with the bottom of each resting exactly on the floor.
+	The stacks' boxes are a whole number of units tall, so their faces meet
+	exactly, and many of them meet right on a grid cell's boundary.
+	*/
+	std::vector<Box> BuildScene(std::mt19937& rng) {
+		std::uniform_real_distribution<float> spread(-20.0f, 20.0f);
+		std::uniform_real_distribution<float> height(0.0f, 10.0f);
+		std::uniform_real_distribution<float> size(0.25f, 1.5f);
+
+		std::vector<Box> boxes;
+		boxes.push_back({ Vector3(0, -0.5f, 0), Vector3(100, 0.5f, 100) });
+		for (int i = 0; i < SCATTERED_BOXES; ++i) {
+			boxes.push_back({ Vector3(spread(rng), height(rng), spread(rng)), Vector3(size(rng), size(rng), size(rng)) });
+		}
+		for (int s = 0; s < STACKS; ++s) {
+			for (int i = 0; i < STACK_HEIGHT; ++i) {
+				boxes.push_back({ Vector3(s * 8.0f - 12.0f, i + 0.5f, 4.0f), Vector3(0.5f, 0.5f, 0.5f) });
+			}
+		}
+		return boxes;
+	}
+
+	//the scattered boxes drift a little, with the odd one jumping well clear of where it was, and each stack slides along the floor in one piece
+	void MoveScene(std::vector<Box>& boxes, std::mt19937& rng) {
+		std::uniform_real_distribution<float>	drift(-0.3f, 0.3f);
+		std::uniform_real_distribution<float>	jump(-5.0f, 5.0f);
+		std::uniform_int_distribution<int>		chance(0, 19);
+		std::uniform_int_distribution<int>		slide(-4, 4);
+
+		for (int i = 1; i <= SCATTERED_BOXES; ++i) {
+			bool jumps = chance(rng) == 0;
+			boxes[i].displacement = jumps ? Vector3(jump(rng), jump(rng), jump(rng)) : Vector3(drift(rng), drift(rng), drift(rng));
+		}
+		for (int s = 0; s < STACKS; ++s) {
+			//eighths of a unit, so the stacks' faces still meet exactly
+			Vector3 displacement(slide(rng) * 0.125f, 0.0f, slide(rng) * 0.125f);
+			for (int i = 0; i < STACK_HEIGHT; ++i) {
+				boxes[1 + SCATTERED_BOXES + s * STACK_HEIGHT + i].displacement = displacement;
+			}
+		}
+		for (Box& b : boxes) {
+			b.pos += b.displacement;
+		}
+	}
+
+	//every pair of boxes, just as BasicCollisionDetection tries every pair of objects
+	PairSet OverlappingPairs(const std::vector<Box>& boxes) {
+		PairSet pairs;
+		for (int i = 0; i < (int)boxes.size(); ++i) {
+			for (int j = i + 1; j < (int)boxes.size(); ++j) {
+				Vector3 minA = boxes[i].pos - boxes[i].halfSize;
+				Vector3 maxA = boxes[i].pos + boxes[i].halfSize;
+				Vector3 minB = boxes[j].pos - boxes[j].halfSize;
+				Vector3 maxB = boxes[j].pos + boxes[j].halfSize;
+				if (minA.x <= maxB.x && maxA.x >= minB.x &&
+					minA.y <= maxB.y && maxA.y >= minB.y &&
+					minA.z <= maxB.z && maxA.z >= minB.z) {
+					pairs.insert({ i, j });
+				}
+			}
+		}
+		return pairs;
+	}
+
+	void AddPair(PairSet& pairs, const GameObject* a, const GameObject* b) {
+		pairs.insert(std::minmax(a->GetWorldID(), b->GetWorldID()));
+	}
+
+	/*
+	Each broadphase is kept up to date the same way the PhysicsSystem does it
+	- the tree has its leaves moved, the sweep has its boxes set again, and
+	the grid is built from scratch - and then asked for its pairs. The tree
+	works on fattened boxes, so can find more pairs than actually overlap,
+	but none of them can miss a pair that does.
+	*/
+	bool FindsEveryOverlap(BroadPhaseKind kind) {
+		std::mt19937 rng(TEST_SEED);
+		std::vector<Box> boxes = BuildScene(rng);
+
+		std::vector<std::unique_ptr<GameObject>> objects;
+		for (int i = 0; i < (int)boxes.size(); ++i) {
+			objects.emplace_back(new GameObject());
+			objects.back()->SetWorldID(i);
+		}
+
+		DynamicAABBTree<GameObject*>	tree;
+		SweepAndPrune					sweep;
+		SpatialHashGrid					grid;
+		std::vector<int>				proxies;
+		std::vector<SweepAndPrune::Pair> found;
+
+		bool everyOverlapFound = true;
+		for (int frame = 0; frame < FRAMES; ++frame) {
+			if (frame > 0) {
+				MoveScene(boxes, rng);
+			}
+			PairSet pairs;
+			if (kind == BroadPhaseKind::Tree) {
+				for (int i = 0; i < (int)boxes.size(); ++i) {
+					if (frame == 0) {
+						proxies.push_back(tree.Insert(objects[i].get(), boxes[i].pos, boxes[i].halfSize));
+					}
+					else {
+						tree.Move(proxies[i], boxes[i].pos, boxes[i].halfSize, boxes[i].displacement);
+					}
+				}
+				for (int i = 0; i < (int)boxes.size(); ++i) {
+					Vector3 fatMin;
+					Vector3 fatMax;
+					tree.GetFatAABB(proxies[i], fatMin, fatMax);
+					tree.Query(fatMin, fatMax,
+						[&](GameObject* other, int otherProxy) {
+							if (otherProxy != proxies[i]) {
+								AddPair(pairs, objects[i].get(), other);
+							}
+						}
+					);
+				}
+			}
+			else {
+				if (kind == BroadPhaseKind::SweepAndPrune) {
+					for (int i = 0; i < (int)boxes.size(); ++i) {
+						sweep.SetBox(i, objects[i].get(), boxes[i].pos - boxes[i].halfSize, boxes[i].pos + boxes[i].halfSize);
+					}
+					sweep.FindPairs(found);
+				}
+				else {
+					grid.Clear();
+					for (int i = 0; i < (int)boxes.size(); ++i) {
+						grid.Insert(objects[i].get(), boxes[i].pos - boxes[i].halfSize, boxes[i].pos + boxes[i].halfSize);
+					}
+					grid.FindPairs(found);
+				}
+				for (const SweepAndPrune::Pair& p : found) {
+					AddPair(pairs, p.first, p.second);
+				}
+			}
+
+			PairSet overlapping = OverlappingPairs(boxes);
+			everyOverlapFound &= std::includes(pairs.begin(), pairs.end(), overlapping.begin(), overlapping.end());
+		}
+		return everyOverlapFound;
+	}
+
+	void TreeFindsEveryOverlap() {
+		TEST_CHECK(FindsEveryOverlap(BroadPhaseKind::Tree));
+	}
+
+	void SweepAndPruneFindsEveryOverlap() {
+		TEST_CHECK(FindsEveryOverlap(BroadPhaseKind::SweepAndPrune));
+	}
+
+	void SpatialHashGridFindsEveryOverlap() {
+		TEST_CHECK(FindsEveryOverlap(BroadPhaseKind::SpatialHashGrid));
+	}
+}
+
+void NCL::CSC8503::AddBroadPhaseTests(TestRunner& runner) {
+	runner.Add("BroadPhase/TreeFindsEveryOverlap",				TreeFindsEveryOverlap);
+	runner.Add("BroadPhase/SweepAndPruneFindsEveryOverlap",		SweepAndPruneFindsEveryOverlap);
+	runner.Add("BroadPhase/SpatialHashGridFindsEveryOverlap",	SpatialHashGridFindsEveryOverlap);
+}
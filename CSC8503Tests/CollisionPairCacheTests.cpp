@@ -0,0 +1,170 @@
+#include "Tests.h"
+#include "CollisionPairCache.h"
+#include "GameObject.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	const unsigned int	TEST_SEED		= 8503;
+	const int			OPERATIONS		= 200000;	//split evenly between the cache sizes below
+	const int			PHASE_LENGTH	= 10;		//operations per object between switching from mostly adding pairs to mostly removing them
+	const int			CHECK_EVERY		= 64;		//operations between walking the whole cache
+
+	//how many objects the pairs are made from, and how big the cache starts - from one that has to grow straight away, to one that never does
+	struct CacheSize {
+		int objectCount;
+		int initialCapacity;
+	};
+	const CacheSize CACHE_SIZES[] = {
+		{ 6,	1 },
+		{ 40,	16 },
+		{ 120,	64 },
+		{ 400,	4096 },
+	};
+
+	//what the cache should hold for each pair, keyed on the lower world ID first
+	struct ExpectedPair {
+		int		framesLeft;
+		int		stamp;
+		float	gjkTag;		//written into the pair's GJKCache, to check the caches move with their pairs
+	};
+	typedef std::map<std::pair<int, int>, ExpectedPair> ExpectedPairs;
+
+	std::pair<int, int> PairKey(const GameObject* a, const GameObject* b) {
+		return std::minmax(a->GetWorldID(), b->GetWorldID());
+	}
+
+	//every pair in the cache is expected, with the right contents, and nothing expected is missing
+	bool Matches(CollisionPairCache& cache, const ExpectedPairs& expected) {
+		if (cache.Size() != (int)expected.size()) {
+			return false;
+		}
+		for (int i = 0; i < cache.Size(); ++i) {
+			auto found = expected.find(PairKey(cache[i].a, cache[i].b));
+			if (found == expected.end() ||
+				found->second.framesLeft != cache[i].framesLeft ||
+				found->second.gjkTag != cache.GetGJKCache(i).separatingAxis.x ||
+				cache.Find(cache[i].b, cache[i].a) != &cache[i]) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/*
+	Runs a random mix of every operation against both the cache and a
+	std::map, alternating between stretches that mostly add pairs and
+	stretches that mostly take them away, so the cache is pushed through
+	Grow and then back down to nearly empty again, over and over. Returns
+	how many times the two disagreed.
+	*/
+	int StressCache(const CacheSize& size, int operations, std::mt19937& rng) {
+		std::vector<std::unique_ptr<GameObject>> objects;
+		for (int i = 0; i < size.objectCount; ++i) {
+			objects.emplace_back(new GameObject());
+			objects.back()->SetWorldID(i);
+		}
+		std::uniform_int_distribution<int>		pickObject(0, size.objectCount - 1);
+		std::uniform_int_distribution<int>		pickOperation(0, 99);
+		std::uniform_real_distribution<float>	pickTag(0.0f, 1.0f);
+
+		CollisionPairCache	cache(size.initialCapacity);
+		ExpectedPairs		expected;
+		int					stamp		= 1;
+		int					mismatches	= 0;
+
+		auto RandomPair = [&]() {
+			CollisionDetection::CollisionInfo info;
+			info.a = objects[pickObject(rng)].get();
+			do {
+				info.b = objects[pickObject(rng)].get();
+			} while (info.b == info.a);
+			info.framesLeft = pickObject(rng);
+			return info;
+		};
+		//a pair that's just been added is always at the back
+		auto TagNewPair = [&](const CollisionDetection::CollisionInfo& info) {
+			float tag = pickTag(rng);
+			cache.GetGJKCache(cache.Size() - 1).separatingAxis.x = tag;
+			expected[PairKey(info.a, info.b)] = { info.framesLeft, 0, tag };
+		};
+
+		for (int op = 0; op < operations; ++op) {
+			bool	growing = (op / (PHASE_LENGTH * size.objectCount)) % 2 == 0;
+			int		roll	= pickOperation(rng);
+
+			if (roll < (growing ? 40 : 10)) {
+				CollisionDetection::CollisionInfo info = RandomPair();
+				bool known		= expected.count(PairKey(info.a, info.b)) > 0;
+				bool inserted	= cache.Insert(info);
+				mismatches += (inserted == known);
+				if (inserted) {
+					TagNewPair(info);
+				}
+			}
+			else if (roll < 55) {
+				CollisionDetection::CollisionInfo info = RandomPair();
+				auto found = expected.find(PairKey(info.a, info.b));
+				CollisionDetection::CollisionInfo* cached = cache.Find(info.a, info.b);
+				if (found == expected.end()) {
+					mismatches += (cached != nullptr);
+				}
+				else {
+					mismatches += (cached == nullptr || cached->framesLeft != found->second.framesLeft);
+				}
+			}
+			else if (roll < (growing ? 70 : 85)) {
+				if (!cache.Empty()) {
+					int index = std::uniform_int_distribution<int>(0, cache.Size() - 1)(rng);
+					expected.erase(PairKey(cache[index].a, cache[index].b));
+					cache.RemoveAt(index);
+				}
+			}
+			else if (roll < 99 || growing) {
+				CollisionDetection::CollisionInfo info = RandomPair();
+				int before = cache.Size();
+				cache.Touch(info, stamp);
+				if (cache.Size() != before) {
+					TagNewPair(info);
+				}
+				expected[PairKey(info.a, info.b)].stamp = stamp;
+			}
+			else {
+				//untouched pairs go, as they would at the end of a frame - only while shrinking, as it usually takes most of them
+				cache.RemoveUntouched(stamp);
+				for (auto i = expected.begin(); i != expected.end(); ) {
+					i = (i->second.stamp != stamp) ? expected.erase(i) : std::next(i);
+				}
+				stamp++;
+			}
+
+			mismatches += (cache.Size() != (int)expected.size());
+			if (op % CHECK_EVERY == 0) {
+				mismatches += !Matches(cache, expected);
+			}
+		}
+		mismatches += !Matches(cache, expected);
+
+		cache.Clear();
+		mismatches += !cache.Empty();
+		return mismatches;
+	}
+
+	void MatchesStdMap() {
+		std::mt19937 rng(TEST_SEED);
+		const int sizeCount = sizeof(CACHE_SIZES) / sizeof(CACHE_SIZES[0]);
+		for (const CacheSize& size : CACHE_SIZES) {
+			TEST_CHECK(StressCache(size, OPERATIONS / sizeCount, rng) == 0);
+		}
+	}
+}
+
+void NCL::CSC8503::AddCollisionPairCacheTests(TestRunner& runner) {
+	runner.Add("CollisionPairCache/MatchesStdMap", MatchesStdMap);
+}
@@ -0,0 +1,75 @@
+#include "Tests.h"
+#include "DiceSimulator.h"
+#include "PhysicsSystem.h"
+#include "GameWorld.h"
+#include "GameObject.h"
+#include "PhysicsObject.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	const float TRAY_HALF_SIZE	= 5.0f;		//to the inside of the walls
+	const float WALL_THICKNESS	= 1.0f;
+	const float THROW_SPEED		= 120.0f;
+	const float FRAME_DT		= 1.0f / 30.0f;	//as slow as the StepController might drop to, 4 units a step at this speed
+
+	/*
+	A die thrown flat out at a wall of a small tray, with gravity off so
+	it goes straight there, and one substep a frame. Returns true if it's
+	still inside the walls a second later.
+	*/
+	bool StaysInTray(const Vector3& direction, bool sweep) {
+		GameWorld		world;
+		PhysicsSystem	physics(world);
+		if (!sweep) {
+			physics.SetContinuousCollisionThreshold(FLT_MAX);
+		}
+
+		float wallMiddle = TRAY_HALF_SIZE + WALL_THICKNESS * 0.5f;
+		float wallLength = TRAY_HALF_SIZE + WALL_THICKNESS;
+		DiceSimulator::AddFloor(world, Vector3(0, -1, 0), Vector3(wallLength, 1, wallLength));
+		DiceSimulator::AddCube(world, Vector3(wallMiddle, 2, 0), Vector3(WALL_THICKNESS * 0.5f, 2, wallLength), 0);
+		DiceSimulator::AddCube(world, Vector3(-wallMiddle, 2, 0), Vector3(WALL_THICKNESS * 0.5f, 2, wallLength), 0);
+		DiceSimulator::AddCube(world, Vector3(0, 2, wallMiddle), Vector3(wallLength, 2, WALL_THICKNESS * 0.5f), 0);
+		DiceSimulator::AddCube(world, Vector3(0, 2, -wallMiddle), Vector3(wallLength, 2, WALL_THICKNESS * 0.5f), 0);
+
+		GameObject* dice = DiceSimulator::AddD6(world, Vector3(0, 1, 0), Vector3(0.5f, 0.5f, 0.5f));
+		dice->GetPhysicsObject()->SetLinearVelocity(direction.Normalised() * THROW_SPEED);
+
+		for (int i = 0; i < 30; ++i) {
+			physics.FixedUpdate(FRAME_DT, 1);
+		}
+		Vector3 position = dice->GetTransform().GetPosition();
+		bool inside = std::abs(position.x) < TRAY_HALF_SIZE && std::abs(position.z) < TRAY_HALF_SIZE;
+		world.ClearAndErase();
+		return inside;
+	}
+
+	const Vector3 throws[] = {
+		Vector3(1, 0, 0), Vector3(-1, 0, 0), Vector3(0, 0, 1), Vector3(0, 0, -1),
+		Vector3(1, 0, 0.3f), Vector3(-0.6f, 0, 1), Vector3(1, 0, 1), Vector3(-1, 0, -0.8f)
+	};
+
+	void FastDiceStayInTheTray() {
+		int escaped = 0;
+		for (const Vector3& direction : throws) {
+			escaped += !StaysInTray(direction, true);
+		}
+		TEST_CHECK(escaped == 0);
+	}
+
+	//the same throws with the sweep turned off, to show they really are fast enough to pass through the walls
+	void UnsweptDicePassThroughTheWalls() {
+		int escaped = 0;
+		for (const Vector3& direction : throws) {
+			escaped += !StaysInTray(direction, false);
+		}
+		TEST_CHECK(escaped > 0);
+	}
+}
+
+void NCL::CSC8503::AddContinuousCollisionTests(TestRunner& runner) {
+	runner.Add("ContinuousCollision/FastDiceStayInTheTray",			FastDiceStayInTheTray);
+	runner.Add("ContinuousCollision/UnsweptDicePassThroughTheWalls",	UnsweptDicePassThroughTheWalls);
+}
@@ -0,0 +1,120 @@
+#include "Tests.h"
+#include "ConvexHullVolume.h"
+#include "Transform.h"
+
+#include <random>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	//a unit cube's corners, with the middle of every face and a few repeats thrown in, as a mesh would have
+	std::vector<Vector3> CubePoints() {
+		std::vector<Vector3> points;
+		for (int i = 0; i < 8; ++i) {
+			points.emplace_back(i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f);
+		}
+		for (int axis = 0; axis < 3; ++axis) {
+			Vector3 p;
+			p[axis] = 0.5f;
+			points.emplace_back(p);
+			points.emplace_back(-p);
+		}
+		points.emplace_back(0.5f, 0.5f, 0.5f);
+		points.emplace_back(-0.5f, -0.5f, -0.5f);
+		points.emplace_back(0.0f, 0.0f, 0.0f);
+		return points;
+	}
+
+	std::vector<Vector3> OctahedronPoints() {
+		std::vector<Vector3> points;
+		for (int axis = 0; axis < 3; ++axis) {
+			Vector3 p;
+			p[axis] = 1.0f;
+			points.emplace_back(p);
+			points.emplace_back(-p);
+		}
+		return points;
+	}
+
+	//the brute force answer, to check the hill climbing against
+	float FurthestAlong(const std::vector<Vector3>& points, const Vector3& dir, const Transform& tr) {
+		float best = -FLT_MAX;
+		for (const Vector3& p : points) {
+			Vector3 world = tr.GetOrientation() * p + tr.GetPosition();
+			best = std::max(best, Vector3::Dot(world, dir));
+		}
+		return best;
+	}
+
+	//an orientation that turns the local direction 'from' to point straight up
+	Quaternion TurnUpwards(const Vector3& from) {
+		Vector3 up(0, 1, 0);
+		float	cosAngle	= std::min(1.0f, std::max(-1.0f, Vector3::Dot(from, up)));
+		Vector3 axis		= Vector3::Cross(from, up);
+		if (axis.Length() < 1e-4f) {
+			axis = Vector3(1, 0, 0);
+		}
+		return Quaternion::AxisAngleToQuaterion(axis.Normalised(), std::acos(cosAngle) * 180.0f / 3.14159265f);
+	}
+
+	void CubeHasSixFacesAndEightCorners() {
+		ConvexHullVolume hull(CubePoints());
+		TEST_CHECK(hull.GetFaceCount() == 6);
+		TEST_CHECK(hull.GetVertexCount() == 8);
+	}
+
+	void OctahedronHasEightFaces() {
+		ConvexHullVolume hull(OctahedronPoints());
+		TEST_CHECK(hull.GetFaceCount() == 8);
+		TEST_CHECK(hull.GetVertexCount() == 6);
+	}
+
+	void SupportMatchesBruteForce() {
+		std::vector<Vector3> points = CubePoints();
+		ConvexHullVolume hull(points, 1.0f);
+
+		std::mt19937 rng(8503);
+		std::uniform_real_distribution<float> component(-1.0f, 1.0f);
+		std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+		for (int i = 0; i < 1000; ++i) {
+			Transform tr;
+			tr.SetPosition(Vector3(component(rng), component(rng), component(rng)) * 10.0f)
+				.SetOrientation(Quaternion::EulerAnglesToQuaternion(angle(rng), angle(rng), angle(rng)));
+			Vector3 dir(component(rng), component(rng), component(rng));
+
+			Vector3 support = hull.Support(dir, tr);
+			TEST_CHECK(std::abs(Vector3::Dot(support, dir) - FurthestAlong(points, dir, tr)) < 1e-4f);
+		}
+	}
+
+	void FaceResultIsTheFacePointingUp() {
+		for (const std::vector<Vector3>& points : { CubePoints(), OctahedronPoints() }) {
+			ConvexHullVolume hull(points);
+			for (int i = 0; i < hull.GetFaceCount(); ++i) {
+				Transform tr;
+				tr.SetOrientation(TurnUpwards(hull.GetFaceNormal(i)));
+				TEST_CHECK(hull.GetFaceResult(tr) == i + 1);
+			}
+		}
+	}
+
+	void EmptyPointsAreRejected() {
+		bool thrown = false;
+		try {
+			ConvexHullVolume hull(std::vector<Vector3>{});
+		}
+		catch (const std::invalid_argument&) {
+			thrown = true;
+		}
+		TEST_CHECK(thrown);
+	}
+}
+
+void NCL::CSC8503::AddConvexHullTests(TestRunner& runner) {
+	runner.Add("ConvexHull/CubeHasSixFacesAndEightCorners",	CubeHasSixFacesAndEightCorners);
+	runner.Add("ConvexHull/OctahedronHasEightFaces",		OctahedronHasEightFaces);
+	runner.Add("ConvexHull/SupportMatchesBruteForce",		SupportMatchesBruteForce);
+	runner.Add("ConvexHull/FaceResultIsTheFacePointingUp",	FaceResultIsTheFacePointingUp);
+	runner.Add("ConvexHull/EmptyPointsAreRejected",			EmptyPointsAreRejected);
+}
@@ -0,0 +1,81 @@
+#include "Tests.h"
+#include "DiceSimulator.h"
+
+#include <algorithm>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	const unsigned int	TEST_SEED	= 8503;
+	const int			TEST_ROLLS	= 8;
+
+	/*
+	A roll has to depend on nothing but its seed - not on what the world
+	was left like by earlier rolls (such as the tray having gone to sleep),
+	and not on anything random that wasn't seeded. So every seed is rolled
+	by a fresh simulator, then again, in reverse, by one that's already
+	rolled all of the others.
+	*/
+	void SameSeedSameRoll() {
+		std::vector<uint64_t> hashes;
+		for (int i = 0; i < TEST_ROLLS; ++i) {
+			DiceSimulator fresh;
+			fresh.Seed(TEST_SEED + i);
+			hashes.push_back(fresh.Roll().stateHash);
+		}
+
+		DiceSimulator reused;
+		for (int i = 0; i < TEST_ROLLS; ++i) {
+			reused.Seed(TEST_SEED + TEST_ROLLS + i);
+			reused.Roll();
+		}
+		int mismatches = 0;
+		for (int i = TEST_ROLLS - 1; i >= 0; --i) {
+			reused.Seed(TEST_SEED + i);
+			mismatches += reused.Roll().stateHash != hashes[i];
+		}
+		TEST_CHECK(mismatches == 0);
+	}
+
+	//if the hash didn't depend on the seed, SameSeedSameRoll would prove nothing
+	void DifferentSeedsDifferentRolls() {
+		DiceSimulator simulator;
+		std::vector<uint64_t> hashes;
+		for (int i = 0; i < TEST_ROLLS; ++i) {
+			simulator.Seed(TEST_SEED + i);
+			hashes.push_back(simulator.Roll().stateHash);
+		}
+		std::sort(hashes.begin(), hashes.end());
+		TEST_CHECK(std::unique(hashes.begin(), hashes.end()) == hashes.end());
+	}
+
+	/*
+	The narrowphase workers each write into their own contact list, and the
+	lists are joined back up in pair order, so how many workers there are
+	shouldn't change anything. Every pair is handed out to the workers here,
+	rather than the narrowphase staying on one thread for small scenes.
+	*/
+	uint64_t RollWithThreads(int threads, unsigned int seed) {
+		DiceSimulator simulator;
+		simulator.GetPhysics().SetNarrowPhaseThreadCount(threads);
+		simulator.GetPhysics().SetParallelNarrowPhaseMinPairs(1);
+		simulator.Seed(seed);
+		simulator.Roll();
+		return simulator.GetPhysics().GetStepHash();
+	}
+
+	void ThreadCountDoesntMatter() {
+		int mismatches = 0;
+		for (int i = 0; i < TEST_ROLLS; ++i) {
+			mismatches += RollWithThreads(1, TEST_SEED + i) != RollWithThreads(3, TEST_SEED + i);
+		}
+		TEST_CHECK(mismatches == 0);
+	}
+}
+
+void NCL::CSC8503::AddDeterminismTests(TestRunner& runner) {
+	runner.Add("Determinism/SameSeedSameRoll",				SameSeedSameRoll);
+	runner.Add("Determinism/DifferentSeedsDifferentRolls",	DifferentSeedsDifferentRolls);
+	runner.Add("Determinism/ThreadCountDoesntMatter",		ThreadCountDoesntMatter);
+}
@@ -0,0 +1,59 @@
+#include "Tests.h"
+#include "DiceRollFarm.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	const unsigned int	TEST_SEED	= 8503;
+	const int			TEST_ROLLS	= 8;
+
+	/*
+	With no time at all to roll in, every roll gives up with the dice still
+	in the air, so every die should be tallied as unsettled and none of them
+	should make it into the counts.
+	*/
+	void UnsettledRollsAreExcluded() {
+		DiceRollFarm farm(2);
+		farm.Run(TEST_ROLLS, TEST_SEED, 0.0f);
+
+		for (int d = 0; d < DiceSimulator::MAX; d++) {
+			const DiceRollFarm::Histogram& h = farm.GetHistogram((DiceSimulator::DiceType)d);
+			TEST_CHECK(h.unsettled == TEST_ROLLS);
+			TEST_CHECK(h.total == 0);
+			for (int c : h.counts) {
+				TEST_CHECK(c == 0);
+			}
+		}
+	}
+
+	//every roll ends up in exactly one of the counts, the unsettled tally, or the escaped tally
+	void EveryRollIsAccountedFor() {
+		DiceRollFarm farm(2);
+		farm.Run(TEST_ROLLS, TEST_SEED);
+
+		for (int d = 0; d < DiceSimulator::MAX; d++) {
+			const DiceRollFarm::Histogram& h = farm.GetHistogram((DiceSimulator::DiceType)d);
+			int counted = 0;
+			for (int c : h.counts) {
+				counted += c;
+			}
+			TEST_CHECK(counted == h.total);
+			TEST_CHECK(h.total + h.unsettled + h.escaped == TEST_ROLLS);
+		}
+	}
+
+	void DiceOutsideTheTrayAreFound() {
+		TEST_CHECK(DiceSimulator::IsInTray(Vector3(0, 2.5f, 0)));
+		TEST_CHECK(DiceSimulator::IsInTray(Vector3(-7.5f, 2.5f, 7.5f)));
+		TEST_CHECK(!DiceSimulator::IsInTray(Vector3(0, -23.0f, 0)));	//fallen off the floor
+		TEST_CHECK(!DiceSimulator::IsInTray(Vector3(12.0f, 2.5f, 0)));	//over the wall
+		TEST_CHECK(!DiceSimulator::IsInTray(Vector3(8.5f, 10.5f, 0)));	//sat on top of the wall
+	}
+}
+
+void NCL::CSC8503::AddDiceRollFarmTests(TestRunner& runner) {
+	runner.Add("DiceRollFarm/UnsettledRollsAreExcluded",	UnsettledRollsAreExcluded);
+	runner.Add("DiceRollFarm/EveryRollIsAccountedFor",		EveryRollIsAccountedFor);
+	runner.Add("DiceRollFarm/DiceOutsideTheTrayAreFound",	DiceOutsideTheTrayAreFound);
+}
@@ -0,0 +1,48 @@
+#include "Tests.h"
+#include "DiceSimulator.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	const unsigned int	TEST_SEED	= 8503;
+	const int			TEST_ROLLS	= 100;
+
+	//the walls are meant to be high enough that nothing thrown the DiceRoller's way ever gets over them
+	void DiceStayInTheTray() {
+		DiceSimulator simulator;
+		int escaped = 0;
+		for (int i = 0; i < TEST_ROLLS; ++i) {
+			simulator.Seed(TEST_SEED + i);
+			DiceSimulator::RollResult result = simulator.Roll();
+			for (int d = 0; d < DiceSimulator::MAX; ++d) {
+				if (!result.inTray[d]) {
+					escaped++;
+				}
+			}
+		}
+		TEST_CHECK(escaped == 0);
+	}
+
+	/*
+	A roll that hits the time limit doesn't give a result, so the dice have
+	to come to rest within it nearly every time. A few stragglers are allowed,
+	as two dice can end up propped against each other for a while.
+	*/
+	void RollsSettle() {
+		DiceSimulator simulator;
+		int settled = 0;
+		for (int i = 0; i < TEST_ROLLS; ++i) {
+			simulator.Seed(TEST_SEED + i);
+			if (simulator.Roll().settled) {
+				settled++;
+			}
+		}
+		TEST_CHECK(settled >= TEST_ROLLS * 95 / 100);
+	}
+}
+
+void NCL::CSC8503::AddDiceSimulatorTests(TestRunner& runner) {
+	runner.Add("DiceSimulator/DiceStayInTheTray",	DiceStayInTheTray);
+	runner.Add("DiceSimulator/RollsSettle",			RollsSettle);
+}
@@ -0,0 +1,224 @@
+#include "Tests.h"
+#include "DiceSimulator.h"
+#include "CollisionDetection.h"
+#include "GameObject.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	const unsigned int	TEST_SEED		= 8503;
+	const int			PAIRS_PER_TYPE	= 40;	//overlapping placements, for every pair of dice types
+	const float			SEPARATION		= 0.01f;
+	const float			DEPTH_TOLERANCE	= 0.01f;
+
+	GameObject* AddDice(GameWorld& world, int type) {
+		switch (type) {
+			case DiceSimulator::d4:		return DiceSimulator::AddD4(world, Vector3(), 1);
+			case DiceSimulator::d6:		return DiceSimulator::AddD6(world, Vector3(), Vector3(0.5f, 0.5f, 0.5f));
+			case DiceSimulator::d8:		return DiceSimulator::AddD8(world, Vector3(), 1);
+			case DiceSimulator::d10:	return DiceSimulator::AddD10(world, Vector3(), 1);
+			case DiceSimulator::d12:	return DiceSimulator::AddD12(world, Vector3(), 0.7f);
+			default:					return DiceSimulator::AddD20(world, Vector3(), 1);
+		}
+	}
+
+	/*
+	The shape of a die, in its own space, found from nothing but its support
+	function - the corners are every distinct support point, and any three
+	corners with all the rest on one side of them are part of a face. Faces
+	with more than three corners end up split into triangles, so there are
+	some extra edges across them, but extra directions to try can only make
+	the brute force slower, never wrong.
+	*/
+	struct DiceShape {
+		std::vector<Vector3> faceNormals;
+		std::vector<Vector3> edges;
+	};
+
+	DiceShape FindShape(GameObject* dice) {
+		std::vector<Vector3> corners;
+		const int directions = 4000;
+		for (int i = 0; i < directions; ++i) {
+			//points spread evenly over a sphere
+			float y		= 1.0f - 2.0f * (i + 0.5f) / directions;
+			float r		= std::sqrt(1.0f - y * y);
+			float theta	= i * 2.39996323f;
+			Vector3 corner = dice->GetBoundingVolume()->Support(Vector3(r * std::cos(theta), y, r * std::sin(theta)), dice->GetTransform());
+			bool found = false;
+			for (const Vector3& c : corners) {
+				found |= (c - corner).Length() < 1e-4f;
+			}
+			if (!found) {
+				corners.push_back(corner);
+			}
+		}
+
+		DiceShape shape;
+		int n = (int)corners.size();
+		std::vector<bool> joined(n * n, false);
+		for (int i = 0; i < n; ++i) {
+			for (int j = i + 1; j < n; ++j) {
+				for (int k = j + 1; k < n; ++k) {
+					Vector3 normal = Vector3::Cross(corners[j] - corners[i], corners[k] - corners[i]);
+					if (normal.Length() < 1e-5f) {
+						continue;
+					}
+					normal.Normalise();
+					float	offset	= Vector3::Dot(normal, corners[i]);
+					int		above	= 0;
+					int		below	= 0;
+					for (const Vector3& c : corners) {
+						float d = Vector3::Dot(normal, c) - offset;
+						above += d > 1e-4f;
+						below += d < -1e-4f;
+					}
+					if (above && below) {
+						continue;
+					}
+					shape.faceNormals.push_back(above ? -normal : normal);
+					joined[i * n + j] = joined[j * n + k] = joined[i * n + k] = true;
+				}
+			}
+		}
+		for (int i = 0; i < n; ++i) {
+			for (int j = i + 1; j < n; ++j) {
+				if (joined[i * n + j]) {
+					shape.edges.push_back((corners[j] - corners[i]).Normalised());
+				}
+			}
+		}
+		return shape;
+	}
+
+	//how far the Minkowski difference B - A reaches along dir
+	float Reach(GameObject* a, GameObject* b, const Vector3& dir) {
+		return	Vector3::Dot(b->GetBoundingVolume()->Support(dir, b->GetTransform()), dir) -
+				Vector3::Dot(a->GetBoundingVolume()->Support(-dir, a->GetTransform()), dir);
+	}
+
+	/*
+	The true penetration depth of two convex polyhedra is how far the
+	Minkowski difference reaches in the direction it reaches least, and
+	that's always either a face normal of one of them, or at right angles
+	to an edge of each.
+	*/
+	float BruteForceDepth(GameObject* a, const DiceShape& shapeA, GameObject* b, const DiceShape& shapeB) {
+		Quaternion orientationA = a->GetTransform().GetOrientation();
+		Quaternion orientationB = b->GetTransform().GetOrientation();
+
+		std::vector<Vector3> candidates;
+		for (const Vector3& f : shapeA.faceNormals) {
+			candidates.push_back(orientationA * f);
+		}
+		for (const Vector3& f : shapeB.faceNormals) {
+			candidates.push_back(orientationB * f);
+		}
+		for (const Vector3& ea : shapeA.edges) {
+			for (const Vector3& eb : shapeB.edges) {
+				Vector3 axis = Vector3::Cross(orientationA * ea, orientationB * eb);
+				if (axis.Length() > 1e-4f) {
+					candidates.push_back(axis.Normalised());
+				}
+			}
+		}
+		float depth = FLT_MAX;
+		for (const Vector3& c : candidates) {
+			depth = std::min(depth, std::min(Reach(a, b, c), Reach(a, b, -c)));
+		}
+		return depth;
+	}
+
+	bool Overlaps(GameObject* a, GameObject* b, CollisionDetection::CollisionInfo& info) {
+		info = CollisionDetection::CollisionInfo();
+		info.a = a;
+		info.b = b;
+		return CollisionDetection::GJK(a, b, info);
+	}
+
+	struct EPAResults {
+		int tested		= 0;
+		int apart		= 0;	//separated by moving B out along the normal
+		int depthTested	= 0;
+		int accurate	= 0;	//the deepest contact within DEPTH_TOLERANCE of the brute force depth
+	};
+
+	EPAResults TestEPA() {
+		EPAResults results;
+		std::mt19937 rng(TEST_SEED);
+		std::uniform_real_distribution<float> offset(-1.2f, 1.2f);
+		std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+
+		for (int typeA = 0; typeA < DiceSimulator::MAX; ++typeA) {
+			for (int typeB = typeA; typeB < DiceSimulator::MAX; ++typeB) {
+				GameWorld world;
+				GameObject* a = AddDice(world, typeA);
+				GameObject* b = AddDice(world, typeB);
+				DiceShape shapeA = FindShape(a);
+				DiceShape shapeB = FindShape(b);
+
+				int found = 0;
+				while (found < PAIRS_PER_TYPE) {
+					a->GetTransform().SetOrientation(Quaternion::EulerAnglesToQuaternion(angle(rng), angle(rng), angle(rng)));
+					b->GetTransform().SetOrientation(Quaternion::EulerAnglesToQuaternion(angle(rng), angle(rng), angle(rng)))
+						.SetPosition(Vector3(offset(rng), offset(rng), offset(rng)));
+
+					CollisionDetection::CollisionInfo info;
+					if (!Overlaps(a, b, info) || info.pointCount == 0) {
+						continue;
+					}
+					found++;
+					results.tested++;
+
+					Vector3 normal	= info.points[0].normal;
+					float	depth	= 0.0f;
+					for (int p = 0; p < info.pointCount; ++p) {
+						depth = std::max(depth, info.points[p].penetration);
+					}
+					if (typeA != DiceSimulator::d8 && typeB != DiceSimulator::d8) {
+						results.depthTested++;
+						results.accurate += std::abs(depth - BruteForceDepth(a, shapeA, b, shapeB)) < DEPTH_TOLERANCE;
+					}
+
+					Vector3 position = b->GetTransform().GetPosition();
+					b->GetTransform().SetPosition(position + normal * (depth + SEPARATION));
+					CollisionDetection::CollisionInfo after;
+					results.apart += !Overlaps(a, b, after);
+					b->GetTransform().SetPosition(position);
+				}
+				world.ClearAndErase();
+			}
+		}
+		return results;
+	}
+
+	//moving B out along the normal by the penetration depth (and a little more) has to leave them apart
+	void NormalAndDepthSeparate() {
+		EPAResults results = TestEPA();
+		TEST_CHECK(results.apart == results.tested);
+	}
+
+	/*
+	The d8 is left out, as its support function picks the corner pointing
+	closest to the search direction, rather than the one furthest along it,
+	and its top and bottom corners are pulled in a little - so it isn't
+	quite the shape its own corners make, and there's no true depth to
+	check against.
+	*/
+	void DepthMatchesBruteForce() {
+		EPAResults results = TestEPA();
+		TEST_CHECK(results.depthTested > 0);
+		TEST_CHECK(results.accurate == results.depthTested);
+	}
+}
+
+void NCL::CSC8503::AddEPATests(TestRunner& runner) {
+	runner.Add("EPA/NormalAndDepthSeparate",	NormalAndDepthSeparate);
+	runner.Add("EPA/DepthMatchesBruteForce",	DepthMatchesBruteForce);
+}
@@ -0,0 +1,45 @@
+#include "Tests.h"
+#include "GameWorld.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	/*
+	mt19937's default seed is 5489, and the standard pins its first output
+	to 3499211612, whose top 24 bits are 13668795. If RandomValue ever goes
+	back to a library distribution, this is where the compilers will differ.
+	*/
+	void RandomValueIsPortable() {
+		GameWorld world;
+		world.Seed(5489);
+		TEST_CHECK(world.RandomValue(0.0f, 1.0f) == 13668795 * 0x1p-24f);
+	}
+
+	void RandomValueStaysInRange() {
+		GameWorld world;
+		world.Seed(8503);
+		bool inRange = true;
+		for (int i = 0; i < 10000; ++i) {
+			float value = world.RandomValue(-2.0f, 3.0f);
+			inRange &= value >= -2.0f && value < 3.0f;
+		}
+		TEST_CHECK(inRange);
+	}
+
+	void RandomIndexStaysInRange() {
+		GameWorld world;
+		world.Seed(8503);
+		bool inRange = true;
+		for (size_t count = 1; count < 100; ++count) {
+			inRange &= world.RandomIndex(count) < count;
+		}
+		TEST_CHECK(inRange);
+	}
+}
+
+void NCL::CSC8503::AddGameWorldTests(TestRunner& runner) {
+	runner.Add("GameWorld/RandomValueIsPortable",	RandomValueIsPortable);
+	runner.Add("GameWorld/RandomValueStaysInRange",	RandomValueStaysInRange);
+	runner.Add("GameWorld/RandomIndexStaysInRange",	RandomIndexStaysInRange);
+}
@@ -0,0 +1,48 @@
+#include "Tests.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+#include <cstring>
+
+/*
+Runs the tests without a window or renderer, so that they can be run by
+ctest on any machine. The exit code is the number of tests that failed.
+
+	CSC8503Tests [--filter <text>] [--list]
+*/
+int main(int argc, char** argv) {
+	TestRunner runner;
+	bool list = false;
+
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--list") == 0) {
+			list = true;
+		}
+		else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+			runner.SetFilter(argv[++i]);
+		}
+		else {
+			std::cerr << "Usage: " << argv[0] << " [--filter <text>] [--list]\n";
+			return 1;
+		}
+	}
+
+	AddGameWorldTests(runner);
+	AddStepControllerTests(runner);
+	AddPhysicsProfilerTests(runner);
+	AddContinuousCollisionTests(runner);
+	AddBroadPhaseTests(runner);
+	AddCollisionPairCacheTests(runner);
+	AddEPATests(runner);
+	AddDeterminismTests(runner);
+	AddDiceSimulatorTests(runner);
+	AddDiceRollFarmTests(runner);
+	AddConvexHullTests(runner);
+
+	if (list) {
+		runner.ListTests(std::cout);
+		return 0;
+	}
+	return runner.RunAll(std::cout);
+}
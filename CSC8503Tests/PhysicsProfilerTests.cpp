@@ -0,0 +1,98 @@
+#include "Tests.h"
+#include "PhysicsProfiler.h"
+#include "DiceSimulator.h"
+
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	const int FRAMES		= 20000;
+	const int SUBSTEPS		= 4;
+
+	/*
+	One thread writes records as fast as it can, round and round a small
+	ring, with every counter set from the record's own frame and substep,
+	while another keeps copying them out. A record that got written over
+	halfway through being copied would have counters that don't match.
+	*/
+	void RecordsCopiedWhileWritingAreWhole() {
+		PhysicsProfiler profiler(64);
+		profiler.SetEnabled(true);
+
+		std::atomic<bool> done = false;
+		std::thread writer([&]() {
+			for (int f = 0; f < FRAMES; ++f) {
+				profiler.BeginFrame();
+				for (int s = 0; s < SUBSTEPS; ++s) {
+					profiler.BeginSubstep();
+					for (int c = 0; c < PhysicsProfiler::CounterCount; ++c) {
+						profiler.Count((PhysicsCounter)c, f * SUBSTEPS + s);
+					}
+					profiler.EndSubstep();
+				}
+				profiler.EndFrame();
+			}
+			done = true;
+		});
+
+		bool whole		= true;
+		bool inOrder	= true;
+		while (!done) {
+			std::vector<PhysicsProfiler::Record> records = profiler.GetRecords();
+			for (size_t i = 0; i < records.size(); ++i) {
+				const PhysicsProfiler::Record& r = records[i];
+				if (i > 0 && r.frame < records[i - 1].frame) {
+					inOrder = false;
+				}
+				if (r.substep < 0) {
+					continue;
+				}
+				for (int c = 0; c < PhysicsProfiler::CounterCount; ++c) {
+					whole &= r.counters[c] == r.frame * SUBSTEPS + r.substep;
+				}
+			}
+		}
+		writer.join();
+		TEST_CHECK(whole);
+		TEST_CHECK(inOrder);
+		TEST_CHECK(profiler.GetRecordsWritten() == FRAMES * (SUBSTEPS + 1));
+	}
+
+	//the phases of a substep happen one after another, so none of their times should overlap
+	void PhasesDontOverlap() {
+		DiceSimulator simulator;
+		simulator.GetPhysics().GetProfiler().SetEnabled(true);
+		simulator.Seed(8503);
+		simulator.Roll(0.5f);
+
+		bool overlaps		= false;
+		bool integrated		= true;
+		for (const PhysicsProfiler::Record& r : simulator.GetPhysics().GetProfiler().GetRecords()) {
+			std::vector<int> phases;
+			for (int p = 0; p < PhysicsProfiler::PhaseCount; ++p) {
+				if (r.phaseTime[p] > 0.0f) {
+					phases.push_back(p);
+				}
+			}
+			std::sort(phases.begin(), phases.end(), [&](int a, int b) { return r.phaseStart[a] < r.phaseStart[b]; });
+			for (size_t i = 1; i < phases.size(); ++i) {
+				overlaps |= r.phaseStart[phases[i - 1]] + r.phaseTime[phases[i - 1]] > r.phaseStart[phases[i]] + 0.01f;
+			}
+			if (r.substep >= 0) {
+				integrated &= r.phaseStart[(int)PhysicsPhase::IntegrateAccel] < r.phaseStart[(int)PhysicsPhase::ContactSolve];
+				integrated &= r.phaseStart[(int)PhysicsPhase::IntegrateVelocity] > r.phaseStart[(int)PhysicsPhase::ContactSolve];
+			}
+		}
+		TEST_CHECK(!overlaps);
+		TEST_CHECK(integrated);
+	}
+}
+
+void NCL::CSC8503::AddPhysicsProfilerTests(TestRunner& runner) {
+	runner.Add("PhysicsProfiler/RecordsCopiedWhileWritingAreWhole",	RecordsCopiedWhileWritingAreWhole);
+	runner.Add("PhysicsProfiler/PhasesDontOverlap",					PhasesDontOverlap);
+}
@@ -0,0 +1,57 @@
+#include "Tests.h"
+#include "StepController.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	const float FRAME_DT = 1.0f / 60.0f;
+
+	//runs one frame whose substeps each take substepCost seconds
+	void RunFrame(StepController& controller, float substepCost) {
+		int substeps = controller.BeginFrame(FRAME_DT);
+		controller.EndFrame(substeps * substepCost);
+	}
+
+	//a single slow frame drops the rate, and cheap frames bring it straight back up
+	void RateRecoversAfterASlowFrame() {
+		StepController controller(120);
+		RunFrame(controller, 0.0f);
+		controller.EndFrame(0.05f);
+		TEST_CHECK(controller.GetCurrentHZ() < 120);
+
+		for (int i = 0; i < 60; ++i) {
+			RunFrame(controller, 0.0001f);
+		}
+		TEST_CHECK(controller.GetCurrentHZ() == 120);
+	}
+
+	/*
+	With each substep costing 5ms, 120Hz (2 substeps a frame, 8.3ms budget)
+	is too slow, but 60Hz (1 substep, 16.7ms budget) keeps up, so that's
+	where the rate should stay, rather than sinking further.
+	*/
+	void RateSettlesWhereItKeepsUp() {
+		StepController controller(120);
+		for (int i = 0; i < 120; ++i) {
+			RunFrame(controller, 0.005f);
+		}
+		TEST_CHECK(controller.GetCurrentHZ() == 60);
+	}
+
+	void FixedBudgetIsUsed() {
+		StepController controller(120);
+		controller.SetBudget(100.0f);
+		TEST_CHECK(controller.GetBudget() == 100.0f);
+		for (int i = 0; i < 60; ++i) {
+			RunFrame(controller, 0.003f);
+		}
+		TEST_CHECK(controller.GetCurrentHZ() == 120);
+	}
+}
+
+void NCL::CSC8503::AddStepControllerTests(TestRunner& runner) {
+	runner.Add("StepController/RateRecoversAfterASlowFrame",	RateRecoversAfterASlowFrame);
+	runner.Add("StepController/RateSettlesWhereItKeepsUp",		RateSettlesWhereItKeepsUp);
+	runner.Add("StepController/FixedBudgetIsUsed",				FixedBudgetIsUsed);
+}
@@ -0,0 +1,43 @@
+#include "Test.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+void TestRunner::Add(const std::string& name, TestFunc test) {
+	tests.push_back({ name, test });
+}
+
+void TestRunner::ListTests(std::ostream& o) const {
+	for (const Test& t : tests) {
+		if (t.name.find(filter) != std::string::npos) {
+			o << t.name << "\n";
+		}
+	}
+}
+
+int TestRunner::RunAll(std::ostream& o) const {
+	int run		= 0;
+	int failed	= 0;
+	for (const Test& t : tests) {
+		if (t.name.find(filter) == std::string::npos) {
+			continue;
+		}
+		run++;
+		try {
+			t.test();
+			o << "[  OK  ] " << t.name << std::endl;
+		}
+		catch (const Failure& f) {
+			o << "[ FAIL ] " << t.name << "\n\t" << f.what() << std::endl;
+			failed++;
+		}
+	}
+	o << run - failed << " of " << run << " tests passed" << std::endl;
+	return failed;
+}
+
+void TestRunner::Check(bool condition, const char* expression, const char* file, int line) {
+	if (!condition) {
+		throw Failure(std::string(file) + "(" + std::to_string(line) + "): " + expression);
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <stdexcept>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		A small test harness, in the same vein as the benchmark one. Each test
+		is just a function that makes some TEST_CHECKs; the first check that
+		fails stops the test and is reported with its file and line, and the
+		rest of the tests carry on. RunAll hands back how many tests failed,
+		which becomes the exit code, so ctest can tell when something broke.
+		*/
+		class TestRunner {
+		public:
+			typedef std::function<void()> TestFunc;
+
+			struct Failure : public std::runtime_error {
+				Failure(const std::string& message) : std::runtime_error(message) {}
+			};
+
+			TestRunner() {}
+			~TestRunner() {}
+
+			void Add(const std::string& name, TestFunc test);
+
+			//only tests with this in their name are run
+			void SetFilter(const std::string& filter) {
+				this->filter = filter;
+			}
+
+			void ListTests(std::ostream& o) const;
+			int RunAll(std::ostream& o) const;
+
+			static void Check(bool condition, const char* expression, const char* file, int line);
+
+		protected:
+			struct Test {
+				std::string name;
+				TestFunc	test;
+			};
+
+			std::vector<Test>	tests;
+			std::string			filter;
+		};
+	}
+}
+
+#define TEST_CHECK(x) NCL::CSC8503::TestRunner::Check((x), #x, __FILE__, __LINE__)
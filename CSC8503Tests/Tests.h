@@ -0,0 +1,39 @@
+#pragma once
+#include "Test.h"
+
+namespace NCL {
+	namespace CSC8503 {
+		//the world's seeded random values
+		void AddGameWorldTests(TestRunner& runner);
+
+		//how the StepController adapts the substep rate to the time the physics takes
+		void AddStepControllerTests(TestRunner& runner);
+
+		//copying records out of the PhysicsProfiler while the physics is still writing them
+		void AddPhysicsProfilerTests(TestRunner& runner);
+
+		//dice thrown fast enough to pass through a wall in one substep
+		void AddContinuousCollisionTests(TestRunner& runner);
+
+		//the broadphases never missing a pair of boxes that overlap, as they move
+		void AddBroadPhaseTests(TestRunner& runner);
+
+		//the CollisionPairCache giving the same answers as a std::map
+		void AddCollisionPairCacheTests(TestRunner& runner);
+
+		//EPA's normal and depth for overlapping dice, against a brute force search
+		void AddEPATests(TestRunner& runner);
+
+		//seeded rolls giving the same step hash however and wherever they're run
+		void AddDeterminismTests(TestRunner& runner);
+
+		//whole rolls of the headless DiceSimulator
+		void AddDiceSimulatorTests(TestRunner& runner);
+
+		//the DiceRollFarm only counting dice that came to rest in the tray
+		void AddDiceRollFarmTests(TestRunner& runner);
+
+		//building a ConvexHullVolume, and its support points and face results
+		void AddConvexHullTests(TestRunner& runner);
+	}
+}